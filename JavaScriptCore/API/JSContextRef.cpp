@@ -33,6 +33,8 @@
 #include "JSClassRef.h"
 #include "JSGlobalObject.h"
 #include "JSObject.h"
+#include "OpaqueJSString.h"
+#include "SamplingProfiler.h"
 #include <wtf/text/StringHash.h>
 
 #if OS(DARWIN)
@@ -173,3 +175,52 @@ JSGlobalContextRef JSContextGetGlobalContext(JSContextRef ctx)
 
     return toGlobalRef(exec->lexicalGlobalObject()->globalExec());
 }
+
+void JSContextStartSamplingProfiler(JSContextRef ctx, unsigned hertz)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    JSGlobalData& globalData = exec->globalData();
+    if (!globalData.samplingProfiler)
+        globalData.samplingProfiler.set(new SamplingProfiler(&globalData));
+    globalData.samplingProfiler->start(hertz ? hertz : SamplingProfiler::defaultHertz);
+#else
+    UNUSED_PARAM(ctx);
+    UNUSED_PARAM(hertz);
+#endif
+}
+
+void JSContextStopSamplingProfiler(JSContextRef ctx)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    if (SamplingProfiler* samplingProfiler = exec->globalData().samplingProfiler.get())
+        samplingProfiler->stop();
+#else
+    UNUSED_PARAM(ctx);
+#endif
+}
+
+JSStringRef JSContextCopySamplingProfilerFoldedStacks(JSContextRef ctx, bool clear)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    ExecState* exec = toJS(ctx);
+    APIEntryShim entryShim(exec);
+
+    SamplingProfiler* samplingProfiler = exec->globalData().samplingProfiler.get();
+    if (!samplingProfiler)
+        return OpaqueJSString::create().releaseRef();
+    UString foldedStacks = samplingProfiler->foldedStacks();
+    if (clear)
+        samplingProfiler->clear();
+    return OpaqueJSString::create(foldedStacks).releaseRef();
+#else
+    UNUSED_PARAM(ctx);
+    UNUSED_PARAM(clear);
+    return OpaqueJSString::create().releaseRef();
+#endif
+}
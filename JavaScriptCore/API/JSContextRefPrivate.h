@@ -46,6 +46,36 @@ extern "C" {
 */
 JS_EXPORT JSGlobalContextRef JSContextGetGlobalContext(JSContextRef ctx);
 
+/*!
+@function
+@abstract Starts sampling the script call stacks of a context group.
+@param ctx A JSContext in the group whose call stacks you want to sample.
+@param hertz The number of samples to take per second, or 0 to take 1000.
+@discussion Each sample is taken the next time running script checks whether it has
+ timed out, so script that finishes between two checks is not sampled. Samples are
+ kept when the profiler is stopped, and added to when it is started again. Starting
+ a profiler that is already running does nothing.
+*/
+JS_EXPORT void JSContextStartSamplingProfiler(JSContextRef ctx, unsigned hertz);
+
+/*!
+@function
+@abstract Stops sampling the script call stacks of a context group.
+@param ctx A JSContext in the group whose call stacks are being sampled.
+*/
+JS_EXPORT void JSContextStopSamplingProfiler(JSContextRef ctx);
+
+/*!
+@function
+@abstract Gets the call stacks sampled in a context group, in the folded format read by flame graph tools.
+@param ctx A JSContext in the group whose call stacks were sampled.
+@param clear true to forget the samples once they have been copied.
+@result A JSString with one line per distinct call stack, listing its frames from the
+ outermost in, separated by semicolons, then a space and the number of samples. Ownership
+ follows the Create Rule.
+*/
+JS_EXPORT JSStringRef JSContextCopySamplingProfilerFoldedStacks(JSContextRef ctx, bool clear);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1346,6 +1346,35 @@ int main(int argc, char* argv[])
 
     printf("PASS: Infinite prototype chain does not occur.\n");
 
+    JSGlobalContextRef samplingContext = JSGlobalContextCreateInGroup(NULL, NULL);
+    JSContextStartSamplingProfiler(samplingContext, 0);
+    JSStringRef spinScript = JSStringCreateWithUTF8CString("function spin() { var end = new Date().getTime() + 50; while (new Date().getTime() < end) { } } spin();");
+    JSEvaluateScript(samplingContext, spinScript, NULL, NULL, 1, NULL);
+    JSStringRelease(spinScript);
+    JSContextStopSamplingProfiler(samplingContext);
+
+    JSStringRef foldedStacks = JSContextCopySamplingProfilerFoldedStacks(samplingContext, true);
+    size_t foldedStacksSize = JSStringGetMaximumUTF8CStringSize(foldedStacks);
+    char* foldedStacksUTF8 = (char*)malloc(foldedStacksSize);
+    JSStringGetUTF8CString(foldedStacks, foldedStacksUTF8, foldedStacksSize);
+    if (!strstr(foldedStacksUTF8, "(program);spin ")) {
+        printf("FAIL: Sampling profiler did not sample a busy function: %s\n", foldedStacksUTF8);
+        failed = 1;
+    } else
+        printf("PASS: Sampling profiler sampled a busy function.\n");
+    free(foldedStacksUTF8);
+    JSStringRelease(foldedStacks);
+
+    foldedStacks = JSContextCopySamplingProfilerFoldedStacks(samplingContext, false);
+    if (JSStringGetLength(foldedStacks)) {
+        printf("FAIL: Sampling profiler kept samples after they were cleared.\n");
+        failed = 1;
+    } else
+        printf("PASS: Sampling profiler cleared its samples.\n");
+    JSStringRelease(foldedStacks);
+
+    JSGlobalContextRelease(samplingContext);
+
     if (failed) {
         printf("FAIL: Some tests failed.\n");
         return 1;
@@ -0,0 +1,882 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BytecodeCache.h"
+
+#if ENABLE(BYTECODE_CACHE)
+
+#include "BatchedTransitionOptimizer.h"
+#include "BytecodeGenerator.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "Interpreter.h"
+#include "JSGlobalObject.h"
+#include "JSString.h"
+#include "Nodes.h"
+#include "PrototypeFunction.h"
+#include "RegExp.h"
+#include "RegExpCache.h"
+#include <stdio.h>
+#include <wtf/HashSet.h>
+#include <wtf/StdLibExtras.h>
+
+using namespace std;
+
+namespace JSC {
+
+// Bump whenever the layout of an entry changes.
+static const uint32_t entryVersion = 1;
+static const uint32_t entryMagic = 0x4342534A; // "JSBC"
+
+enum ConstantKind { UndefinedConstant, NullConstant, TrueConstant, FalseConstant, NumberConstant, StringConstant, GlobalObjectConstant };
+
+// The only pointers the generator writes into program instructions.
+enum PointerOperand { GlobalObjectOperand, CallFunctionOperand, ApplyFunctionOperand };
+
+static int pointerOperandIndex(OpcodeID opcodeID)
+{
+    switch (opcodeID) {
+    case op_resolve_global:
+    case op_resolve_global_dynamic:
+    case op_get_global_var:
+    case op_jneq_ptr:
+        return 2;
+    case op_put_global_var:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static inline uint64_t hashBytes(uint64_t hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static const uint64_t initialHash = 0xCBF29CE484222325ULL;
+
+// Entries written by a build with a different instruction set or value
+// representation are not read back.
+static uint64_t buildSignature()
+{
+    uint32_t configuration[] = {
+        entryVersion,
+        sizeof(void*),
+        sizeof(Instruction),
+#if USE(JSVALUE64)
+        64,
+#elif USE(JSVALUE32_64)
+        3264,
+#else
+        32,
+#endif
+#if ENABLE(JIT)
+        1,
+#else
+        0,
+#endif
+#if ENABLE(APOLLO_PROFILER)
+        1,
+#else
+        0,
+#endif
+        numOpcodeIDs
+    };
+    uint64_t hash = hashBytes(initialHash, configuration, sizeof(configuration));
+    return hashBytes(hash, opcodeLengths, sizeof(opcodeLengths));
+}
+
+static uint64_t sourceHash(const SourceCode& source)
+{
+    return hashBytes(initialHash, source.data(), source.length() * sizeof(UChar));
+}
+
+static uint64_t symbolTableDigest(SymbolTable& symbolTable)
+{
+    // Summed so that the digest doesn't depend on the table's iteration order.
+    uint64_t digest = 0;
+    SymbolTable::iterator end = symbolTable.end();
+    for (SymbolTable::iterator it = symbolTable.begin(); it != end; ++it) {
+        uint64_t entry = (static_cast<uint64_t>(it->first->hash()) << 32) | static_cast<uint32_t>(it->second.getIndex());
+        digest += (entry ^ it->second.getAttributes()) * 0x9E3779B97F4A7C15ULL;
+    }
+    return digest;
+}
+
+class EntryWriter {
+public:
+    void append32(uint32_t value) { m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void append64(uint64_t value) { m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void appendDouble(double value) { m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+    void appendString(const UString& string)
+    {
+        append32(string.size());
+        m_buffer.append(reinterpret_cast<const char*>(string.data()), string.size() * sizeof(UChar));
+    }
+
+    const Vector<char>& buffer() const { return m_buffer; }
+
+private:
+    Vector<char> m_buffer;
+};
+
+// Reads past the end, or counts larger than what is left, mark the reader as
+// failed and return zeros, so a damaged entry is rejected once at the end.
+class EntryReader {
+public:
+    EntryReader(const Vector<char>& buffer)
+        : m_buffer(buffer)
+        , m_offset(0)
+        , m_failed(false)
+    {
+    }
+
+    uint32_t read32()
+    {
+        uint32_t value = 0;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    uint64_t read64()
+    {
+        uint64_t value = 0;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    double readDouble()
+    {
+        double value = 0;
+        read(&value, sizeof(value));
+        return value;
+    }
+
+    UString readString()
+    {
+        unsigned length = readCount(sizeof(UChar));
+        if (!length)
+            return UString("");
+        Vector<UChar> characters(length);
+        read(characters.data(), length * sizeof(UChar));
+        return UString(characters.data(), length);
+    }
+
+    unsigned readCount(size_t elementSize)
+    {
+        uint32_t count = read32();
+        if (count > (m_buffer.size() - m_offset) / elementSize) {
+            m_failed = true;
+            return 0;
+        }
+        return count;
+    }
+
+    bool failed() const { return m_failed; }
+    bool atEnd() const { return m_offset == m_buffer.size(); }
+
+private:
+    void read(void* value, size_t size)
+    {
+        if (m_failed || size > m_buffer.size() - m_offset) {
+            m_failed = true;
+            return;
+        }
+        memcpy(value, m_buffer.data() + m_offset, size);
+        m_offset += size;
+    }
+
+    const Vector<char>& m_buffer;
+    size_t m_offset;
+    bool m_failed;
+};
+
+static bool readFile(const char* path, Vector<char>& buffer)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    bool success = false;
+    if (!fseek(file, 0, SEEK_END)) {
+        long size = ftell(file);
+        if (size > 0 && !fseek(file, 0, SEEK_SET)) {
+            buffer.resize(size);
+            success = fread(buffer.data(), 1, size, file) == static_cast<size_t>(size);
+        }
+    }
+    fclose(file);
+    return success;
+}
+
+static bool writeFile(const char* path, const Vector<char>& buffer)
+{
+    // Written aside and renamed so that a reader never sees half an entry.
+    Vector<char> temporaryPath;
+    temporaryPath.append(path, strlen(path));
+    temporaryPath.append(".tmp", 5);
+
+    FILE* file = fopen(temporaryPath.data(), "wb");
+    if (!file)
+        return false;
+    bool success = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    success = !fclose(file) && success;
+
+    if (success && rename(temporaryPath.data(), path)) {
+        // Renaming over an existing file fails on Windows.
+        remove(path);
+        success = !rename(temporaryPath.data(), path);
+    }
+    if (!success)
+        remove(temporaryPath.data());
+    return success;
+}
+
+static UString regExpFlags(RegExp* regExp)
+{
+    UChar flags[3];
+    int length = 0;
+    if (regExp->global())
+        flags[length++] = 'g';
+    if (regExp->ignoreCase())
+        flags[length++] = 'i';
+    if (regExp->multiline())
+        flags[length++] = 'm';
+    return UString(flags, length);
+}
+
+BytecodeCache::BytecodeCache(const UString& directory)
+    : m_directory(directory)
+{
+}
+
+bool BytecodeCache::canCache(JSGlobalObject* globalObject)
+{
+    if (globalObject->debugger() || globalObject->supportsProfiling())
+        return false;
+#if ENABLE(APOLLO_PROFILER)
+    if (globalObject->supportsSampling())
+        return false;
+#endif
+    return !BytecodeGenerator::dumpsGeneratedCode();
+}
+
+CString BytecodeCache::entryPath(const SourceCode& source)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.jsbc", static_cast<unsigned long long>(sourceHash(source)));
+    return makeString(m_directory, name).UTF8String();
+}
+
+void BytecodeCache::remove(const SourceCode& source)
+{
+    ::remove(entryPath(source).data());
+}
+
+void BytecodeCache::recordGlobalState(ExecState* exec, JSGlobalObject* globalObject, ProgramNode* programNode, GlobalState& state)
+{
+    SymbolTable& symbolTable = globalObject->symbolTable();
+    RegisterFile& registerFile = exec->globalData().interpreter->registerFile();
+    const ProgramNode::VarStack& varStack = programNode->varStack();
+    const ProgramNode::FunctionStack& functionStack = programNode->functionStack();
+
+    // Mirrors the program BytecodeGenerator constructor, which puts new globals
+    // on the object instead of in its registers when there isn't room.
+    state.declarationCount = functionStack.size() + varStack.size();
+    state.canOptimizeNewGlobals = symbolTable.size() + state.declarationCount < registerFile.maxGlobals();
+    if (!state.canOptimizeNewGlobals)
+        return;
+
+    state.registerFileSize = registerFile.size();
+    state.symbolTableSize = symbolTable.size();
+    state.symbolTableDigest = symbolTableDigest(symbolTable);
+
+    // Whether a var is new is all that matters about it to the generator, and a
+    // var that is also a function, or a repeat of an earlier var, is never new.
+    HashSet<UString::Rep*> declared;
+    for (size_t i = 0; i < functionStack.size(); ++i) {
+        const Identifier& name = functionStack[i]->ident();
+        if (declared.add(name.ustring().rep()).second)
+            state.functionNames.append(name);
+    }
+    for (size_t i = 0; i < varStack.size(); ++i) {
+        const Identifier& name = *varStack[i].first;
+        if (declared.add(name.ustring().rep()).second)
+            state.variables.append(make_pair(name, globalObject->hasProperty(exec, name)));
+    }
+}
+
+static void writeFunction(EntryWriter& writer, FunctionExecutable* function)
+{
+    writer.appendString(function->name().ustring());
+    const SourceCode& source = function->source();
+    writer.append32(source.startOffset());
+    writer.append32(source.endOffset());
+    writer.append32(source.firstLine());
+    writer.append32(function->forceUsesArguments());
+    FunctionParameters& parameters = *function->parameters();
+    writer.append32(parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i)
+        writer.appendString(parameters[i].ustring());
+    writer.append32(function->lineNo());
+    writer.append32(function->lastLine());
+#if ENABLE(APOLLO_PROFILER)
+    writer.appendString(function->contextualName());
+#endif
+}
+
+static PassRefPtr<FunctionExecutable> readFunction(EntryReader& reader, ExecState* exec, SourceProvider* provider)
+{
+    Identifier name(exec, reader.readString());
+    int startOffset = reader.read32();
+    int endOffset = reader.read32();
+    int sourceFirstLine = reader.read32();
+    bool forceUsesArguments = reader.read32();
+    RefPtr<FunctionParameters> parameters = FunctionParameters::create(0);
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        parameters->append(Identifier(exec, reader.readString()));
+    int firstLine = reader.read32();
+    int lastLine = reader.read32();
+#if ENABLE(APOLLO_PROFILER)
+    UString contextualName = reader.readString();
+#endif
+    if (reader.failed() || startOffset < 0 || startOffset > endOffset || endOffset > provider->length())
+        return 0;
+
+    return FunctionExecutable::create(exec, name, SourceCode(provider, startOffset, endOffset, sourceFirstLine), forceUsesArguments, parameters.get(), firstLine, lastLine
+#if ENABLE(APOLLO_PROFILER)
+                                      , contextualName
+#endif
+                                      );
+}
+
+static void writeJumpTable(EntryWriter& writer, const SimpleJumpTable& table)
+{
+    writer.append32(table.min);
+    writer.append32(table.branchOffsets.size());
+    for (size_t i = 0; i < table.branchOffsets.size(); ++i)
+        writer.append32(table.branchOffsets[i]);
+}
+
+static void readJumpTable(EntryReader& reader, SimpleJumpTable& table)
+{
+    table.min = reader.read32();
+    table.branchOffsets.resize(reader.readCount(sizeof(uint32_t)));
+    for (size_t i = 0; i < table.branchOffsets.size(); ++i)
+        table.branchOffsets[i] = reader.read32();
+}
+
+bool BytecodeCache::writeCodeBlock(EntryWriter& writer, ExecState* exec, JSGlobalObject* globalObject, ProgramCodeBlock* codeBlock)
+{
+    Interpreter* interpreter = exec->globalData().interpreter;
+
+    writer.append32(codeBlock->m_numCalleeRegisters);
+    writer.append32(codeBlock->m_numVars);
+    writer.append32(codeBlock->m_numParameters);
+    writer.append32(codeBlock->m_thisRegister);
+    writer.append32(codeBlock->m_needsFullScopeChain);
+    writer.append32(codeBlock->m_usesEval);
+    writer.append32(codeBlock->m_usesArguments);
+    writer.append32(codeBlock->m_isNumericCompareFunction);
+
+    Vector<Instruction>& instructions = codeBlock->m_instructions;
+    writer.append32(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ) {
+        OpcodeID opcodeID = interpreter->getOpcodeID(instructions[i].u.opcode);
+        writer.append32(opcodeID);
+        int pointerIndex = pointerOperandIndex(opcodeID);
+        for (int operand = 1; operand < opcodeLengths[opcodeID]; ++operand) {
+            const Instruction& instruction = instructions[i + operand];
+            if (operand != pointerIndex) {
+                writer.append32(instruction.u.operand);
+                continue;
+            }
+            if (instruction.u.jsCell == globalObject)
+                writer.append32(GlobalObjectOperand);
+            else if (instruction.u.jsCell == globalObject->d()->callFunction)
+                writer.append32(CallFunctionOperand);
+            else if (instruction.u.jsCell == globalObject->d()->applyFunction)
+                writer.append32(ApplyFunctionOperand);
+            else
+                return false;
+        }
+        i += opcodeLengths[opcodeID];
+    }
+
+    writer.append32(codeBlock->m_jumpTargets.size());
+    for (size_t i = 0; i < codeBlock->m_jumpTargets.size(); ++i)
+        writer.append32(codeBlock->m_jumpTargets[i]);
+
+    writer.append32(codeBlock->m_identifiers.size());
+    for (size_t i = 0; i < codeBlock->m_identifiers.size(); ++i)
+        writer.appendString(codeBlock->m_identifiers[i].ustring());
+
+    writer.append32(codeBlock->m_constantRegisters.size());
+    for (size_t i = 0; i < codeBlock->m_constantRegisters.size(); ++i) {
+        JSValue value = codeBlock->m_constantRegisters[i].jsValue();
+        if (value.isNumber()) {
+            writer.append32(NumberConstant);
+            writer.appendDouble(value.uncheckedGetNumber());
+        } else if (value.isString()) {
+            writer.append32(StringConstant);
+            writer.appendString(asString(value)->value(exec));
+        } else if (value.isUndefined())
+            writer.append32(UndefinedConstant);
+        else if (value.isNull())
+            writer.append32(NullConstant);
+        else if (value.isBoolean())
+            writer.append32(value.isTrue() ? TrueConstant : FalseConstant);
+        else if (value == globalObject)
+            writer.append32(GlobalObjectConstant);
+        else
+            return false;
+    }
+
+    writer.append32(codeBlock->m_functionDecls.size());
+    for (size_t i = 0; i < codeBlock->m_functionDecls.size(); ++i)
+        writeFunction(writer, codeBlock->m_functionDecls[i].get());
+    writer.append32(codeBlock->m_functionExprs.size());
+    for (size_t i = 0; i < codeBlock->m_functionExprs.size(); ++i)
+        writeFunction(writer, codeBlock->m_functionExprs[i].get());
+
+    CodeBlock::RareData* rareData = codeBlock->m_rareData.get();
+    writer.append32(rareData != 0);
+    if (rareData) {
+        writer.append32(rareData->m_exceptionHandlers.size());
+        for (size_t i = 0; i < rareData->m_exceptionHandlers.size(); ++i) {
+            const HandlerInfo& handler = rareData->m_exceptionHandlers[i];
+            writer.append32(handler.start);
+            writer.append32(handler.end);
+            writer.append32(handler.target);
+            writer.append32(handler.scopeDepth);
+        }
+
+        writer.append32(rareData->m_regexps.size());
+        for (size_t i = 0; i < rareData->m_regexps.size(); ++i) {
+            writer.appendString(rareData->m_regexps[i]->pattern());
+            writer.appendString(regExpFlags(rareData->m_regexps[i].get()));
+        }
+
+        writer.append32(rareData->m_immediateSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_immediateSwitchJumpTables.size(); ++i)
+            writeJumpTable(writer, rareData->m_immediateSwitchJumpTables[i]);
+        writer.append32(rareData->m_characterSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_characterSwitchJumpTables.size(); ++i)
+            writeJumpTable(writer, rareData->m_characterSwitchJumpTables[i]);
+        writer.append32(rareData->m_stringSwitchJumpTables.size());
+        for (size_t i = 0; i < rareData->m_stringSwitchJumpTables.size(); ++i) {
+            StringJumpTable::StringOffsetTable& offsetTable = rareData->m_stringSwitchJumpTables[i].offsetTable;
+            writer.append32(offsetTable.size());
+            StringJumpTable::StringOffsetTable::iterator end = offsetTable.end();
+            for (StringJumpTable::StringOffsetTable::iterator it = offsetTable.begin(); it != end; ++it) {
+                writer.appendString(UString(it->first));
+                writer.append32(it->second.branchOffset);
+            }
+        }
+
+#if ENABLE(JIT)
+        writer.append32(rareData->m_functionRegisterInfos.size());
+        for (size_t i = 0; i < rareData->m_functionRegisterInfos.size(); ++i) {
+            writer.append32(rareData->m_functionRegisterInfos[i].bytecodeOffset);
+            writer.append32(rareData->m_functionRegisterInfos[i].functionRegisterIndex);
+        }
+#endif
+    }
+
+    ExceptionInfo* exceptionInfo = codeBlock->m_exceptionInfo.get();
+    writer.append32(exceptionInfo->m_expressionInfo.size());
+    for (size_t i = 0; i < exceptionInfo->m_expressionInfo.size(); ++i) {
+        const ExpressionRangeInfo& info = exceptionInfo->m_expressionInfo[i];
+        writer.append32(info.instructionOffset);
+        writer.append32(info.divotPoint);
+        writer.append32(info.startOffset);
+        writer.append32(info.endOffset);
+    }
+    writer.append32(exceptionInfo->m_lineInfo.size());
+    for (size_t i = 0; i < exceptionInfo->m_lineInfo.size(); ++i) {
+        writer.append32(exceptionInfo->m_lineInfo[i].instructionOffset);
+        writer.append32(exceptionInfo->m_lineInfo[i].lineNumber);
+    }
+    writer.append32(exceptionInfo->m_getByIdExceptionInfo.size());
+    for (size_t i = 0; i < exceptionInfo->m_getByIdExceptionInfo.size(); ++i) {
+        writer.append32(exceptionInfo->m_getByIdExceptionInfo[i].bytecodeOffset);
+        writer.append32(exceptionInfo->m_getByIdExceptionInfo[i].isOpConstruct);
+    }
+
+#if ENABLE(JIT)
+    writer.append32(codeBlock->m_structureStubInfos.size());
+    for (size_t i = 0; i < codeBlock->m_structureStubInfos.size(); ++i)
+        writer.append32(codeBlock->m_structureStubInfos[i].accessType);
+    writer.append32(codeBlock->m_globalResolveInfos.size());
+    for (size_t i = 0; i < codeBlock->m_globalResolveInfos.size(); ++i)
+        writer.append32(codeBlock->m_globalResolveInfos[i].bytecodeOffset);
+    writer.append32(codeBlock->m_callLinkInfos.size());
+#if ENABLE(APOLLO_PROFILER)
+    writer.append32(codeBlock->m_samplerStubInfos.size());
+#endif
+#else
+    writer.append32(codeBlock->m_propertyAccessInstructions.size());
+    for (size_t i = 0; i < codeBlock->m_propertyAccessInstructions.size(); ++i)
+        writer.append32(codeBlock->m_propertyAccessInstructions[i]);
+    writer.append32(codeBlock->m_globalResolveInstructions.size());
+    for (size_t i = 0; i < codeBlock->m_globalResolveInstructions.size(); ++i)
+        writer.append32(codeBlock->m_globalResolveInstructions[i]);
+#endif
+
+    return true;
+}
+
+bool BytecodeCache::readCodeBlock(EntryReader& reader, ExecState* exec, JSGlobalObject* globalObject, ProgramCodeBlock* codeBlock)
+{
+    JSGlobalData* globalData = &exec->globalData();
+    Interpreter* interpreter = globalData->interpreter;
+    SourceProvider* provider = codeBlock->source();
+
+    codeBlock->setGlobalData(globalData);
+    codeBlock->m_numCalleeRegisters = reader.read32();
+    codeBlock->m_numVars = reader.read32();
+    codeBlock->m_numParameters = reader.read32();
+    codeBlock->m_thisRegister = reader.read32();
+    codeBlock->m_needsFullScopeChain = reader.read32();
+    codeBlock->m_usesEval = reader.read32();
+    codeBlock->m_usesArguments = reader.read32();
+    codeBlock->m_isNumericCompareFunction = reader.read32();
+
+    Vector<Instruction>& instructions = codeBlock->m_instructions;
+    unsigned instructionCount = reader.readCount(sizeof(uint32_t));
+    instructions.reserveCapacity(instructionCount);
+    while (instructions.size() < instructionCount) {
+        uint32_t opcodeID = reader.read32();
+        if (opcodeID >= static_cast<uint32_t>(numOpcodeIDs) || instructions.size() + opcodeLengths[opcodeID] > instructionCount)
+            return false;
+        instructions.append(interpreter->getOpcode(static_cast<OpcodeID>(opcodeID)));
+        int pointerIndex = pointerOperandIndex(static_cast<OpcodeID>(opcodeID));
+        for (int operand = 1; operand < opcodeLengths[opcodeID]; ++operand) {
+            int value = reader.read32();
+            if (operand != pointerIndex) {
+                instructions.append(value);
+                continue;
+            }
+            switch (value) {
+            case GlobalObjectOperand:
+                instructions.append(globalObject);
+                break;
+            case CallFunctionOperand:
+                instructions.append(globalObject->d()->callFunction);
+                break;
+            case ApplyFunctionOperand:
+                instructions.append(globalObject->d()->applyFunction);
+                break;
+            default:
+                return false;
+            }
+        }
+        if (reader.failed())
+            return false;
+    }
+#ifndef NDEBUG
+    codeBlock->setInstructionCount(instructions.size());
+#endif
+
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->m_jumpTargets.append(reader.read32());
+
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->m_identifiers.append(Identifier(exec, reader.readString()));
+
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count) {
+        JSValue value;
+        switch (reader.read32()) {
+        case UndefinedConstant:
+            value = jsUndefined();
+            break;
+        case NullConstant:
+            value = jsNull();
+            break;
+        case TrueConstant:
+            value = jsBoolean(true);
+            break;
+        case FalseConstant:
+            value = jsBoolean(false);
+            break;
+        case NumberConstant:
+            value = jsNumber(exec, reader.readDouble());
+            break;
+        case StringConstant:
+            value = jsOwnedString(globalData, reader.readString());
+            break;
+        case GlobalObjectConstant:
+            value = globalObject;
+            break;
+        default:
+            return false;
+        }
+        codeBlock->addConstantRegister(value);
+    }
+
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count) {
+        RefPtr<FunctionExecutable> function = readFunction(reader, exec, provider);
+        if (!function)
+            return false;
+        codeBlock->addFunctionDecl(function.release());
+    }
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count) {
+        RefPtr<FunctionExecutable> function = readFunction(reader, exec, provider);
+        if (!function)
+            return false;
+        codeBlock->addFunctionExpr(function.release());
+    }
+
+    if (reader.read32()) {
+        codeBlock->createRareDataIfNecessary();
+        CodeBlock::RareData* rareData = codeBlock->m_rareData.get();
+
+        for (unsigned count = reader.readCount(4 * sizeof(uint32_t)); count; --count) {
+            HandlerInfo handler;
+            handler.start = reader.read32();
+            handler.end = reader.read32();
+            handler.target = reader.read32();
+            handler.scopeDepth = reader.read32();
+            rareData->m_exceptionHandlers.append(handler);
+        }
+
+        for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count) {
+            UString pattern = reader.readString();
+            UString flags = reader.readString();
+            rareData->m_regexps.append(globalData->regExpCache()->lookupOrCreate(pattern, flags));
+        }
+
+        for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count)
+            readJumpTable(reader, codeBlock->addImmediateSwitchJumpTable());
+        for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count)
+            readJumpTable(reader, codeBlock->addCharacterSwitchJumpTable());
+        for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count) {
+            StringJumpTable& table = codeBlock->addStringSwitchJumpTable();
+            for (unsigned entries = reader.readCount(2 * sizeof(uint32_t)); entries; --entries) {
+                Identifier key(exec, reader.readString());
+                OffsetLocation location;
+                location.branchOffset = reader.read32();
+                table.offsetTable.add(key.ustring().rep(), location);
+            }
+        }
+
+#if ENABLE(JIT)
+        for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count) {
+            unsigned bytecodeOffset = reader.read32();
+            int functionRegisterIndex = reader.read32();
+            rareData->m_functionRegisterInfos.append(FunctionRegisterInfo(bytecodeOffset, functionRegisterIndex));
+        }
+#endif
+    }
+
+    ExceptionInfo* exceptionInfo = codeBlock->m_exceptionInfo.get();
+    for (unsigned count = reader.readCount(4 * sizeof(uint32_t)); count; --count) {
+        ExpressionRangeInfo info;
+        info.instructionOffset = reader.read32();
+        info.divotPoint = reader.read32();
+        info.startOffset = reader.read32();
+        info.endOffset = reader.read32();
+        exceptionInfo->m_expressionInfo.append(info);
+    }
+    for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count) {
+        LineInfo info;
+        info.instructionOffset = reader.read32();
+        info.lineNumber = reader.read32();
+        exceptionInfo->m_lineInfo.append(info);
+    }
+    for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count) {
+        GetByIdExceptionInfo info;
+        info.bytecodeOffset = reader.read32();
+        info.isOpConstruct = reader.read32();
+        exceptionInfo->m_getByIdExceptionInfo.append(info);
+    }
+
+#if ENABLE(JIT)
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->addStructureStubInfo(StructureStubInfo(static_cast<AccessType>(reader.read32())));
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->addGlobalResolveInfo(reader.read32());
+    codeBlock->m_callLinkInfos.grow(reader.read32());
+#if ENABLE(APOLLO_PROFILER)
+    codeBlock->m_samplerStubInfos.grow(reader.read32());
+#endif
+#else
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->addPropertyAccessInstruction(reader.read32());
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        codeBlock->addGlobalResolveInstruction(reader.read32());
+#endif
+
+    return !reader.failed();
+}
+
+void BytecodeCache::store(ExecState* exec, JSGlobalObject* globalObject, ProgramExecutable* executable, ProgramCodeBlock* codeBlock, const GlobalState& state)
+{
+    if (!state.canOptimizeNewGlobals)
+        return;
+
+    const SourceCode& source = executable->source();
+    EntryWriter writer;
+    writer.append32(entryMagic);
+    writer.append64(buildSignature());
+    writer.append64(sourceHash(source));
+    writer.append32(source.length());
+    writer.append32(source.startOffset());
+    writer.append32(source.firstLine());
+
+    writer.append32(state.registerFileSize);
+    writer.append32(state.symbolTableSize);
+    writer.append64(state.symbolTableDigest);
+    writer.append32(state.declarationCount);
+    writer.append32(state.functionNames.size());
+    for (size_t i = 0; i < state.functionNames.size(); ++i)
+        writer.appendString(state.functionNames[i].ustring());
+    writer.append32(state.variables.size());
+    for (size_t i = 0; i < state.variables.size(); ++i) {
+        writer.appendString(state.variables[i].first.ustring());
+        writer.append32(state.variables[i].second);
+    }
+
+    // New globals are numbered down from below the ones already there, so
+    // sorting by descending index replays them in the order they were added.
+    Vector<std::pair<int, UString::Rep*> > newGlobals;
+    SymbolTable& symbolTable = globalObject->symbolTable();
+    SymbolTable::iterator end = symbolTable.end();
+    for (SymbolTable::iterator it = symbolTable.begin(); it != end; ++it) {
+        if (it->second.getIndex() < -static_cast<int>(state.symbolTableSize))
+            newGlobals.append(make_pair(-it->second.getIndex(), it->first.get()));
+    }
+    std::sort(newGlobals.begin(), newGlobals.end());
+    writer.append32(newGlobals.size());
+    for (size_t i = 0; i < newGlobals.size(); ++i) {
+        SymbolTableEntry entry = symbolTable.get(newGlobals[i].second);
+        writer.appendString(UString(newGlobals[i].second));
+        writer.append32(entry.getIndex());
+        writer.append32(entry.getAttributes());
+    }
+
+    writer.append32(executable->m_features);
+    writer.append32(executable->lineNo());
+    writer.append32(executable->lastLine());
+
+    if (!writeCodeBlock(writer, exec, globalObject, codeBlock))
+        return;
+
+    if (writeFile(entryPath(source).data(), writer.buffer()))
+        ++m_statistics.stores;
+}
+
+ProgramCodeBlock* BytecodeCache::load(ExecState* exec, JSGlobalObject* globalObject, ProgramExecutable* executable)
+{
+    const SourceCode& source = executable->source();
+    Vector<char> buffer;
+    if (!readFile(entryPath(source).data(), buffer)) {
+        ++m_statistics.misses;
+        return 0;
+    }
+
+    ProgramCodeBlock* codeBlock = read(buffer, exec, globalObject, executable);
+    if (codeBlock)
+        ++m_statistics.hits;
+    else
+        ++m_statistics.misses;
+    return codeBlock;
+}
+
+ProgramCodeBlock* BytecodeCache::read(const Vector<char>& buffer, ExecState* exec, JSGlobalObject* globalObject, ProgramExecutable* executable)
+{
+    const SourceCode& source = executable->source();
+    EntryReader reader(buffer);
+    if (reader.read32() != entryMagic || reader.read64() != buildSignature())
+        return 0;
+    if (reader.read64() != sourceHash(source) || reader.read32() != static_cast<uint32_t>(source.length())
+        || reader.read32() != static_cast<uint32_t>(source.startOffset()) || reader.read32() != static_cast<uint32_t>(source.firstLine()))
+        return 0;
+
+    // Everything the global object is checked against comes before anything is changed.
+    SymbolTable& symbolTable = globalObject->symbolTable();
+    RegisterFile& registerFile = exec->globalData().interpreter->registerFile();
+    if (reader.read32() != registerFile.size() || reader.read32() != symbolTable.size() || reader.read64() != symbolTableDigest(symbolTable))
+        return 0;
+    if (symbolTable.size() + reader.read32() >= registerFile.maxGlobals())
+        return 0;
+
+    Vector<Identifier> functionNames;
+    for (unsigned count = reader.readCount(sizeof(uint32_t)); count; --count)
+        functionNames.append(Identifier(exec, reader.readString()));
+    for (unsigned count = reader.readCount(2 * sizeof(uint32_t)); count; --count) {
+        Identifier name(exec, reader.readString());
+        bool existing = reader.read32();
+        if (reader.failed() || globalObject->hasProperty(exec, name) != existing)
+            return 0;
+    }
+
+    Vector<std::pair<Identifier, SymbolTableEntry> > newGlobals;
+    for (unsigned count = reader.readCount(3 * sizeof(uint32_t)); count; --count) {
+        Identifier name(exec, reader.readString());
+        int index = reader.read32();
+        unsigned attributes = reader.read32();
+        newGlobals.append(make_pair(name, SymbolTableEntry(index, attributes)));
+    }
+
+    CodeFeatures features = reader.read32();
+    int firstLine = reader.read32();
+    int lastLine = reader.read32();
+    if (reader.failed())
+        return 0;
+
+    // The code block takes its flags from the executable.
+    executable->recordParse(features, firstLine, lastLine);
+    ProgramCodeBlock* codeBlock = new ProgramCodeBlock(executable, GlobalCode, globalObject, source.provider());
+    if (!readCodeBlock(reader, exec, globalObject, codeBlock) || !reader.atEnd()) {
+        delete codeBlock;
+        return 0;
+    }
+    codeBlock->shrinkToFit();
+
+    // Make the changes generating the program made.
+    {
+        BatchedTransitionOptimizer optimizer(globalObject);
+        for (size_t i = 0; i < functionNames.size(); ++i)
+            globalObject->removeDirect(functionNames[i]);
+    }
+    for (size_t i = 0; i < newGlobals.size(); ++i)
+        symbolTable.add(newGlobals[i].first.ustring().rep(), newGlobals[i].second);
+
+    return codeBlock;
+}
+
+} // namespace JSC
+
+#endif // ENABLE(BYTECODE_CACHE)
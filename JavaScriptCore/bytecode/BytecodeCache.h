@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BytecodeCache_h
+#define BytecodeCache_h
+
+#include "Identifier.h"
+#include "UString.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+#if ENABLE(BYTECODE_CACHE)
+
+namespace JSC {
+
+    class EntryReader;
+    class EntryWriter;
+    class ExecState;
+    class JSGlobalObject;
+    class ProgramCodeBlock;
+    class ProgramExecutable;
+    class ProgramNode;
+    class SourceCode;
+
+    // Program bytecode kept on disk between runs, one file per program, named
+    // after a hash of its source. An entry holds the code block's instructions,
+    // constant pool, identifiers, jump and exception tables, and the shape of
+    // the functions the program declares; function bodies are still parsed
+    // when they are first called.
+    //
+    // Generating a program also adds its functions and vars to the global
+    // object, and the code depends on what the global object held beforehand.
+    // An entry records that state and is only used when the global object is
+    // in the same state again, in which case loading it makes the same changes.
+    class BytecodeCache : public Noncopyable {
+    public:
+        // What generating a program reads from the global object. It has to be
+        // recorded before generating, which changes it.
+        struct GlobalState {
+            GlobalState()
+                : canOptimizeNewGlobals(false)
+            {
+            }
+
+            bool canOptimizeNewGlobals;
+            unsigned registerFileSize;
+            unsigned symbolTableSize;
+            uint64_t symbolTableDigest;
+            unsigned declarationCount;
+            Vector<Identifier> functionNames;
+            // Vars that are not also functions, and whether the global object already had them.
+            Vector<std::pair<Identifier, bool> > variables;
+        };
+
+        struct Statistics {
+            Statistics()
+                : hits(0)
+                , misses(0)
+                , stores(0)
+            {
+            }
+
+            size_t hits;
+            size_t misses;
+            size_t stores;
+        };
+
+        BytecodeCache(const UString& directory);
+
+        const UString& directory() const { return m_directory; }
+        const Statistics& statistics() const { return m_statistics; }
+
+        // Debug and profile hooks are left out of cached code.
+        static bool canCache(JSGlobalObject*);
+
+        // Returns a code block for the program, or 0, having changed nothing, if
+        // there is no usable entry.
+        ProgramCodeBlock* load(ExecState*, JSGlobalObject*, ProgramExecutable*);
+
+        void recordGlobalState(ExecState*, JSGlobalObject*, ProgramNode*, GlobalState&);
+        void store(ExecState*, JSGlobalObject*, ProgramExecutable*, ProgramCodeBlock*, const GlobalState&);
+
+        // Removes the entry for the source, if there is one.
+        void remove(const SourceCode&);
+
+    private:
+        CString entryPath(const SourceCode&);
+
+        static ProgramCodeBlock* read(const Vector<char>&, ExecState*, JSGlobalObject*, ProgramExecutable*);
+        static bool readCodeBlock(EntryReader&, ExecState*, JSGlobalObject*, ProgramCodeBlock*);
+        static bool writeCodeBlock(EntryWriter&, ExecState*, JSGlobalObject*, ProgramCodeBlock*);
+
+        UString m_directory;
+        Statistics m_statistics;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(BYTECODE_CACHE)
+
+#endif // BytecodeCache_h
@@ -262,6 +262,9 @@ static void printStructureStubInfo(const StructureStubInfo& stubInfo, unsigned i
     case access_put_by_id_transition:
         printf("  [%4d] %s: %s, %s, %s\n", instructionOffset, "put_by_id_transition", pointerToSourceString(stubInfo.u.putByIdTransition.previousStructure).UTF8String().data(), pointerToSourceString(stubInfo.u.putByIdTransition.structure).UTF8String().data(), pointerToSourceString(stubInfo.u.putByIdTransition.chain).UTF8String().data());
         return;
+    case access_put_by_id_transition_list:
+        printf("  [%4d] %s: %s (%d)\n", instructionOffset, "op_put_by_id_transition_list", pointerToSourceString(stubInfo.u.putByIdTransitionList.transitionList).UTF8String().data(), stubInfo.u.putByIdTransitionList.listSize);
+        return;
     case access_put_by_id_replace:
         printf("  [%4d] %s: %s\n", instructionOffset, "put_by_id_replace", pointerToSourceString(stubInfo.u.putByIdReplace.baseObjectStructure).UTF8String().data());
         return;
@@ -1219,6 +1222,29 @@ void CodeBlock::dump(ExecState* exec, const Vector<Instruction>::const_iterator&
             printf("[%4d] sampler_will_construct %s %s\n", location, registerName(exec, function).data(), registerName(exec, samplerNode).data());
             break;
         }
+#endif
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+        case op_pre_inc_loop_if_less: {
+            int r0 = (++it)->u.operand;
+            printf("[%4d] pre_inc_loop_if_less %s\n", location, registerName(exec, r0).data());
+            break;
+        }
+        case op_mov_mov: {
+            int r0 = (++it)->u.operand;
+            int r1 = (++it)->u.operand;
+            printf("[%4d] mov_mov\t\t %s, %s\n", location, registerName(exec, r0).data(), registerName(exec, r1).data());
+            break;
+        }
+        case op_mul_add: {
+            printBinaryOp(exec, location, it, "mul_add");
+            ++it;
+            break;
+        }
+        case op_add_add: {
+            printBinaryOp(exec, location, it, "add_add");
+            ++it;
+            break;
+        }
 #endif
         case op_end: {
             int r0 = (++it)->u.operand;
@@ -1373,6 +1399,9 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, PassR
     : m_numCalleeRegisters(0)
     , m_numVars(0)
     , m_numParameters(0)
+#if ENABLE(CODE_FLUSHING)
+    , m_collectionsSinceLastCall(0)
+#endif
     , m_ownerExecutable(ownerExecutable)
     , m_globalData(0)
 #ifndef NDEBUG
@@ -294,6 +294,7 @@ namespace JSC {
     };
 
     class CodeBlock : public FastAllocBase {
+        friend class BytecodeCache;
         friend class JIT;
     protected:
         CodeBlock(ScriptExecutable* ownerExecutable, CodeType, PassRefPtr<SourceProvider>, unsigned sourceOffset, SymbolTable* symbolTable);
@@ -527,6 +528,10 @@ namespace JSC {
         int m_numCalleeRegisters;
         int m_numVars;
         int m_numParameters;
+#if ENABLE(CODE_FLUSHING)
+        // Reset by op_enter, and counted up by full collections until the code is thrown away.
+        unsigned m_collectionsSinceLastCall;
+#endif
 
     private:
 #if !defined(NDEBUG) || ENABLE(OPCODE_SAMPLING)
@@ -30,6 +30,11 @@
 #include "config.h"
 #include "Opcode.h"
 
+#if ENABLE(OPCODE_STATS)
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
 using namespace std;
 
 namespace JSC {
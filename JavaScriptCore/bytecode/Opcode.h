@@ -46,6 +46,18 @@ namespace JSC {
     #define APOLLO_OPCODES(macro)
 #endif
 
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+    // Each superinstruction replaces the first opcode of a pair and has its length;
+    // the operands of the second instruction follow it unchanged.
+    #define SUPERINSTRUCTION_OPCODES(macro) \
+        macro(op_pre_inc_loop_if_less, 2) \
+        macro(op_mov_mov, 3) \
+        macro(op_mul_add, 5) \
+        macro(op_add_add, 5)
+#else
+    #define SUPERINSTRUCTION_OPCODES(macro)
+#endif
+
     #define FOR_EACH_OPCODE_ID(macro) \
         macro(op_enter, 1) \
         macro(op_enter_with_activation, 2) \
@@ -196,6 +208,8 @@ namespace JSC {
 		\
         APOLLO_OPCODES(macro) \
         \
+        SUPERINSTRUCTION_OPCODES(macro) \
+        \
         macro(op_end, 2) // end must be the last opcode in the list
 
     #define OPCODE_ID_ENUM(opcode, length) opcode,
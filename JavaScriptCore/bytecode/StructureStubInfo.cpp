@@ -60,6 +60,12 @@ void StructureStubInfo::deref()
         u.putByIdTransition.structure->deref();
         u.putByIdTransition.chain->deref();
         return;
+    case access_put_by_id_transition_list: {
+        PolymorphicTransitionList* transitionList = u.putByIdTransitionList.transitionList;
+        transitionList->derefStructures(u.putByIdTransitionList.listSize);
+        delete transitionList;
+        return;
+    }
     case access_put_by_id_replace:
         u.putByIdReplace.baseObjectStructure->deref();
         return;
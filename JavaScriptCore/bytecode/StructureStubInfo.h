@@ -42,6 +42,7 @@ namespace JSC {
         access_get_by_id_self_list,
         access_get_by_id_proto_list,
         access_put_by_id_transition,
+        access_put_by_id_transition_list,
         access_put_by_id_replace,
         access_get_by_id,
         access_put_by_id,
@@ -51,6 +52,41 @@ namespace JSC {
         access_get_string_length,
     };
 
+    // Structure transitions cached by a put_by_id that adds the same property to
+    // objects of more than one Structure. The stub for each transition falls back to
+    // the one before it when its checks fail.
+    struct PolymorphicTransitionList : FastAllocBase {
+        struct Transition {
+            CodeLocationLabel stubRoutine;
+            Structure* previousStructure;
+            Structure* structure;
+            StructureChain* chain;
+
+            void set(CodeLocationLabel _stubRoutine, Structure* _previousStructure, Structure* _structure, StructureChain* _chain)
+            {
+                stubRoutine = _stubRoutine;
+                previousStructure = _previousStructure;
+                structure = _structure;
+                chain = _chain;
+            }
+        } list[POLYMORPHIC_LIST_CACHE_SIZE];
+
+        // Takes over the references held for the first transition.
+        PolymorphicTransitionList(CodeLocationLabel stubRoutine, Structure* previousStructure, Structure* structure, StructureChain* chain)
+        {
+            list[0].set(stubRoutine, previousStructure, structure, chain);
+        }
+
+        void derefStructures(int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                list[i].previousStructure->deref();
+                list[i].structure->deref();
+                list[i].chain->deref();
+            }
+        }
+    };
+
     struct StructureStubInfo {
         StructureStubInfo(AccessType accessType)
             : accessType(accessType)
@@ -120,6 +156,14 @@ namespace JSC {
             chain->ref();
         }
 
+        void initPutByIdTransitionList(PolymorphicTransitionList* transitionList, int listSize)
+        {
+            accessType = access_put_by_id_transition_list;
+
+            u.putByIdTransitionList.transitionList = transitionList;
+            u.putByIdTransitionList.listSize = listSize;
+        }
+
         void initPutByIdReplace(Structure* baseObjectStructure)
         {
             accessType = access_put_by_id_replace;
@@ -168,6 +212,10 @@ namespace JSC {
                 Structure* structure;
                 StructureChain* chain;
             } putByIdTransition;
+            struct {
+                PolymorphicTransitionList* transitionList;
+                int listSize;
+            } putByIdTransitionList;
             struct {
                 Structure* baseObjectStructure;
             } putByIdReplace;
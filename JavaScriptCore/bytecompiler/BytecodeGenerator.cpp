@@ -152,6 +152,10 @@ void BytecodeGenerator::generate()
 
     m_scopeNode->emitBytecode(*this);
 
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+    fuseSuperinstructions();
+#endif
+
 #ifndef NDEBUG
     m_codeBlock->setInstructionCount(m_codeBlock->instructions().size());
 
@@ -165,7 +169,8 @@ void BytecodeGenerator::generate()
     m_codeBlock->setIsNumericCompareFunction(instructions() == m_globalData->numericCompareFunction(m_scopeChain->globalObject()->globalExec()));
 
 #if !ENABLE(OPCODE_SAMPLING)
-    if (!m_regeneratingForExceptionInfo && (m_codeType == FunctionCode || m_codeType == EvalCode))
+    // Allocation site sampling maps JIT return addresses back to bytecode.
+    if (!m_regeneratingForExceptionInfo && (m_codeType == FunctionCode || m_codeType == EvalCode) && !m_globalData->heap.allocationSiteSampler())
         m_codeBlock->clearExceptionInfo();
 #endif
 
@@ -598,6 +603,51 @@ void BytecodeGenerator::emitOpcode(OpcodeID opcodeID)
     m_lastOpcodeID = opcodeID;
 }
 
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+// The pairs are the most frequent ones in the interpreter's opcode pair statistics
+// (ENABLE_OPCODE_STATS) that do not rewrite themselves as they run.
+static OpcodeID superinstructionFor(OpcodeID first, OpcodeID second)
+{
+    switch (first) {
+    case op_pre_inc:
+        return second == op_loop_if_less ? op_pre_inc_loop_if_less : op_end;
+    case op_mov:
+        return second == op_mov ? op_mov_mov : op_end;
+    case op_mul:
+        return second == op_add ? op_mul_add : op_end;
+    case op_add:
+        return second == op_add ? op_add_add : op_end;
+    default:
+        return op_end;
+    }
+}
+
+// Only the opcode of the first instruction of a pair changes, so the second
+// instruction stays intact: jumps to it, and superinstructions that fall back
+// to dispatching it, still work.
+void BytecodeGenerator::fuseSuperinstructions()
+{
+    Interpreter* interpreter = globalData()->interpreter;
+    Vector<Instruction>& instructions = this->instructions();
+    size_t size = instructions.size();
+    ASSERT(size);
+
+    size_t i = 0;
+    OpcodeID opcodeID = interpreter->getOpcodeID(instructions[0].u.opcode);
+    while (true) {
+        size_t next = i + opcodeLengths[opcodeID];
+        if (next >= size)
+            break;
+        OpcodeID nextOpcodeID = interpreter->getOpcodeID(instructions[next].u.opcode);
+        OpcodeID superinstruction = superinstructionFor(opcodeID, nextOpcodeID);
+        if (superinstruction != op_end)
+            instructions[i].u.opcode = interpreter->getOpcode(superinstruction);
+        i = next;
+        opcodeID = nextOpcodeID;
+    }
+}
+#endif
+
 void BytecodeGenerator::retrieveLastBinaryOp(int& dstIndex, int& src1Index, int& src2Index)
 {
     ASSERT(instructions().size() >= 4);
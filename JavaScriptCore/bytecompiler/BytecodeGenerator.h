@@ -394,6 +394,10 @@ namespace JSC {
         void rewindBinaryOp();
         void rewindUnaryOp();
 
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+        void fuseSuperinstructions();
+#endif
+
         PassRefPtr<Label> emitComplexJumpScopes(Label* target, ControlFlowContext* topScope, ControlFlowContext* bottomScope);
 
         typedef HashMap<EncodedJSValue, unsigned, EncodedJSValueHash, EncodedJSValueHashTraits> JSValueMap;
@@ -1391,6 +1391,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
            constructor, and puts the result in register dst.
         */
         int dst = vPC[1].u.operand;
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = JSValue(constructEmptyObject(callFrame));
 
         vPC += OPCODE_LENGTH(op_new_object);
@@ -1408,6 +1409,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         int firstArg = vPC[2].u.operand;
         int argCount = vPC[3].u.operand;
         ArgList args(callFrame->registers() + firstArg, argCount);
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = JSValue(constructArray(callFrame, args));
 
         vPC += OPCODE_LENGTH(op_new_array);
@@ -1422,6 +1424,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         */
         int dst = vPC[1].u.operand;
         int regExp = vPC[2].u.operand;
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = JSValue(new (globalData) RegExpObject(callFrame->scopeChain()->globalObject->regExpStructure(), callFrame->codeBlock()->regexp(regExp)));
 
         vPC += OPCODE_LENGTH(op_new_regexp);
@@ -1722,9 +1725,10 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         int dst = vPC[1].u.operand;
         JSValue src1 = callFrame->r(vPC[2].u.operand).jsValue();
         JSValue src2 = callFrame->r(vPC[3].u.operand).jsValue();
-        if (src1.isInt32() && src2.isInt32() && !(src1.asInt32() | (src2.asInt32() & 0xc0000000))) // no overflow
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) & 0xc0000000)) // no overflow
             callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() + src2.asInt32());
         else {
+            globalData->heap.willAllocate(callFrame, vPC);
             JSValue result = jsAdd(callFrame, src1, src2);
             CHECK_FOR_EXCEPTION();
             callFrame->r(dst) = result;
@@ -1741,8 +1745,8 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         int dst = vPC[1].u.operand;
         JSValue src1 = callFrame->r(vPC[2].u.operand).jsValue();
         JSValue src2 = callFrame->r(vPC[3].u.operand).jsValue();
-        if (src1.isInt32() && src2.isInt32() && !(src1.asInt32() | src2.asInt32() >> 15)) // no overflow
-                callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() * src2.asInt32());
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) >> 15)) // no overflow
+            callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() * src2.asInt32());
         else {
             JSValue result = jsNumber(callFrame, src1.toNumber(callFrame) * src2.toNumber(callFrame));
             CHECK_FOR_EXCEPTION();
@@ -1809,7 +1813,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         int dst = vPC[1].u.operand;
         JSValue src1 = callFrame->r(vPC[2].u.operand).jsValue();
         JSValue src2 = callFrame->r(vPC[3].u.operand).jsValue();
-        if (src1.isInt32() && src2.isInt32() && !(src1.asInt32() | (src2.asInt32() & 0xc0000000))) // no overflow
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) & 0xc0000000)) // no overflow
             callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() - src2.asInt32());
         else {
             JSValue result = jsNumber(callFrame, src1.toNumber(callFrame) - src2.toNumber(callFrame));
@@ -2274,6 +2278,7 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 
         ASSERT((*iter)->isVariableObject());
         JSVariableObject* scope = static_cast<JSVariableObject*>(*iter);
+        Heap::writeBarrier(scope, callFrame->r(value).jsValue());
         scope->registerAt(index) = JSValue(callFrame->r(value).jsValue());
         vPC += OPCODE_LENGTH(op_put_scoped_var);
         NEXT_INSTRUCTION();
@@ -3540,6 +3545,7 @@ skip_id_custom_self:
         int dst = vPC[1].u.operand;
         int func = vPC[2].u.operand;
 
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = JSValue(callFrame->codeBlock()->functionDecl(func)->make(callFrame, callFrame->scopeChain()));
 
         vPC += OPCODE_LENGTH(op_new_func);
@@ -3557,6 +3563,7 @@ skip_id_custom_self:
         int funcIndex = vPC[2].u.operand;
 
         FunctionExecutable* function = callFrame->codeBlock()->functionExpr(funcIndex);
+        globalData->heap.willAllocate(callFrame, vPC);
         JSFunction* func = function->make(callFrame, callFrame->scopeChain());
 
         /* 
@@ -3936,10 +3943,18 @@ skip_id_custom_self:
 
         size_t i = 0;
         CodeBlock* codeBlock = callFrame->codeBlock();
+#if ENABLE(CODE_FLUSHING)
+        codeBlock->m_collectionsSinceLastCall = 0;
+#endif
         
         for (size_t count = codeBlock->m_numVars; i < count; ++i)
             callFrame->r(i) = jsUndefined();
 
+#if ENABLE(SAMPLING_PROFILER)
+        // Calls count as ticks too, so code that recurses rather than loops gets sampled.
+        CHECK_FOR_TIMEOUT();
+#endif
+
         vPC += OPCODE_LENGTH(op_enter);
         NEXT_INSTRUCTION();
     }
@@ -3958,15 +3973,23 @@ skip_id_custom_self:
 
         size_t i = 0;
         CodeBlock* codeBlock = callFrame->codeBlock();
+#if ENABLE(CODE_FLUSHING)
+        codeBlock->m_collectionsSinceLastCall = 0;
+#endif
 
         for (size_t count = codeBlock->m_numVars; i < count; ++i)
             callFrame->r(i) = jsUndefined();
 
         int dst = vPC[1].u.operand;
+        globalData->heap.willAllocate(callFrame, vPC);
         JSActivation* activation = new (globalData) JSActivation(callFrame, static_cast<FunctionExecutable*>(codeBlock->ownerExecutable()));
         callFrame->r(dst) = JSValue(activation);
         callFrame->setScopeChain(callFrame->scopeChain()->copy()->push(activation));
 
+#if ENABLE(SAMPLING_PROFILER)
+        CHECK_FOR_TIMEOUT();
+#endif
+
         vPC += OPCODE_LENGTH(op_enter_with_activation);
         NEXT_INSTRUCTION();
     }
@@ -4013,6 +4036,7 @@ skip_id_custom_self:
          */
         
          if (!callFrame->r(RegisterFile::ArgumentsRegister).jsValue()) {
+             globalData->heap.willAllocate(callFrame, vPC);
              Arguments* arguments = new (globalData) Arguments(callFrame);
              callFrame->setCalleeArguments(arguments);
              callFrame->r(RegisterFile::ArgumentsRegister) = JSValue(arguments);
@@ -4057,6 +4081,7 @@ skip_id_custom_self:
                 structure = asObject(prototype)->inheritorID();
             else
                 structure = callDataScopeChain->globalObject->emptyObjectStructure();
+            globalData->heap.willAllocate(callFrame, vPC);
             JSObject* newObject = new (globalData) JSObject(structure);
 
             callFrame->r(thisRegister) = JSValue(newObject); // "this" value
@@ -4128,6 +4153,7 @@ skip_id_custom_self:
         int src = vPC[2].u.operand;
         int count = vPC[3].u.operand;
 
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = jsString(callFrame, &callFrame->registers()[src], count);
         CHECK_FOR_EXCEPTION();
         vPC += OPCODE_LENGTH(op_strcat);
@@ -4193,8 +4219,10 @@ skip_id_custom_self:
         JSObject* o = v.toObject(callFrame);
         Structure* structure = o->structure();
         JSPropertyNameIterator* jsPropertyNameIterator = structure->enumerationCache();
-        if (!jsPropertyNameIterator || jsPropertyNameIterator->cachedPrototypeChain() != structure->prototypeChain(callFrame))
+        if (!jsPropertyNameIterator || jsPropertyNameIterator->cachedPrototypeChain() != structure->prototypeChain(callFrame)) {
+            globalData->heap.willAllocate(callFrame, vPC);
             jsPropertyNameIterator = JSPropertyNameIterator::create(callFrame, o);
+        }
 
         callFrame->r(dst) = jsPropertyNameIterator;
         callFrame->r(base) = JSValue(o);
@@ -4262,6 +4290,7 @@ skip_id_custom_self:
            object is then pushed onto the ScopeChain.  The scope object is then stored
            in dst for GC.
          */
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->setScopeChain(createExceptionScope(callFrame, vPC));
 
         vPC += OPCODE_LENGTH(op_push_new_scope);
@@ -4322,6 +4351,7 @@ skip_id_custom_self:
         int message = vPC[3].u.operand;
 
         CodeBlock* codeBlock = callFrame->codeBlock();
+        globalData->heap.willAllocate(callFrame, vPC);
         callFrame->r(dst) = JSValue(Error::create(callFrame, (ErrorType)type, callFrame->r(message).jsValue().toString(callFrame), codeBlock->lineNumberForBytecodeOffset(callFrame, vPC - codeBlock->instructions().begin()), codeBlock->ownerExecutable()->sourceID(), codeBlock->ownerExecutable()->sourceURL()));
 
         vPC += OPCODE_LENGTH(op_new_error);
@@ -4533,6 +4563,108 @@ skip_id_custom_self:
         vPC += 3;
         NEXT_INSTRUCTION();
     }
+#endif
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS)
+    DEFINE_OPCODE(op_pre_inc_loop_if_less) {
+        /* pre_inc_loop_if_less srcDst(r)
+
+           Superinstruction for pre_inc followed by loop_if_less. Performs
+           the pre_inc, then the loop_if_less whose operands follow if both
+           of them are int32s; otherwise dispatches the loop_if_less.
+        */
+        int srcDst = vPC[1].u.operand;
+        JSValue v = callFrame->r(srcDst).jsValue();
+        if (v.isInt32() && v.asInt32() < INT_MAX)
+            callFrame->r(srcDst) = jsNumber(callFrame, v.asInt32() + 1);
+        else {
+            JSValue result = jsNumber(callFrame, v.toNumber(callFrame) + 1);
+            CHECK_FOR_EXCEPTION();
+            callFrame->r(srcDst) = result;
+        }
+        vPC += OPCODE_LENGTH(op_pre_inc);
+
+        JSValue src1 = callFrame->r(vPC[1].u.operand).jsValue();
+        JSValue src2 = callFrame->r(vPC[2].u.operand).jsValue();
+        if (!src1.isInt32() || !src2.isInt32()) {
+            NEXT_INSTRUCTION();
+        }
+
+        if (src1.asInt32() < src2.asInt32()) {
+            vPC += vPC[3].u.operand;
+            CHECK_FOR_TIMEOUT();
+            NEXT_INSTRUCTION();
+        }
+
+        vPC += OPCODE_LENGTH(op_loop_if_less);
+        NEXT_INSTRUCTION();
+    }
+    DEFINE_OPCODE(op_mov_mov) {
+        /* mov_mov dst(r) src(r)
+
+           Superinstruction for two movs: performs this one and the mov
+           whose operands follow.
+        */
+        callFrame->r(vPC[1].u.operand) = callFrame->r(vPC[2].u.operand);
+        callFrame->r(vPC[4].u.operand) = callFrame->r(vPC[5].u.operand);
+
+        vPC += OPCODE_LENGTH(op_mov) + OPCODE_LENGTH(op_mov);
+        NEXT_INSTRUCTION();
+    }
+    DEFINE_OPCODE(op_mul_add) {
+        /* mul_add dst(r) src1(r) src2(r)
+
+           Superinstruction for mul followed by add. Performs the mul, then
+           the add whose operands follow if it can be done without overflow
+           on int32s; otherwise dispatches the add.
+        */
+        int dst = vPC[1].u.operand;
+        JSValue src1 = callFrame->r(vPC[2].u.operand).jsValue();
+        JSValue src2 = callFrame->r(vPC[3].u.operand).jsValue();
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) >> 15)) // no overflow
+            callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() * src2.asInt32());
+        else {
+            JSValue result = jsNumber(callFrame, src1.toNumber(callFrame) * src2.toNumber(callFrame));
+            CHECK_FOR_EXCEPTION();
+            callFrame->r(dst) = result;
+        }
+        vPC += OPCODE_LENGTH(op_mul);
+
+        src1 = callFrame->r(vPC[2].u.operand).jsValue();
+        src2 = callFrame->r(vPC[3].u.operand).jsValue();
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) & 0xc0000000)) { // no overflow
+            callFrame->r(vPC[1].u.operand) = jsNumber(callFrame, src1.asInt32() + src2.asInt32());
+            vPC += OPCODE_LENGTH(op_add);
+        }
+        NEXT_INSTRUCTION();
+    }
+    DEFINE_OPCODE(op_add_add) {
+        /* add_add dst(r) src1(r) src2(r)
+
+           Superinstruction for two adds. Performs this add, then the add
+           whose operands follow if it can be done without overflow on
+           int32s; otherwise dispatches the second add.
+        */
+        int dst = vPC[1].u.operand;
+        JSValue src1 = callFrame->r(vPC[2].u.operand).jsValue();
+        JSValue src2 = callFrame->r(vPC[3].u.operand).jsValue();
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) & 0xc0000000)) // no overflow
+            callFrame->r(dst) = jsNumber(callFrame, src1.asInt32() + src2.asInt32());
+        else {
+            globalData->heap.willAllocate(callFrame, vPC);
+            JSValue result = jsAdd(callFrame, src1, src2);
+            CHECK_FOR_EXCEPTION();
+            callFrame->r(dst) = result;
+        }
+        vPC += OPCODE_LENGTH(op_add);
+
+        src1 = callFrame->r(vPC[2].u.operand).jsValue();
+        src2 = callFrame->r(vPC[3].u.operand).jsValue();
+        if (src1.isInt32() && src2.isInt32() && !((src1.asInt32() | src2.asInt32()) & 0xc0000000)) { // no overflow
+            callFrame->r(vPC[1].u.operand) = jsNumber(callFrame, src1.asInt32() + src2.asInt32());
+            vPC += OPCODE_LENGTH(op_add);
+        }
+        NEXT_INSTRUCTION();
+    }
 #endif
     vm_throw: {
         globalData->exception = JSValue();
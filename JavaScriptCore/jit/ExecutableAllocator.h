@@ -154,6 +154,22 @@ public:
         m_smallAllocationPool = ExecutablePool::create(JIT_ALLOCATOR_LARGE_ALLOC_SIZE);
     }
 
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
+    // How the fixed reservation that all executable memory comes from is being used.
+    struct Statistics {
+        size_t reservedBytes;
+        size_t bytesAllocated;
+        size_t highWaterMark; // The most bytes allocated at once.
+        size_t allocations;
+        size_t sizeClassAllocations; // Allocations that reused a freed chunk of exactly the right size.
+        size_t coalesces;
+        size_t freeChunks;
+        size_t largestFreeChunk;
+    };
+
+    static Statistics statistics();
+#endif
+
     PassRefPtr<ExecutablePool> poolForSize(size_t n)
     {
         // Try to fit in the existing small allocator
@@ -27,16 +27,20 @@
 
 #include "ExecutableAllocator.h"
 
-#if ENABLE(ASSEMBLER) && OS(DARWIN) && CPU(X86_64)
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
 
 #include <errno.h>
 
 #include "TCSpinLock.h"
+#if OS(DARWIN)
 #include <mach/mach_init.h>
 #include <mach/vm_map.h>
+#endif
+#include <stdlib.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <wtf/AVLTree.h>
+#include <wtf/RandomNumber.h>
 #include <wtf/VMTags.h>
 
 using namespace WTF;
@@ -46,6 +50,11 @@ namespace JSC {
 #define TWO_GB (2u * 1024u * 1024u * 1024u)
 #define SIXTEEN_MB (16u * 1024u * 1024u)
 
+// Freed chunks of up to this many pages are kept in a free list per size, rather than in the
+// tree. Pools for small stubs and small functions come and go all the time, and this lets them
+// reuse each other's memory without splitting the larger chunks in the tree.
+static const size_t numberOfSizeClasses = 16;
+
 // FreeListEntry describes a free chunk of memory, stored in the freeList.
 struct FreeListEntry {
     FreeListEntry(void* pointer, size_t size)
@@ -93,22 +102,15 @@ struct AVLTreeAbstractorForFreeList {
     int compare_node_node(handle h1, handle h2) { return compare_key_key(h1->size, h2->size); }
 };
 
-// Used to reverse sort an array of FreeListEntry pointers.
-static int reverseSortFreeListEntriesByPointer(const void* leftPtr, const void* rightPtr)
+// Used to sort an array of FreeListEntry pointers by address.
+static int sortFreeListEntriesByPointer(const void* leftPtr, const void* rightPtr)
 {
     FreeListEntry* left = *(FreeListEntry**)leftPtr;
     FreeListEntry* right = *(FreeListEntry**)rightPtr;
 
-    return (intptr_t)(right->pointer) - (intptr_t)(left->pointer);
-}
-
-// Used to reverse sort an array of pointers.
-static int reverseSortCommonSizedAllocations(const void* leftPtr, const void* rightPtr)
-{
-    void* left = *(void**)leftPtr;
-    void* right = *(void**)rightPtr;
-
-    return (intptr_t)right - (intptr_t)left;
+    if (left->pointer == right->pointer)
+        return 0;
+    return left->pointer < right->pointer ? -1 : 1;
 }
 
 class FixedVMPoolAllocator
@@ -140,6 +142,17 @@ class FixedVMPoolAllocator
     void reuse(void*, size_t) {}
 #endif
 
+    // Which of m_sizeClassFreeLists holds free chunks of this size, or -1 if they go in the tree.
+    int sizeClassFor(size_t size)
+    {
+        if (size % JIT_ALLOCATOR_PAGE_SIZE)
+            return -1;
+        size_t pages = size / JIT_ALLOCATOR_PAGE_SIZE;
+        if (!pages || pages > numberOfSizeClasses)
+            return -1;
+        return pages - 1;
+    }
+
     // All addition to the free list should go through this method, rather than
     // calling insert directly, to avoid multiple entries beging added with the
     // same key.  All nodes being added should be singletons, they should not
@@ -148,8 +161,9 @@ class FixedVMPoolAllocator
     {
         ASSERT(!entry->nextEntry);
 
-        if (entry->size == m_commonSize) {
-            m_commonSizedAllocations.append(entry->pointer);
+        int sizeClass = sizeClassFor(entry->size);
+        if (sizeClass >= 0) {
+            m_sizeClassFreeLists[sizeClass].append(entry->pointer);
             delete entry;
         } else if (FreeListEntry* entryInFreeList = m_freeList.search(entry->size, m_freeList.EQUAL)) {
             // m_freeList already contain an entry for this size - insert this node into the chain.
@@ -161,8 +175,9 @@ class FixedVMPoolAllocator
 
     // We do not attempt to coalesce addition, which may lead to fragmentation;
     // instead we periodically perform a sweep to try to coalesce neigboring
-    // entries in m_freeList.  Presently this is triggered at the point 16MB
-    // of memory has been released.
+    // free chunks, whether they are in m_freeList or in a size class.  Presently
+    // this is triggered at the point 16MB of memory has been released, and when
+    // an allocation finds nothing large enough.
     void coalesceFreeSpace()
     {
         Vector<FreeListEntry*> freeListEntries;
@@ -186,101 +201,45 @@ class FixedVMPoolAllocator
         // All entries are now in the Vector; purge the tree.
         m_freeList.purge();
 
-        // Reverse-sort the freeListEntries and m_commonSizedAllocations Vectors.
-        // We reverse-sort so that we can logically work forwards through memory,
-        // whilst popping items off the end of the Vectors using last() and removeLast().
-        qsort(freeListEntries.begin(), freeListEntries.size(), sizeof(FreeListEntry*), reverseSortFreeListEntriesByPointer);
-        qsort(m_commonSizedAllocations.begin(), m_commonSizedAllocations.size(), sizeof(void*), reverseSortCommonSizedAllocations);
-
-        // The entries from m_commonSizedAllocations that cannot be
-        // coalesced into larger chunks will be temporarily stored here.
-        Vector<void*> newCommonSizedAllocations;
-
-        // Keep processing so long as entries remain in either of the vectors.
-        while (freeListEntries.size() || m_commonSizedAllocations.size()) {
-            // We're going to try to find a FreeListEntry node that we can coalesce onto.
-            FreeListEntry* coalescionEntry = 0;
-
-            // Is the lowest addressed chunk of free memory of common-size, or is it in the free list?
-            if (m_commonSizedAllocations.size() && (!freeListEntries.size() || (m_commonSizedAllocations.last() < freeListEntries.last()->pointer))) {
-                // Pop an item from the m_commonSizedAllocations vector - this is the lowest
-                // addressed free chunk.  Find out the begin and end addresses of the memory chunk.
-                void* begin = m_commonSizedAllocations.last();
-                void* end = (void*)((intptr_t)begin + m_commonSize);
-                m_commonSizedAllocations.removeLast();
-
-                // Try to find another free chunk abutting onto the end of the one we have already found.
-                if (freeListEntries.size() && (freeListEntries.last()->pointer == end)) {
-                    // There is an existing FreeListEntry for the next chunk of memory!
-                    // we can reuse this.  Pop it off the end of m_freeList.
-                    coalescionEntry = freeListEntries.last();
-                    freeListEntries.removeLast();
-                    // Update the existing node to include the common-sized chunk that we also found. 
-                    coalescionEntry->pointer = (void*)((intptr_t)coalescionEntry->pointer - m_commonSize);
-                    coalescionEntry->size += m_commonSize;
-                } else if (m_commonSizedAllocations.size() && (m_commonSizedAllocations.last() == end)) {
-                    // There is a second common-sized chunk that can be coalesced.
-                    // Allocate a new node.
-                    m_commonSizedAllocations.removeLast();
-                    coalescionEntry = new FreeListEntry(begin, 2 * m_commonSize);
-                } else {
-                    // Nope - this poor little guy is all on his own. :-(
-                    // Add him into the newCommonSizedAllocations vector for now, we're
-                    // going to end up adding him back into the m_commonSizedAllocations
-                    // list when we're done.
-                    newCommonSizedAllocations.append(begin);
-                    continue;
-                }
-            } else {
-                ASSERT(freeListEntries.size());
-                ASSERT(!m_commonSizedAllocations.size() || (freeListEntries.last()->pointer < m_commonSizedAllocations.last()));
-                // The lowest addressed item is from m_freeList; pop it from the Vector.
-                coalescionEntry = freeListEntries.last();
-                freeListEntries.removeLast();
-            }
-            
-            // Right, we have a FreeListEntry, we just need check if there is anything else
-            // to coalesce onto the end.
-            ASSERT(coalescionEntry);
-            while (true) {
-                // Calculate the end address of the chunk we have found so far.
-                void* end = (void*)((intptr_t)coalescionEntry->pointer - coalescionEntry->size);
-
-                // Is there another chunk adjacent to the one we already have?
-                if (freeListEntries.size() && (freeListEntries.last()->pointer == end)) {
-                    // Yes - another FreeListEntry -pop it from the list.
-                    FreeListEntry* coalescee = freeListEntries.last();
-                    freeListEntries.removeLast();
-                    // Add it's size onto our existing node.
-                    coalescionEntry->size += coalescee->size;
-                    delete coalescee;
-                } else if (m_commonSizedAllocations.size() && (m_commonSizedAllocations.last() == end)) {
-                    // We can coalesce the next common-sized chunk.
-                    m_commonSizedAllocations.removeLast();
-                    coalescionEntry->size += m_commonSize;
-                } else
-                    break; // Nope, nothing to be added - stop here.
-            }
+        // Add the size classes' chunks to the same Vector.
+        for (size_t sizeClass = 0; sizeClass < numberOfSizeClasses; ++sizeClass) {
+            Vector<void*>& sizeClassFreeList = m_sizeClassFreeLists[sizeClass];
+            for (size_t i = 0; i < sizeClassFreeList.size(); ++i)
+                freeListEntries.append(new FreeListEntry(sizeClassFreeList[i], (sizeClass + 1) * JIT_ALLOCATOR_PAGE_SIZE));
+            sizeClassFreeList.clear();
+        }
 
-            // We've coalesced everything we can onto the current chunk.
-            // Add it back into m_freeList.
-            addToFreeList(coalescionEntry);
+        // Work forwards through memory, merging each chunk into the one before
+        // it where they abut, and hand every merged chunk back to the free lists.
+        qsort(freeListEntries.begin(), freeListEntries.size(), sizeof(FreeListEntry*), sortFreeListEntriesByPointer);
+        FreeListEntry* coalescionEntry = 0;
+        for (size_t i = 0; i < freeListEntries.size(); ++i) {
+            FreeListEntry* entry = freeListEntries[i];
+            if (coalescionEntry && static_cast<char*>(coalescionEntry->pointer) + coalescionEntry->size == entry->pointer) {
+                coalescionEntry->size += entry->size;
+                delete entry;
+                continue;
+            }
+            if (coalescionEntry)
+                addToFreeList(coalescionEntry);
+            coalescionEntry = entry;
         }
+        if (coalescionEntry)
+            addToFreeList(coalescionEntry);
 
-        // All chunks of free memory larger than m_commonSize should be
-        // back in m_freeList by now.  All that remains to be done is to
-        // copy the contents on the newCommonSizedAllocations back into
-        // the m_commonSizedAllocations Vector.
-        ASSERT(m_commonSizedAllocations.size() == 0);
-        m_commonSizedAllocations.append(newCommonSizedAllocations);
+        ++m_coalesces;
     }
 
 public:
 
-    FixedVMPoolAllocator(size_t commonSize, size_t totalHeapSize)
-        : m_commonSize(commonSize)
-        , m_countFreedSinceLastCoalesce(0)
+    FixedVMPoolAllocator(size_t totalHeapSize)
+        : m_countFreedSinceLastCoalesce(0)
         , m_totalHeapSize(totalHeapSize)
+        , m_bytesAllocated(0)
+        , m_highWaterMark(0)
+        , m_allocations(0)
+        , m_sizeClassAllocations(0)
+        , m_coalesces(0)
     {
         // Cook up an address to allocate at, using the following recipe:
         //   17 bits of zero, stay in userspace kids.
@@ -291,11 +250,15 @@ public:
         // for now instead of 2^26 bits of ASLR lets stick with 25 bits of randomization plus
         // 2^24, which should put up somewhere in the middle of usespace (in the address range
         // 0x200000000000 .. 0x5fffffffffff).
+#if OS(DARWIN)
         intptr_t randomLocation = arc4random() & ((1 << 25) - 1);
+#else
+        intptr_t randomLocation = static_cast<intptr_t>(randomNumber() * (1 << 25));
+#endif
         randomLocation += (1 << 24);
         randomLocation <<= 21;
         m_base = mmap(reinterpret_cast<void*>(randomLocation), m_totalHeapSize, INITIAL_PROTECTION_FLAGS, MAP_PRIVATE | MAP_ANON, VM_TAG_FOR_EXECUTABLEALLOCATOR_MEMORY, 0);
-        if (!m_base)
+        if (m_base == MAP_FAILED)
             CRASH();
 
         // For simplicity, we keep all memory in m_freeList in a 'released' state.
@@ -311,12 +274,14 @@ public:
     {
         void* result;
 
-        // Freed allocations of the common size are not stored back into the main
-        // m_freeList, but are instead stored in a separate vector.  If the request
-        // is for a common sized allocation, check this list.
-        if ((size == m_commonSize) && m_commonSizedAllocations.size()) {
-            result = m_commonSizedAllocations.last();
-            m_commonSizedAllocations.removeLast();
+        // Freed allocations of a size class are not stored back into the main
+        // m_freeList, but are instead stored in a separate vector per size.  If
+        // the request is for one of these sizes, check its vector.
+        int sizeClass = sizeClassFor(size);
+        if (sizeClass >= 0 && m_sizeClassFreeLists[sizeClass].size()) {
+            result = m_sizeClassFreeLists[sizeClass].last();
+            m_sizeClassFreeLists[sizeClass].removeLast();
+            ++m_sizeClassAllocations;
         } else {
             // Serach m_freeList for a suitable sized chunk to allocate memory from.
             FreeListEntry* entry = m_freeList.search(size, m_freeList.GREATER_EQUAL);
@@ -325,13 +290,24 @@ public:
             if (!entry) {
                 // Errk!  Lets take a last-ditch desparation attempt at defragmentation...
                 coalesceFreeSpace();
-                // Did that free up a large enough chunk?
+                // Did that free up a chunk of the right size class, or a large enough chunk?
+                if (sizeClass >= 0 && m_sizeClassFreeLists[sizeClass].size())
+                    return alloc(size);
                 entry = m_freeList.search(size, m_freeList.GREATER_EQUAL);
+                // If not, split the smallest chunk from a larger size class; it goes into
+                // the tree only so that it can be taken out and split below.
+                for (int largerSizeClass = sizeClass + 1; !entry && sizeClass >= 0 && largerSizeClass < static_cast<int>(numberOfSizeClasses); ++largerSizeClass) {
+                    if (m_sizeClassFreeLists[largerSizeClass].size()) {
+                        entry = new FreeListEntry(m_sizeClassFreeLists[largerSizeClass].last(), (largerSizeClass + 1) * JIT_ALLOCATOR_PAGE_SIZE);
+                        m_sizeClassFreeLists[largerSizeClass].removeLast();
+                        m_freeList.insert(entry);
+                    }
+                }
                 // No?...  *BOOM!*
                 if (!entry)
                     CRASH();
             }
-            ASSERT(entry->size != m_commonSize);
+            ASSERT(sizeClassFor(entry->size) < 0 || !entry->nextEntry);
 
             // Remove the entry from m_freeList.  But! -
             // Each entry in the tree may represent a chain of multiple chunks of the
@@ -354,15 +330,19 @@ public:
             if (entry->size == size)
                 delete entry;
             else {
-                // There is memory left over, and it is not of the common size.
-                // We can reuse the existing FreeListEntry node to add this back
-                // into m_freeList.
+                // There is memory left over.  We can reuse the existing
+                // FreeListEntry node to add this back into the free lists.
                 entry->pointer = (void*)((intptr_t)entry->pointer + size);
                 entry->size -= size;
                 addToFreeList(entry);
             }
         }
 
+        ++m_allocations;
+        m_bytesAllocated += size;
+        if (m_bytesAllocated > m_highWaterMark)
+            m_highWaterMark = m_bytesAllocated;
+
         // Call reuse to report to the operating system that this memory is in use.
         ASSERT(isWithinVMPool(result, size));
         reuse(result, size);
@@ -376,12 +356,12 @@ public:
         ASSERT(isWithinVMPool(pointer, size));
         release(pointer, size);
 
-        // Common-sized allocations are stored in the m_commonSizedAllocations
-        // vector; all other freed chunks are added to m_freeList.
-        if (size == m_commonSize)
-            m_commonSizedAllocations.append(pointer);
-        else
-            addToFreeList(new FreeListEntry(pointer, size));
+        ASSERT(m_bytesAllocated >= size);
+        m_bytesAllocated -= size;
+
+        // Chunks of a size class are stored in that size's vector;
+        // all other freed chunks are added to m_freeList.
+        addToFreeList(new FreeListEntry(pointer, size));
 
         // Do some housekeeping.  Every time we reach a point that
         // 16MB of allocations have been freed, sweep m_freeList
@@ -393,6 +373,34 @@ public:
         }
     }
 
+    ExecutableAllocator::Statistics statistics()
+    {
+        ExecutableAllocator::Statistics statistics;
+        statistics.reservedBytes = m_totalHeapSize;
+        statistics.bytesAllocated = m_bytesAllocated;
+        statistics.highWaterMark = m_highWaterMark;
+        statistics.allocations = m_allocations;
+        statistics.sizeClassAllocations = m_sizeClassAllocations;
+        statistics.coalesces = m_coalesces;
+        statistics.freeChunks = 0;
+        statistics.largestFreeChunk = 0;
+
+        SizeSortedFreeTree::Iterator iter;
+        iter.start_iter_least(m_freeList);
+        for (FreeListEntry* entry; (entry = *iter); ++iter) {
+            for (; entry; entry = entry->nextEntry) {
+                ++statistics.freeChunks;
+                statistics.largestFreeChunk = std::max(statistics.largestFreeChunk, entry->size);
+            }
+        }
+        for (size_t sizeClass = 0; sizeClass < numberOfSizeClasses; ++sizeClass) {
+            statistics.freeChunks += m_sizeClassFreeLists[sizeClass].size();
+            if (m_sizeClassFreeLists[sizeClass].size())
+                statistics.largestFreeChunk = std::max(statistics.largestFreeChunk, (sizeClass + 1) * JIT_ALLOCATOR_PAGE_SIZE);
+        }
+        return statistics;
+    }
+
 private:
 
 #ifndef NDEBUG
@@ -402,9 +410,8 @@ private:
     }
 #endif
 
-    // Freed space from the most common sized allocations will be held in this list, ...
-    const size_t m_commonSize;
-    Vector<void*> m_commonSizedAllocations;
+    // Freed chunks of up to numberOfSizeClasses pages will be held in these lists, indexed by pages - 1, ...
+    Vector<void*> m_sizeClassFreeLists[numberOfSizeClasses];
 
     // ... and all other freed allocations are held in m_freeList.
     SizeSortedFreeTree m_freeList;
@@ -414,6 +421,13 @@ private:
 
     void* m_base;
     size_t m_totalHeapSize;
+
+    // Statistics, for ExecutableAllocator::statistics().
+    size_t m_bytesAllocated;
+    size_t m_highWaterMark;
+    size_t m_allocations;
+    size_t m_sizeClassAllocations;
+    size_t m_coalesces;
 };
 
 void ExecutableAllocator::intializePageSize()
@@ -429,7 +443,7 @@ ExecutablePool::Allocation ExecutablePool::systemAlloc(size_t size)
   SpinLockHolder lock_holder(&spinlock);
 
     if (!allocator)
-        allocator = new FixedVMPoolAllocator(JIT_ALLOCATOR_LARGE_ALLOC_SIZE, TWO_GB);
+        allocator = new FixedVMPoolAllocator(TWO_GB);
     ExecutablePool::Allocation alloc = {reinterpret_cast<char*>(allocator->alloc(size)), size};
     return alloc;
 }
@@ -442,6 +456,17 @@ void ExecutablePool::systemRelease(const ExecutablePool::Allocation& allocation)
     allocator->free(allocation.pages, allocation.size);
 }
 
+ExecutableAllocator::Statistics ExecutableAllocator::statistics()
+{
+    SpinLockHolder lock_holder(&spinlock);
+
+    if (!allocator) {
+        Statistics statistics = { TWO_GB, 0, 0, 0, 0, 0, 1, TWO_GB };
+        return statistics;
+    }
+    return allocator->statistics();
+}
+
 }
 
-#endif // HAVE(ASSEMBLER)
+#endif // ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
@@ -35,7 +35,7 @@
 
 namespace JSC {
 
-#if !(OS(DARWIN) && CPU(X86_64))
+#if !ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
 
 void ExecutableAllocator::intializePageSize()
 {
@@ -57,7 +57,7 @@ void ExecutablePool::systemRelease(const ExecutablePool::Allocation& alloc)
     ASSERT_UNUSED(result, !result);
 }
 
-#endif // !(OS(DARWIN) && CPU(X86_64))
+#endif // !ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
 
 #if ENABLE(ASSEMBLER_WX_EXCLUSIVE)
 void ExecutableAllocator::reprotectRegion(void* start, size_t size, ProtectionSeting setting)
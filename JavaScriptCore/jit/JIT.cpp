@@ -71,6 +71,25 @@ void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAd
     repatchBuffer.relinkCallerToFunction(returnAddress, newCalleeFunction);
 }
 
+#if ENABLE(SAMPLING_COUNTERS)
+GlobalSamplingCounter GetByIdCounters::fastPath;
+GlobalSamplingCounter GetByIdCounters::selfListStub;
+GlobalSamplingCounter GetByIdCounters::prototypeStub;
+GlobalSamplingCounter GetByIdCounters::megamorphicCache;
+GlobalSamplingCounter GetByIdCounters::megamorphicCacheMiss;
+GlobalSamplingCounter GetByIdCounters::generic;
+
+void GetByIdCounters::nameCounters()
+{
+    fastPath.name("get_by_id fast path");
+    selfListStub.name("get_by_id self list stub");
+    prototypeStub.name("get_by_id prototype stub");
+    megamorphicCache.name("get_by_id megamorphic cache hit");
+    megamorphicCacheMiss.name("get_by_id megamorphic cache miss");
+    generic.name("get_by_id generic");
+}
+#endif
+
 JIT::JIT(JSGlobalData* globalData, CodeBlock* codeBlock)
     : m_interpreter(globalData->interpreter)
     , m_globalData(globalData)
@@ -92,9 +111,249 @@ JIT::JIT(JSGlobalData* globalData, CodeBlock* codeBlock)
     , m_lastResultBytecodeRegister(std::numeric_limits<int>::max())
     , m_jumpTargetsPosition(0)
 #endif
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    , m_registerCacheEnabled(false)
+    , m_registerCacheVictim(0)
+    , m_registerCacheJumpTargetsPosition(0)
+#endif
 {
 }
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+// Opcodes whose fast paths touch virtual registers only through emitGetVirtualRegister and
+// emitPutVirtualRegister, unconditionally, and make no calls other than through JITStubCall.
+// Values stay in the cache registers across runs of these; any other opcode starts and ends
+// with an empty cache.
+bool JIT::opcodeKeepsCachedRegisters(OpcodeID opcodeID)
+{
+    switch (opcodeID) {
+    case op_mov:
+    case op_add:
+    case op_sub:
+    case op_mul:
+    case op_div:
+    case op_mod:
+    case op_lshift:
+    case op_rshift:
+    case op_urshift:
+    case op_bitand:
+    case op_bitor:
+    case op_bitxor:
+    case op_bitnot:
+    case op_pre_inc:
+    case op_pre_dec:
+    case op_post_inc:
+    case op_post_dec:
+    case op_not:
+    case op_eq:
+    case op_neq:
+    case op_stricteq:
+    case op_nstricteq:
+    case op_to_jsnumber:
+    case op_jmp:
+    case op_loop:
+    case op_jtrue:
+    case op_jfalse:
+    case op_loop_if_true:
+    case op_loop_if_false:
+    case op_jless:
+    case op_jnless:
+    case op_jlesseq:
+    case op_jnlesseq:
+    case op_loop_if_less:
+    case op_loop_if_lesseq:
+    case op_get_by_val:
+    case op_put_by_val:
+    case op_get_global_var:
+    case op_get_scoped_var:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool JIT::opcodeEndsBlock(OpcodeID opcodeID)
+{
+    switch (opcodeID) {
+    case op_jmp:
+    case op_loop:
+    case op_jtrue:
+    case op_jfalse:
+    case op_loop_if_true:
+    case op_loop_if_false:
+    case op_jless:
+    case op_jnless:
+    case op_jlesseq:
+    case op_jnlesseq:
+    case op_loop_if_less:
+    case op_loop_if_lesseq:
+        return true;
+    default:
+        return false;
+    }
+}
+#endif
+
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+// Whether an operand of an instruction is only ever read. Anything not listed here counts as a
+// write, which just stops a loop from being treated as counted.
+static bool isReadOnlyOperand(OpcodeID opcodeID, int operand)
+{
+    switch (opcodeID) {
+    case op_mov:
+    case op_not:
+    case op_bitnot:
+    case op_negate:
+    case op_to_jsnumber:
+    case op_get_by_id:
+        return operand == 2;
+    case op_add:
+    case op_sub:
+    case op_mul:
+    case op_div:
+    case op_mod:
+    case op_lshift:
+    case op_rshift:
+    case op_urshift:
+    case op_bitand:
+    case op_bitor:
+    case op_bitxor:
+    case op_eq:
+    case op_neq:
+    case op_stricteq:
+    case op_nstricteq:
+    case op_less:
+    case op_lesseq:
+    case op_get_by_val:
+        return operand == 2 || operand == 3;
+    case op_put_by_val:
+        return true;
+    case op_put_by_id:
+        return operand == 1 || operand == 3;
+    case op_jtrue:
+    case op_jfalse:
+    case op_loop_if_true:
+    case op_loop_if_false:
+    case op_ret:
+        return operand == 1;
+    case op_jless:
+    case op_jnless:
+    case op_jlesseq:
+    case op_jnlesseq:
+    case op_loop_if_less:
+    case op_loop_if_lesseq:
+        return operand == 1 || operand == 2;
+    default:
+        return false;
+    }
+}
+
+// Finds loops the BytecodeGenerator emits for "for (i = <int>; i < bound; ++i)":
+//
+//     mov i, <int>
+//     jmp condition
+//   top:
+//     ...
+//     pre_inc i
+//   condition:
+//     loop_if_less i, bound, top
+//
+// Structured control flow means the body is only entered through the condition. The counter
+// starts as an int32, and the increment only runs after the condition has seen it below an int32
+// bound, so it stays an int32 as long as the bound does.
+void JIT::findCountedLoops()
+{
+    // Nested functions, eval and the arguments object can all write to the counter behind our back.
+    if (m_codeBlock->codeType() != FunctionCode || m_codeBlock->needsFullScopeChain() || m_codeBlock->usesEval() || m_codeBlock->usesArguments())
+        return;
+
+    Instruction* instructionsBegin = m_codeBlock->instructions().begin();
+    unsigned instructionCount = m_codeBlock->instructions().size();
+    unsigned jumpTargetsPosition = 0;
+    unsigned previous = 0;
+
+    Vector<CountedLoop> candidates;
+    for (unsigned bytecodeIndex = 0; bytecodeIndex < instructionCount; ) {
+        Instruction* currentInstruction = instructionsBegin + bytecodeIndex;
+        OpcodeID opcodeID = m_interpreter->getOpcodeID(currentInstruction->u.opcode);
+
+        bool atJumpTarget = false;
+        while (jumpTargetsPosition < m_codeBlock->numberOfJumpTargets() && m_codeBlock->jumpTarget(jumpTargetsPosition) <= bytecodeIndex) {
+            if (m_codeBlock->jumpTarget(jumpTargetsPosition) == bytecodeIndex)
+                atJumpTarget = true;
+            ++jumpTargetsPosition;
+        }
+
+        if (opcodeID == op_jmp && !atJumpTarget && bytecodeIndex && currentInstruction[1].u.operand > 0) {
+            Instruction* initializer = instructionsBegin + previous;
+            if (m_interpreter->getOpcodeID(initializer->u.opcode) == op_mov && isOperandConstantImmediateInt(initializer[2].u.operand)) {
+                CountedLoop loop;
+                loop.entry = bytecodeIndex;
+                loop.top = bytecodeIndex + OPCODE_LENGTH(op_jmp);
+                loop.condition = bytecodeIndex + currentInstruction[1].u.operand;
+                loop.counter = initializer[1].u.operand;
+                candidates.append(loop);
+            }
+        }
+
+        if (opcodeID == op_loop_if_less || opcodeID == op_loop_if_lesseq) {
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                CountedLoop& loop = candidates[i];
+                if (loop.condition != bytecodeIndex)
+                    continue;
+
+                int counter = currentInstruction[1].u.operand;
+                int bound = currentInstruction[2].u.operand;
+                Instruction* increment = instructionsBegin + previous;
+                if (counter != loop.counter || bytecodeIndex + currentInstruction[3].u.operand != loop.top || previous < loop.top
+                    || m_interpreter->getOpcodeID(increment->u.opcode) != op_pre_inc || increment[1].u.operand != counter)
+                    break;
+
+                // "i <= bound" lets the counter reach the bound, so the increment could overflow on an int32 bound.
+                if (opcodeID == op_loop_if_lesseq && (!isOperandConstantImmediateInt(bound) || getConstantOperandImmediateInt(bound) == std::numeric_limits<int32_t>::max()))
+                    break;
+                if (!isOperandConstantImmediateInt(bound) && (m_codeBlock->isConstantRegisterIndex(bound) || bound == counter))
+                    break;
+
+                bool boundIsRegister = !isOperandConstantImmediateInt(bound);
+                bool written = false;
+                for (unsigned index = loop.top; index < previous && !written; ) {
+                    Instruction* instruction = instructionsBegin + index;
+                    OpcodeID bodyOpcodeID = m_interpreter->getOpcodeID(instruction->u.opcode);
+                    int length = opcodeLengths[bodyOpcodeID];
+                    for (int operand = 1; operand < length; ++operand) {
+                        int value = instruction[operand].u.operand;
+                        if ((value == counter || (boundIsRegister && value == bound)) && !isReadOnlyOperand(bodyOpcodeID, operand))
+                            written = true;
+                    }
+                    index += length;
+                }
+                if (written)
+                    break;
+
+                loop.increment = previous;
+                loop.bound = bound;
+                m_countedLoops.append(loop);
+                break;
+            }
+        }
+
+        previous = bytecodeIndex;
+        bytecodeIndex += opcodeLengths[opcodeID];
+    }
+}
+
+const CountedLoop* JIT::countedLoopAt(unsigned bytecodeIndex)
+{
+    for (size_t i = 0; i < m_countedLoops.size(); ++i) {
+        const CountedLoop& loop = m_countedLoops[i];
+        if (loop.entry == bytecodeIndex || loop.increment == bytecodeIndex || loop.condition == bytecodeIndex)
+            return &loop;
+    }
+    return 0;
+}
+#endif
+
 #if USE(JSVALUE32_64)
 void JIT::emitTimeoutCheck()
 {
@@ -108,8 +367,16 @@ void JIT::emitTimeoutCheck()
 #else
 void JIT::emitTimeoutCheck()
 {
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    RegisterCacheState cachedRegisters = m_registerCache;
+#endif
     Jump skipTimeout = branchSub32(NonZero, Imm32(1), timeoutCheckRegister);
     JITStubCall(this, cti_timeout_check).call(timeoutCheckRegister);
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    // The check is rarely taken, so reload rather than lose the registers on the loop's hot path.
+    emitReloadCachedRegisters(cachedRegisters);
+    m_registerCache = cachedRegisters;
+#endif
     skipTimeout.link(this);
 
     killLastResultRegister();
@@ -183,6 +450,10 @@ void JIT::privateCompileMainPass()
     m_globalResolveInfoIndex = 0;
     m_callLinkInfoIndex = 0;
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    m_registerCacheAtBytecode.resize(instructionCount);
+#endif
+
     for (m_bytecodeIndex = 0; m_bytecodeIndex < instructionCount; ) {
         Instruction* currentInstruction = instructionsBegin + m_bytecodeIndex;
         ASSERT_WITH_MESSAGE(m_interpreter->isOpcode(currentInstruction->u.opcode), "privateCompileMainPass gone bad @ %d", m_bytecodeIndex);
@@ -197,6 +468,24 @@ void JIT::privateCompileMainPass()
             killLastResultRegister();
 #endif
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        // Blocks end at jumps and jump targets; everything is stored back before either, so that
+        // jumps can go anywhere with nothing in the cache registers.
+        bool atJumpTarget = false;
+        while (m_registerCacheJumpTargetsPosition < m_codeBlock->numberOfJumpTargets() && m_codeBlock->jumpTarget(m_registerCacheJumpTargetsPosition) <= m_bytecodeIndex) {
+            if (m_codeBlock->jumpTarget(m_registerCacheJumpTargetsPosition) == m_bytecodeIndex)
+                atJumpTarget = true;
+            ++m_registerCacheJumpTargetsPosition;
+        }
+        OpcodeID opcodeID = m_interpreter->getOpcodeID(currentInstruction->u.opcode);
+        m_registerCacheEnabled = opcodeKeepsCachedRegisters(opcodeID);
+        if (atJumpTarget || !m_registerCacheEnabled || opcodeEndsBlock(opcodeID))
+            emitFlushCachedRegisters();
+        if (atJumpTarget || !m_registerCacheEnabled)
+            killCachedRegisters();
+        m_registerCacheAtBytecode[m_bytecodeIndex] = m_registerCache;
+#endif
+
         m_labels[m_bytecodeIndex] = label();
 
         switch (m_interpreter->getOpcodeID(currentInstruction->u.opcode)) {
@@ -362,6 +651,13 @@ void JIT::privateCompileMainPass()
     ASSERT(m_propertyAccessInstructionIndex == m_codeBlock->numberOfStructureStubInfos());
     ASSERT(m_callLinkInfoIndex == m_codeBlock->numberOfCallLinkInfos());
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    // Slow cases only ever read and write the register file.
+    m_registerCacheEnabled = false;
+    emitFlushCachedRegisters();
+    killCachedRegisters();
+#endif
+
 #ifndef NDEBUG
     // Reset this, in order to guard its use with ASSERTs.
     m_bytecodeIndex = (unsigned)-1;
@@ -372,8 +668,12 @@ void JIT::privateCompileMainPass()
 void JIT::privateCompileLinkPass()
 {
     unsigned jmpTableCount = m_jmpTable.size();
-    for (unsigned i = 0; i < jmpTableCount; ++i)
+    for (unsigned i = 0; i < jmpTableCount; ++i) {
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        ASSERT(m_registerCacheAtBytecode[m_jmpTable[i].toBytecodeIndex].isEmpty());
+#endif
         m_jmpTable[i].from.linkTo(m_labels[m_jmpTable[i].toBytecodeIndex], this);
+    }
     m_jmpTable.clear();
 }
 
@@ -398,6 +698,19 @@ void JIT::privateCompileSlowCases()
 #ifndef NDEBUG
         unsigned firstTo = m_bytecodeIndex;
 #endif
+
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        // Store what the fast path had not stored yet when it took each slow case.
+        for (Vector<SlowCaseEntry>::iterator entry = iter; entry != m_slowCases.end() && entry->to == m_bytecodeIndex; ++entry) {
+            if (!entry->cachedRegisters.dirtyRegisters)
+                continue;
+            entry->from.link(this);
+            m_registerCache = entry->cachedRegisters;
+            emitFlushCachedRegisters();
+            killCachedRegisters();
+            entry->from = jump();
+        }
+#endif
         Instruction* currentInstruction = instructionsBegin + m_bytecodeIndex;
 
         switch (m_interpreter->getOpcodeID(currentInstruction->u.opcode)) {
@@ -421,6 +734,9 @@ void JIT::privateCompileSlowCases()
         DEFINE_SLOWCASE_OP(op_get_by_pname)
         DEFINE_SLOWCASE_OP(op_instanceof)
         DEFINE_SLOWCASE_OP(op_jfalse)
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+        DEFINE_SLOWCASE_OP(op_jmp)
+#endif
         DEFINE_SLOWCASE_OP(op_jnless)
         DEFINE_SLOWCASE_OP(op_jless)
         DEFINE_SLOWCASE_OP(op_jlesseq)
@@ -430,6 +746,9 @@ void JIT::privateCompileSlowCases()
         DEFINE_SLOWCASE_OP(op_loop_if_lesseq)
         DEFINE_SLOWCASE_OP(op_loop_if_true)
         DEFINE_SLOWCASE_OP(op_loop_if_false)
+#if !USE(JSVALUE32_64)
+        DEFINE_SLOWCASE_OP(op_load_varargs)
+#endif
         DEFINE_SLOWCASE_OP(op_lshift)
         DEFINE_SLOWCASE_OP(op_method_check)
         DEFINE_SLOWCASE_OP(op_mod)
@@ -485,6 +804,9 @@ void JIT::privateCompileSlowCases()
 
 JITCode JIT::privateCompile()
 {
+#if ENABLE(SAMPLING_COUNTERS)
+    GetByIdCounters::nameCounters();
+#endif
     sampleCodeBlock(m_codeBlock);
 #if ENABLE(OPCODE_SAMPLING)
     sampleInstruction(m_codeBlock->instructions().begin());
@@ -507,6 +829,9 @@ JITCode JIT::privateCompile()
         afterRegisterFileCheck = label();
     }
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    findCountedLoops();
+#endif
     privateCompileMainPass();
     privateCompileLinkPass();
     privateCompileSlowCases();
@@ -92,10 +92,60 @@ namespace JSC {
         }
     };
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    // Which virtual registers have their values in the cache registers at a point in the generated
+    // code, and which of those values have not been stored back to the register file yet.
+    struct RegisterCacheState {
+        static const unsigned numberOfRegisters = 4;
+
+        RegisterCacheState()
+        {
+            clear();
+        }
+
+        void clear()
+        {
+            for (unsigned i = 0; i < numberOfRegisters; ++i)
+                virtualRegisters[i] = std::numeric_limits<int>::max();
+            dirtyRegisters = 0;
+        }
+
+        bool isEmpty() const
+        {
+            for (unsigned i = 0; i < numberOfRegisters; ++i) {
+                if (virtualRegisters[i] != std::numeric_limits<int>::max())
+                    return false;
+            }
+            return true;
+        }
+
+        int virtualRegisters[numberOfRegisters];
+        unsigned dirtyRegisters;
+    };
+#endif
+
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    // A loop of the form "for (i = <int>; i < bound; ++i)" whose counter is written only by its
+    // increment, and whose bound is an int32 constant or a register the loop never writes. While
+    // the bound is an int32 the counter cannot leave the int32 range, so neither the increment nor
+    // the comparison needs to check it.
+    struct CountedLoop {
+        unsigned entry; // The op_jmp from the initializer to the condition.
+        unsigned top;
+        unsigned increment;
+        unsigned condition;
+        int counter;
+        int bound;
+    };
+#endif
+
     struct SlowCaseEntry {
         MacroAssembler::Jump from;
         unsigned to;
         unsigned hint;
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        RegisterCacheState cachedRegisters;
+#endif
         
         SlowCaseEntry(MacroAssembler::Jump f, unsigned t, unsigned h = 0)
             : from(f)
@@ -173,6 +223,22 @@ namespace JSC {
     void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, MacroAssemblerCodePtr newCalleeFunction);
     void ctiPatchCallByReturnAddress(CodeBlock* codeblock, ReturnAddressPtr returnAddress, FunctionPtr newCalleeFunction);
 
+#if ENABLE(SAMPLING_COUNTERS)
+    // Hits in each tier of the get_by_id caches. The monomorphic tier is patched
+    // into the hot path, so its hits are the fast path's less those of the stubs
+    // the hot path jumps to.
+    struct GetByIdCounters {
+        static void nameCounters();
+
+        static GlobalSamplingCounter fastPath;
+        static GlobalSamplingCounter selfListStub;
+        static GlobalSamplingCounter prototypeStub;
+        static GlobalSamplingCounter megamorphicCache;
+        static GlobalSamplingCounter megamorphicCacheMiss;
+        static GlobalSamplingCounter generic;
+    };
+#endif
+
     class JIT : private JSInterfaceJIT {
         friend class JITStubCall;
 
@@ -202,6 +268,11 @@ namespace JSC {
             JIT jit(globalData, codeBlock);
             jit.privateCompileGetByIdSelfList(stubInfo, polymorphicStructures, currentIndex, structure, ident, slot, cachedOffset);
         }
+        static void compileGetByIdMegamorphic(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, PolymorphicAccessStructureList* polymorphicStructures, int listSize, const Identifier& ident)
+        {
+            JIT jit(globalData, codeBlock);
+            jit.privateCompileGetByIdMegamorphic(stubInfo, polymorphicStructures, listSize, ident);
+        }
         static void compileGetByIdProtoList(JSGlobalData* globalData, CallFrame* callFrame, CodeBlock* codeBlock, StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructureList, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset)
         {
             JIT jit(globalData, codeBlock);
@@ -219,10 +290,12 @@ namespace JSC {
             jit.privateCompileGetByIdChain(stubInfo, structure, chain, count, ident, slot, cachedOffset, returnAddress, callFrame);
         }
         
-        static void compilePutByIdTransition(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct)
+        // A transition stub whose checks fail jumps to previousStub if it is set, and
+        // otherwise calls cti_op_put_by_id_fail.
+        static void compilePutByIdTransition(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct, CodeLocationLabel previousStub)
         {
             JIT jit(globalData, codeBlock);
-            jit.privateCompilePutByIdTransition(stubInfo, oldStructure, newStructure, cachedOffset, chain, returnAddress, direct);
+            jit.privateCompilePutByIdTransition(stubInfo, oldStructure, newStructure, cachedOffset, chain, returnAddress, direct, previousStub);
         }
 
         static void compileCTIMachineTrampolines(JSGlobalData* globalData, RefPtr<ExecutablePool>* executablePool, TrampolineStructure *trampolines)
@@ -268,10 +341,11 @@ namespace JSC {
         JITCode privateCompile();
         void privateCompileGetByIdProto(StructureStubInfo*, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
         void privateCompileGetByIdSelfList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, const Identifier&, const PropertySlot&, size_t cachedOffset);
+        void privateCompileGetByIdMegamorphic(StructureStubInfo*, PolymorphicAccessStructureList*, int listSize, const Identifier&);
         void privateCompileGetByIdProtoList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChainList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, StructureChain* chain, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChain(StructureStubInfo*, Structure*, StructureChain*, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
-        void privateCompilePutByIdTransition(StructureStubInfo*, Structure*, Structure*, size_t cachedOffset, StructureChain*, ReturnAddressPtr returnAddress, bool direct);
+        void privateCompilePutByIdTransition(StructureStubInfo*, Structure*, Structure*, size_t cachedOffset, StructureChain*, ReturnAddressPtr returnAddress, bool direct, CodeLocationLabel previousStub);
 
         void privateCompileCTIMachineTrampolines(RefPtr<ExecutablePool>* executablePool, JSGlobalData* data, TrampolineStructure *trampolines);
         void privateCompilePatchGetArrayLength(ReturnAddressPtr returnAddress);
@@ -288,6 +362,9 @@ namespace JSC {
         void compileOpCallVarargsSetupArgs(Instruction*);
         void compileOpCallSlowCase(Instruction* instruction, Vector<SlowCaseEntry>::iterator& iter, unsigned callLinkInfoIndex, OpcodeID opcodeID);
         void compileOpCallVarargsSlowCase(Instruction* instruction, Vector<SlowCaseEntry>::iterator& iter);
+#if !USE(JSVALUE32_64)
+        void emitCopyArguments(RegisterID source, int sourceOffset, int destinationOffset, RegisterID count);
+#endif
         void compileOpConstructSetupArgs(Instruction*);
 
         enum CompileOpStrictEqType { OpStrictEq, OpNStrictEq };
@@ -298,6 +375,7 @@ namespace JSC {
         void emitLoadInt32ToDouble(unsigned index, FPRegisterID value);
 
         void testPrototype(Structure*, JumpList& failureCases);
+        void emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2);
 
 #if USE(JSVALUE32_64)
         bool getOperandConstantImmediateInt(unsigned op1, unsigned op2, unsigned& op, int32_t& constant);
@@ -429,6 +507,26 @@ namespace JSC {
         
         void killLastResultRegister();
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        static RegisterID cacheRegisterAt(unsigned index);
+        static bool opcodeKeepsCachedRegisters(OpcodeID);
+        static bool opcodeEndsBlock(OpcodeID);
+        int findCachedRegister(int virtualRegister);
+        bool canCacheVirtualRegister(int virtualRegister);
+        void mapCachedRegister(int virtualRegister, RegisterID from, bool dirty);
+        void killCachedRegister(int virtualRegister);
+        void killCachedRegisters();
+        void emitFlushCachedRegisters();
+        void emitReloadCachedRegisters(const RegisterCacheState&);
+#endif
+
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+        void findCountedLoops();
+        const CountedLoop* countedLoopAt(unsigned bytecodeIndex);
+        void emitCountedLoopCondition(const CountedLoop&, Condition);
+        void emitSlowCountedLoopCondition(const CountedLoop&);
+#endif
+
         Jump emitJumpIfJSCell(RegisterID);
         Jump emitJumpIfBothJSCells(RegisterID, RegisterID, RegisterID);
         void emitJumpSlowCaseIfJSCell(RegisterID);
@@ -778,6 +876,9 @@ namespace JSC {
         void emitSlow_op_get_by_pname(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_instanceof(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_jfalse(Instruction*, Vector<SlowCaseEntry>::iterator&);
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+        void emitSlow_op_jmp(Instruction*, Vector<SlowCaseEntry>::iterator&);
+#endif
         void emitSlow_op_jnless(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_jless(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_jlesseq(Instruction*, Vector<SlowCaseEntry>::iterator&, bool invert = false);
@@ -787,6 +888,7 @@ namespace JSC {
         void emitSlow_op_loop_if_lesseq(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_loop_if_true(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_loop_if_false(Instruction*, Vector<SlowCaseEntry>::iterator&);
+        void emitSlow_op_load_varargs(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_lshift(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_method_check(Instruction*, Vector<SlowCaseEntry>::iterator&);
         void emitSlow_op_mod(Instruction*, Vector<SlowCaseEntry>::iterator&);
@@ -924,6 +1026,16 @@ namespace JSC {
         int m_lastResultBytecodeRegister;
         unsigned m_jumpTargetsPosition;
 #endif
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        RegisterCacheState m_registerCache;
+        Vector<RegisterCacheState> m_registerCacheAtBytecode;
+        bool m_registerCacheEnabled;
+        unsigned m_registerCacheVictim;
+        unsigned m_registerCacheJumpTargetsPosition;
+#endif
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+        Vector<CountedLoop> m_countedLoops;
+#endif
 
 #ifndef NDEBUG
 #if defined(ASSEMBLER_HAS_CONSTANT_POOL) && ASSEMBLER_HAS_CONSTANT_POOL
@@ -969,6 +1081,12 @@ namespace JSC {
     inline void JIT::emit_op_loop_if_less(Instruction* currentInstruction)
     {
         emitTimeoutCheck();
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+        if (const CountedLoop* loop = countedLoopAt(m_bytecodeIndex)) {
+            emitCountedLoopCondition(*loop, LessThan);
+            return;
+        }
+#endif
         emit_op_jless(currentInstruction);
     }
 
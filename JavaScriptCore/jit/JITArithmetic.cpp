@@ -570,6 +570,33 @@ void JIT::emit_op_jless(Instruction* currentInstruction)
     }
 }
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+void JIT::emitCountedLoopCondition(const CountedLoop& loop, Condition condition)
+{
+    emitGetVirtualRegister(loop.counter, regT0);
+    if (isOperandConstantImmediateInt(loop.bound))
+        addJump(branch32(condition, regT0, Imm32(getConstantOperandImmediateInt(loop.bound))), loop.top - m_bytecodeIndex);
+    else {
+        // The entry and the increment have both checked the bound.
+        emitGetVirtualRegister(loop.bound, regT1);
+        addJump(branch32(condition, regT0, regT1), loop.top - m_bytecodeIndex);
+    }
+}
+
+// Leaves a counted loop's fast path for good: the counter may now be any number, so the
+// condition is evaluated by the stub, and execution carries on at the top of the loop or after it.
+void JIT::emitSlowCountedLoopCondition(const CountedLoop& loop)
+{
+    ASSERT(!isOperandConstantImmediateInt(loop.bound));
+    JITStubCall stubCall(this, cti_op_jless);
+    stubCall.addArgument(loop.counter, regT0);
+    stubCall.addArgument(loop.bound, regT1);
+    stubCall.call();
+    emitJumpSlowToHot(branchTest32(NonZero, regT0), loop.top - m_bytecodeIndex);
+    emitJumpSlowToHot(jump(), loop.condition + OPCODE_LENGTH(op_loop_if_less) - m_bytecodeIndex);
+}
+#endif
+
 void JIT::emitSlow_op_jless(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
 {
     unsigned op1 = currentInstruction[1].u.operand;
@@ -1084,6 +1111,22 @@ void JIT::emit_op_pre_inc(Instruction* currentInstruction)
 {
     unsigned srcDst = currentInstruction[1].u.operand;
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    if (const CountedLoop* loop = countedLoopAt(m_bytecodeIndex)) {
+        // The condition has just seen the counter below the bound; if the bound is still an int32
+        // then so is the counter, and adding one cannot overflow.
+        emitGetVirtualRegister(srcDst, regT0);
+        if (!isOperandConstantImmediateInt(loop->bound)) {
+            emitGetVirtualRegister(loop->bound, regT1);
+            emitJumpSlowCaseIfNotImmediateInteger(regT1);
+        }
+        add32(Imm32(1), regT0);
+        emitFastArithIntToImmNoCheck(regT0, regT0);
+        emitPutVirtualRegister(srcDst);
+        return;
+    }
+#endif
+
     emitGetVirtualRegister(srcDst, regT0);
     emitJumpSlowCaseIfNotImmediateInteger(regT0);
 #if USE(JSVALUE64)
@@ -1100,6 +1143,19 @@ void JIT::emitSlow_op_pre_inc(Instruction* currentInstruction, Vector<SlowCaseEn
 {
     unsigned srcDst = currentInstruction[1].u.operand;
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    if (const CountedLoop* loop = countedLoopAt(m_bytecodeIndex)) {
+        // The bound has stopped being an int32, so the rest of the loop runs through the stubs.
+        linkSlowCase(iter);
+        JITStubCall stubCall(this, cti_op_pre_inc);
+        stubCall.addArgument(srcDst, regT0);
+        stubCall.call(srcDst);
+        emitTimeoutCheck();
+        emitSlowCountedLoopCondition(*loop);
+        return;
+    }
+#endif
+
     Jump notImm = getSlowCase(iter);
     linkSlowCase(iter);
     emitGetVirtualRegister(srcDst, regT0);
@@ -1244,8 +1300,14 @@ void JIT::emitSlow_op_mod(Instruction* currentInstruction, Vector<SlowCaseEntry>
 void JIT::compileBinaryArithOp(OpcodeID opcodeID, unsigned, unsigned op1, unsigned op2, OperandTypes)
 {
     emitGetVirtualRegisters(op1, regT0, op2, regT1);
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    // Doubles are handled here rather than in the slow case, which has to store and reload the cache registers.
+    Jump op1NotInt = emitJumpIfNotImmediateInteger(regT0);
+    Jump op2NotInt = emitJumpIfNotImmediateInteger(regT1);
+#else
     emitJumpSlowCaseIfNotImmediateInteger(regT0);
     emitJumpSlowCaseIfNotImmediateInteger(regT1);
+#endif
     if (opcodeID == op_add)
         addSlowCase(branchAdd32(Overflow, regT1, regT0));
     else if (opcodeID == op_sub)
@@ -1256,6 +1318,46 @@ void JIT::compileBinaryArithOp(OpcodeID opcodeID, unsigned, unsigned op1, unsign
         addSlowCase(branchTest32(Zero, regT0));
     }
     emitFastArithIntToImmNoCheck(regT0, regT0);
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    Jump done = jump();
+
+    // op1 is not an int32; regT0 and regT1 are left as they were for the slow case.
+    op1NotInt.link(this);
+    addSlowCase(emitJumpIfNotImmediateNumber(regT0));
+    move(regT0, regT2);
+    addPtr(tagTypeNumberRegister, regT2);
+    movePtrToDouble(regT2, fpRegT1);
+    Jump op2IsInt = emitJumpIfImmediateInteger(regT1);
+    addSlowCase(emitJumpIfNotImmediateNumber(regT1));
+    move(regT1, regT2);
+    addPtr(tagTypeNumberRegister, regT2);
+    movePtrToDouble(regT2, fpRegT2);
+    Jump op2WasDouble = jump();
+    op2IsInt.link(this);
+    convertInt32ToDouble(regT1, fpRegT2);
+    Jump op2WasInt = jump();
+
+    // op1 is an int32, op2 is not.
+    op2NotInt.link(this);
+    addSlowCase(emitJumpIfNotImmediateNumber(regT1));
+    convertInt32ToDouble(regT0, fpRegT1);
+    move(regT1, regT2);
+    addPtr(tagTypeNumberRegister, regT2);
+    movePtrToDouble(regT2, fpRegT2);
+
+    op2WasDouble.link(this);
+    op2WasInt.link(this);
+    if (opcodeID == op_add)
+        addDouble(fpRegT2, fpRegT1);
+    else if (opcodeID == op_sub)
+        subDouble(fpRegT2, fpRegT1);
+    else
+        mulDouble(fpRegT2, fpRegT1);
+    moveDoubleToPtr(fpRegT1, regT0);
+    subPtr(tagTypeNumberRegister, regT0);
+
+    done.link(this);
+#endif
 }
 
 void JIT::compileBinaryArithOpSlowCase(OpcodeID opcodeID, Vector<SlowCaseEntry>::iterator& iter, unsigned result, unsigned op1, unsigned op2, OperandTypes types, bool op1HasImmediateIntFastCase, bool op2HasImmediateIntFastCase)
@@ -1263,6 +1365,24 @@ void JIT::compileBinaryArithOpSlowCase(OpcodeID opcodeID, Vector<SlowCaseEntry>:
     // We assume that subtracting TagTypeNumber is equivalent to adding DoubleEncodeOffset.
     COMPILE_ASSERT(((JSImmediate::TagTypeNumber + JSImmediate::DoubleEncodeOffset) == 0), TagTypeNumber_PLUS_DoubleEncodeOffset_EQUALS_0);
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    if (!op1HasImmediateIntFastCase && !op2HasImmediateIntFastCase) {
+        // The fast path dealt with doubles; what is left is integer overflow and operands that are not numbers.
+        linkSlowCase(iter); // Integer overflow.
+        if (opcodeID == op_mul)
+            linkSlowCase(iter); // 0 * negative number.
+        emitGetVirtualRegister(op1, regT0);
+        linkSlowCase(iter); // op1 is not a number.
+        linkSlowCase(iter); // op1 is a double, op2 is not a number.
+        linkSlowCase(iter); // op1 is an int32, op2 is not a number.
+        JITStubCall stubCall(this, opcodeID == op_add ? cti_op_add : opcodeID == op_sub ? cti_op_sub : cti_op_mul);
+        stubCall.addArgument(regT0);
+        stubCall.addArgument(regT1);
+        stubCall.call(result);
+        return;
+    }
+#endif
+
     Jump notImm1;
     Jump notImm2;
     if (op1HasImmediateIntFastCase) {
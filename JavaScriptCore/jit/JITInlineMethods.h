@@ -115,8 +115,14 @@ ALWAYS_INLINE JIT::Call JIT::emitNakedCall(CodePtr function)
 {
     ASSERT(m_bytecodeIndex != (unsigned)-1); // This method should only be called during hot/cold path generation, so that m_bytecodeIndex is set.
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    emitFlushCachedRegisters();
+#endif
     Call nakedCall = nearCall();
     m_calls.append(CallRecord(nakedCall, m_bytecodeIndex, function.executableAddress()));
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    killCachedRegisters();
+#endif
     return nakedCall;
 }
 
@@ -235,6 +241,23 @@ ALWAYS_INLINE JIT::Jump JIT::checkStructure(RegisterID reg, Structure* structure
     return branchPtr(NotEqual, Address(reg, OBJECT_OFFSETOF(JSCell, m_structure)), ImmPtr(structure));
 }
 
+// Dirties the card holding the cell in 'owner' (see Heap::writeBarrier). Clobbers both
+// scratch registers; scratch2 may be 'owner' itself when the owner is not needed afterwards.
+ALWAYS_INLINE void JIT::emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2)
+{
+    if (!m_globalData->heap.isGenerationalCollectionEnabled())
+        return;
+
+    ASSERT(scratch1 != owner);
+    move(owner, scratch1);
+    andPtr(Imm32(static_cast<int32_t>(BLOCK_MASK)), scratch1);
+    move(owner, scratch2);
+    and32(Imm32(BLOCK_OFFSET_MASK & ~CARD_OFFSET_MASK), scratch2);
+    urshift32(Imm32(CARD_SHIFT - 2), scratch2); // The card index, scaled by sizeof(uint32_t).
+    addPtr(scratch2, scratch1);
+    store32(Imm32(1), Address(scratch1, OBJECT_OFFSETOF(CollectorBlock, cards)));
+}
+
 ALWAYS_INLINE void JIT::linkSlowCaseIfNotJSCell(Vector<SlowCaseEntry>::iterator& iter, int vReg)
 {
     if (!m_codeBlock->isKnownNotImmediate(vReg))
@@ -246,6 +269,9 @@ ALWAYS_INLINE void JIT::addSlowCase(Jump jump)
     ASSERT(m_bytecodeIndex != (unsigned)-1); // This method should only be called during hot/cold path generation, so that m_bytecodeIndex is set.
 
     m_slowCases.append(SlowCaseEntry(jump, m_bytecodeIndex));
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    m_slowCases.last().cachedRegisters = m_registerCache;
+#endif
 }
 
 ALWAYS_INLINE void JIT::addSlowCase(JumpList jumpList)
@@ -254,8 +280,12 @@ ALWAYS_INLINE void JIT::addSlowCase(JumpList jumpList)
 
     const JumpList::JumpVector& jumpVector = jumpList.jumps();
     size_t size = jumpVector.size();
-    for (size_t i = 0; i < size; ++i)
+    for (size_t i = 0; i < size; ++i) {
         m_slowCases.append(SlowCaseEntry(jumpVector[i], m_bytecodeIndex));
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        m_slowCases.last().cachedRegisters = m_registerCache;
+#endif
+    }
 }
 
 ALWAYS_INLINE void JIT::addJump(Jump jump, int relativeOffset)
@@ -269,6 +299,14 @@ ALWAYS_INLINE void JIT::emitJumpSlowToHot(Jump jump, int relativeOffset)
 {
     ASSERT(m_bytecodeIndex != (unsigned)-1); // This method should only be called during hot/cold path generation, so that m_bytecodeIndex is set.
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    const RegisterCacheState& state = m_registerCacheAtBytecode[m_bytecodeIndex + relativeOffset];
+    if (!state.isEmpty()) {
+        jump.link(this);
+        emitReloadCachedRegisters(state);
+        jump = this->jump();
+    }
+#endif
     jump.linkTo(m_labels[m_bytecodeIndex + relativeOffset], this);
 }
 
@@ -637,6 +675,87 @@ ALWAYS_INLINE void JIT::killLastResultRegister()
     m_lastResultBytecodeRegister = std::numeric_limits<int>::max();
 }
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+
+// None of these are touched by the JIT outside of calls, and all are caller saved.
+ALWAYS_INLINE JIT::RegisterID JIT::cacheRegisterAt(unsigned index)
+{
+    static const RegisterID cacheRegisters[RegisterCacheState::numberOfRegisters] = { X86Registers::r8, X86Registers::r9, X86Registers::r10, X86Registers::esi };
+    return cacheRegisters[index];
+}
+
+ALWAYS_INLINE int JIT::findCachedRegister(int virtualRegister)
+{
+    for (unsigned i = 0; i < RegisterCacheState::numberOfRegisters; ++i) {
+        if (m_registerCache.virtualRegisters[i] == virtualRegister)
+            return i;
+    }
+    return -1;
+}
+
+// In global code the global variables are registers below the call frame, which op_get_global_var
+// reads through the global object; keep those in the register file only.
+ALWAYS_INLINE bool JIT::canCacheVirtualRegister(int virtualRegister)
+{
+    return virtualRegister >= 0 || m_codeBlock->codeType() != GlobalCode;
+}
+
+ALWAYS_INLINE void JIT::mapCachedRegister(int virtualRegister, RegisterID from, bool dirty)
+{
+    int index = findCachedRegister(virtualRegister);
+    if (index < 0)
+        index = findCachedRegister(std::numeric_limits<int>::max());
+    if (index < 0) {
+        index = m_registerCacheVictim;
+        m_registerCacheVictim = (m_registerCacheVictim + 1) % RegisterCacheState::numberOfRegisters;
+        if (m_registerCache.dirtyRegisters & (1u << index))
+            storePtr(cacheRegisterAt(index), Address(callFrameRegister, m_registerCache.virtualRegisters[index] * sizeof(Register)));
+    }
+    move(from, cacheRegisterAt(index));
+    m_registerCache.virtualRegisters[index] = virtualRegister;
+    if (dirty)
+        m_registerCache.dirtyRegisters |= 1u << index;
+    else
+        m_registerCache.dirtyRegisters &= ~(1u << index);
+}
+
+// Forgets a virtual register that has just been written to the register file directly.
+ALWAYS_INLINE void JIT::killCachedRegister(int virtualRegister)
+{
+    int index = findCachedRegister(virtualRegister);
+    if (index >= 0) {
+        m_registerCache.virtualRegisters[index] = std::numeric_limits<int>::max();
+        m_registerCache.dirtyRegisters &= ~(1u << index);
+    }
+}
+
+ALWAYS_INLINE void JIT::killCachedRegisters()
+{
+    ASSERT(!m_registerCache.dirtyRegisters);
+    m_registerCache.clear();
+}
+
+ALWAYS_INLINE void JIT::emitFlushCachedRegisters()
+{
+    for (unsigned i = 0; i < RegisterCacheState::numberOfRegisters; ++i) {
+        if (m_registerCache.dirtyRegisters & (1u << i))
+            storePtr(cacheRegisterAt(i), Address(callFrameRegister, m_registerCache.virtualRegisters[i] * sizeof(Register)));
+    }
+    m_registerCache.dirtyRegisters = 0;
+}
+
+// Gives the cache registers the values that the code at some point expects, for code that gets
+// there after a call or from a slow case, when the register file is up to date.
+ALWAYS_INLINE void JIT::emitReloadCachedRegisters(const RegisterCacheState& state)
+{
+    for (unsigned i = 0; i < RegisterCacheState::numberOfRegisters; ++i) {
+        if (state.virtualRegisters[i] != std::numeric_limits<int>::max())
+            loadPtr(Address(callFrameRegister, state.virtualRegisters[i] * sizeof(Register)), cacheRegisterAt(i));
+    }
+}
+
+#endif // ENABLE(JIT_REGISTER_ALLOCATION)
+
 // get arg puts an arg from the SF register array into a h/w register
 ALWAYS_INLINE void JIT::emitGetVirtualRegister(int src, RegisterID dst)
 {
@@ -667,6 +786,20 @@ ALWAYS_INLINE void JIT::emitGetVirtualRegister(int src, RegisterID dst)
         }
     }
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    if (m_registerCacheEnabled && canCacheVirtualRegister(src)) {
+        int index = findCachedRegister(src);
+        if (index >= 0)
+            move(cacheRegisterAt(index), dst);
+        else {
+            loadPtr(Address(callFrameRegister, src * sizeof(Register)), dst);
+            mapCachedRegister(src, dst, false);
+        }
+        killLastResultRegister();
+        return;
+    }
+#endif
+
     loadPtr(Address(callFrameRegister, src * sizeof(Register)), dst);
     killLastResultRegister();
 }
@@ -694,6 +827,15 @@ ALWAYS_INLINE bool JIT::isOperandConstantImmediateInt(unsigned src)
 
 ALWAYS_INLINE void JIT::emitPutVirtualRegister(unsigned dst, RegisterID from)
 {
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+    // The store is left until the end of the block, a call, or a slow case.
+    if (m_registerCacheEnabled && canCacheVirtualRegister(dst)) {
+        mapCachedRegister(dst, from, true);
+        m_lastResultBytecodeRegister = (from == cachedResultRegister) ? dst : std::numeric_limits<int>::max();
+        return;
+    }
+    killCachedRegister(dst);
+#endif
     storePtr(from, Address(callFrameRegister, dst * sizeof(Register)));
     m_lastResultBytecodeRegister = (from == cachedResultRegister) ? dst : std::numeric_limits<int>::max();
 }
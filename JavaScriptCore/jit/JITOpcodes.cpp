@@ -29,6 +29,7 @@
 
 #if ENABLE(JIT)
 
+#include "Arguments.h"
 #include "JITInlineMethods.h"
 #include "JITStubCall.h"
 #include "JSArray.h"
@@ -492,6 +493,9 @@ void JIT::emit_op_mov(Instruction* currentInstruction)
         storePtr(ImmPtr(JSValue::encode(getConstantOperand(src))), Address(callFrameRegister, dst * sizeof(Register)));
         if (dst == m_lastResultBytecodeRegister)
             killLastResultRegister();
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        killCachedRegister(dst);
+#endif
     } else if ((src == m_lastResultBytecodeRegister) || (dst == m_lastResultBytecodeRegister)) {
         // If either the src or dst is the cached register go though
         // get/put registers to make sure we track this correctly.
@@ -499,8 +503,15 @@ void JIT::emit_op_mov(Instruction* currentInstruction)
         emitPutVirtualRegister(dst);
     } else {
         // Perform the copy via regT1; do not disturb any mapping in regT0.
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+        int lastResultBytecodeRegister = m_lastResultBytecodeRegister;
+        emitGetVirtualRegister(src, regT1);
+        emitPutVirtualRegister(dst, regT1);
+        m_lastResultBytecodeRegister = lastResultBytecodeRegister;
+#else
         loadPtr(Address(callFrameRegister, src * sizeof(Register)), regT1);
         storePtr(regT1, Address(callFrameRegister, dst * sizeof(Register)));
+#endif
     }
 }
 
@@ -517,14 +528,37 @@ void JIT::emit_op_end(Instruction* currentInstruction)
 void JIT::emit_op_jmp(Instruction* currentInstruction)
 {
     unsigned target = currentInstruction[1].u.operand;
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    // A counted loop's condition and increment rely on its bound being an int32.
+    const CountedLoop* loop = countedLoopAt(m_bytecodeIndex);
+    if (loop && !isOperandConstantImmediateInt(loop->bound)) {
+        emitGetVirtualRegister(loop->bound, regT0);
+        emitJumpSlowCaseIfNotImmediateInteger(regT0);
+    }
+#endif
     addJump(jump(), target);
     RECORD_JUMP_TARGET(target);
 }
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+void JIT::emitSlow_op_jmp(Instruction*, Vector<SlowCaseEntry>::iterator& iter)
+{
+    linkSlowCase(iter);
+    emitSlowCountedLoopCondition(*countedLoopAt(m_bytecodeIndex));
+}
+#endif
+
 void JIT::emit_op_loop_if_lesseq(Instruction* currentInstruction)
 {
     emitTimeoutCheck();
 
+#if ENABLE(JIT_OPTIMIZE_LOOP_COUNTERS)
+    if (const CountedLoop* loop = countedLoopAt(m_bytecodeIndex)) {
+        emitCountedLoopCondition(*loop, LessThanOrEqual);
+        return;
+    }
+#endif
+
     unsigned op1 = currentInstruction[1].u.operand;
     unsigned op2 = currentInstruction[2].u.operand;
     unsigned target = currentInstruction[3].u.operand;
@@ -614,7 +648,70 @@ void JIT::emit_op_load_varargs(Instruction* currentInstruction)
 {
     int argCountDst = currentInstruction[1].u.operand;
     int argsOffset = currentInstruction[2].u.operand;
+    int expectedParams = m_codeBlock->m_numParameters - 1;
+
+    // The common case is "f.apply(x, arguments)" where nothing has created the arguments object
+    // yet; the arguments register is then empty, and this function's own arguments are copied
+    // straight into the new call frame, as cti_op_load_varargs would do.
+    addSlowCase(branchTestPtr(NonZero, Address(callFrameRegister, argsOffset * sizeof(Register))));
+
+    emitGetFromCallFrameHeader32(RegisterFile::ArgumentCount, regT0);
+    sub32(Imm32(1), regT0);
+    addSlowCase(branch32(Above, regT0, Imm32(Arguments::MaxArguments)));
+
+    // Leave growing the register file to the stub.
+    mul32(Imm32(sizeof(Register)), regT0, regT1);
+    addPtr(callFrameRegister, regT1);
+    addPtr(Imm32((argsOffset + RegisterFile::CallFrameHeaderSize) * sizeof(Register)), regT1);
+    peek(regT2, OBJECT_OFFSETOF(JITStackFrame, registerFile) / sizeof (void*));
+    addSlowCase(branchPtr(AboveOrEqual, regT1, Address(regT2, OBJECT_OFFSETOF(RegisterFile, m_end))));
+
+    // Stores a naked int32 in the register file.
+    move(regT0, regT1);
+    add32(Imm32(1), regT1);
+    store32(regT1, Address(callFrameRegister, argCountDst * sizeof(Register)));
+
+    // Arguments up to the number of parameters are where the parameters are.
+    Jump hasExtraArguments = branch32(Above, regT0, Imm32(expectedParams));
+    emitCopyArguments(callFrameRegister, -(RegisterFile::CallFrameHeaderSize + expectedParams) * static_cast<int>(sizeof(Register)), argsOffset * sizeof(Register), regT0);
+    Jump done = jump();
+
+    // Any more were left behind by the arity check, further down the register file.
+    hasExtraArguments.link(this);
+    mul32(Imm32(sizeof(Register)), regT0, regT1);
+    move(callFrameRegister, regT2);
+    subPtr(regT1, regT2);
+    sub32(Imm32(expectedParams), regT0);
+    emitCopyArguments(regT2, -(RegisterFile::CallFrameHeaderSize + 1) * static_cast<int>(sizeof(Register)), (argsOffset + expectedParams) * sizeof(Register), regT0);
+    move(Imm32(expectedParams), regT0);
+    emitCopyArguments(callFrameRegister, -(RegisterFile::CallFrameHeaderSize + expectedParams) * static_cast<int>(sizeof(Register)), argsOffset * sizeof(Register), regT0);
+
+    done.link(this);
+    killLastResultRegister();
+}
 
+// Copies count registers from source + sourceOffset to the call frame at destinationOffset.
+// Clobbers regT1 and regT3.
+void JIT::emitCopyArguments(RegisterID source, int sourceOffset, int destinationOffset, RegisterID count)
+{
+    move(Imm32(0), regT1);
+    Jump empty = branchTest32(Zero, count);
+    Label loop = label();
+    loadPtr(BaseIndex(source, regT1, ScalePtr, sourceOffset), regT3);
+    storePtr(regT3, BaseIndex(callFrameRegister, regT1, ScalePtr, destinationOffset));
+    add32(Imm32(1), regT1);
+    branch32(NotEqual, regT1, count).linkTo(loop, this);
+    empty.link(this);
+}
+
+void JIT::emitSlow_op_load_varargs(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
+{
+    int argCountDst = currentInstruction[1].u.operand;
+    int argsOffset = currentInstruction[2].u.operand;
+
+    linkSlowCase(iter);
+    linkSlowCase(iter);
+    linkSlowCase(iter);
     JITStubCall stubCall(this, cti_op_load_varargs);
     stubCall.addArgument(Imm32(argsOffset));
     stubCall.call();
@@ -671,14 +768,32 @@ void JIT::emit_op_put_scoped_var(Instruction* currentInstruction)
         loadPtr(Address(regT1, OBJECT_OFFSETOF(ScopeChainNode, next)), regT1);
 
     loadPtr(Address(regT1, OBJECT_OFFSETOF(ScopeChainNode, object)), regT1);
+    emitWriteBarrier(regT1, regT2, regT3);
     emitPutVariableObjectRegister(regT0, regT1, currentInstruction[1].u.operand);
 }
 
 void JIT::emit_op_tear_off_activation(Instruction* currentInstruction)
 {
+    // The activation allocated storage for our locals when it was created, so unless an 'arguments'
+    // object needs pointing at the copy too, tearing off is an inline copy of a layout known now.
+    Jump hasArguments = branchTestPtr(NonZero, Address(callFrameRegister, RegisterFile::OptionalCalleeArguments * static_cast<int>(sizeof(Register))));
+
+    emitGetVirtualRegister(currentInstruction[1].u.operand, regT0);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(JSVariableObject, d)), regT0);
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(JSActivation::JSActivationData, tornOffRegisters)), regT1);
+    int registerOffset = JSActivation::JSActivationData::registerOffset(*m_codeBlock);
+    for (int i = -registerOffset; i < m_codeBlock->m_numVars; ++i) {
+        loadPtr(Address(callFrameRegister, i * static_cast<int>(sizeof(Register))), regT2);
+        storePtr(regT2, Address(regT1, i * static_cast<int>(sizeof(Register))));
+    }
+    storePtr(regT1, Address(regT0, OBJECT_OFFSETOF(JSVariableObject::JSVariableObjectData, registers)));
+    Jump done = jump();
+
+    hasArguments.link(this);
     JITStubCall stubCall(this, cti_op_tear_off_activation);
     stubCall.addArgument(currentInstruction[1].u.operand, regT2);
     stubCall.call();
+    done.link(this);
 }
 
 void JIT::emit_op_tear_off_arguments(Instruction*)
@@ -688,9 +803,16 @@ void JIT::emit_op_tear_off_arguments(Instruction*)
 
 void JIT::emit_op_ret(Instruction* currentInstruction)
 {
-    // We could JIT generate the deref, only calling out to C when the refcount hits zero.
-    if (m_codeBlock->needsFullScopeChain())
+    // Deref the scope chain inline, only calling out to C when the refcount hits zero.
+    if (m_codeBlock->needsFullScopeChain()) {
+        emitGetFromCallFrameHeaderPtr(RegisterFile::ScopeChain, regT0);
+        Jump lastReference = branch32(Equal, Address(regT0, OBJECT_OFFSETOF(ScopeChainNode, refCount)), Imm32(1));
+        sub32(Imm32(1), Address(regT0, OBJECT_OFFSETOF(ScopeChainNode, refCount)));
+        Jump derefed = jump();
+        lastReference.link(this);
         JITStubCall(this, cti_op_ret_scopeChain).call();
+        derefed.link(this);
+    }
 
     ASSERT(callFrameRegister != regT1);
     ASSERT(regT1 != returnValueRegister);
@@ -1332,6 +1454,14 @@ void JIT::emit_op_enter(Instruction*)
     for (size_t j = 0; j < count; ++j)
         emitInitRegister(j);
 
+#if ENABLE(CODE_FLUSHING)
+    store32(Imm32(0), &m_codeBlock->m_collectionsSinceLastCall);
+#endif
+
+#if ENABLE(SAMPLING_PROFILER)
+    // Calls count as ticks too, so code that recurses rather than loops gets sampled.
+    emitTimeoutCheck();
+#endif
 }
 
 void JIT::emit_op_enter_with_activation(Instruction* currentInstruction)
@@ -1343,7 +1473,15 @@ void JIT::emit_op_enter_with_activation(Instruction* currentInstruction)
     for (size_t j = 0; j < count; ++j)
         emitInitRegister(j);
 
+#if ENABLE(CODE_FLUSHING)
+    store32(Imm32(0), &m_codeBlock->m_collectionsSinceLastCall);
+#endif
+
     JITStubCall(this, cti_op_push_activation).call(currentInstruction[1].u.operand);
+
+#if ENABLE(SAMPLING_PROFILER)
+    emitTimeoutCheck();
+#endif
 }
 
 void JIT::emit_op_create_arguments(Instruction*)
@@ -1548,6 +1686,9 @@ void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCaseIfNotJSCell(iter, base); // base cell check
     linkSlowCase(iter); // base not array check
     linkSlowCase(iter); // in vector check
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    linkSlowCase(iter); // non-number stored in a number vector
+#endif
 
     JITStubCall stubPutByValCall(this, cti_op_put_by_val);
     stubPutByValCall.addArgument(regT0);
@@ -623,10 +623,12 @@ void JIT::emit_op_put_scoped_var(Instruction* currentInstruction)
         loadPtr(Address(regT2, OBJECT_OFFSETOF(ScopeChainNode, next)), regT2);
 
     loadPtr(Address(regT2, OBJECT_OFFSETOF(ScopeChainNode, object)), regT2);
+    move(regT2, regT3);
     loadPtr(Address(regT2, OBJECT_OFFSETOF(JSVariableObject, d)), regT2);
     loadPtr(Address(regT2, OBJECT_OFFSETOF(JSVariableObject::JSVariableObjectData, registers)), regT2);
 
     emitStore(index, regT1, regT0, regT2);
+    emitWriteBarrier(regT3, regT2, regT3);
     map(m_bytecodeIndex + OPCODE_LENGTH(op_put_scoped_var), value, regT1, regT0);
 }
 
@@ -1448,13 +1450,31 @@ void JIT::emit_op_enter(Instruction*)
     // object lifetime and increasing GC pressure.
     for (int i = 0; i < m_codeBlock->m_numVars; ++i)
         emitStore(i, jsUndefined());
+
+#if ENABLE(CODE_FLUSHING)
+    store32(Imm32(0), &m_codeBlock->m_collectionsSinceLastCall);
+#endif
+
+#if ENABLE(SAMPLING_PROFILER)
+    // Calls count as ticks too, so code that recurses rather than loops gets sampled.
+    emitTimeoutCheck();
+#endif
 }
 
 void JIT::emit_op_enter_with_activation(Instruction* currentInstruction)
 {
-    emit_op_enter(currentInstruction);
+    for (int i = 0; i < m_codeBlock->m_numVars; ++i)
+        emitStore(i, jsUndefined());
+
+#if ENABLE(CODE_FLUSHING)
+    store32(Imm32(0), &m_codeBlock->m_collectionsSinceLastCall);
+#endif
 
     JITStubCall(this, cti_op_push_activation).call(currentInstruction[1].u.operand);
+
+#if ENABLE(SAMPLING_PROFILER)
+    emitTimeoutCheck();
+#endif
 }
 
 void JIT::emit_op_create_arguments(Instruction*)
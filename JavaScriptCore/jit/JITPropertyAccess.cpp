@@ -216,6 +216,16 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
     addSlowCase(branch32(AboveOrEqual, regT1, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength))));
 
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    // Numbers need no write barrier; anything else stored into a number vector takes the slow case to change its mode.
+    emitGetVirtualRegister(value, regT3);
+    Jump isNumber = emitJumpIfImmediateNumber(regT3);
+    addSlowCase(branch32(Equal, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorMode)), Imm32(JSArray::NumberVector)));
+    emitWriteBarrier(regT0, regT2, regT3);
+    isNumber.link(this);
+#else
+    emitWriteBarrier(regT0, regT2, regT3);
+#endif
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT2);
 
     Jump empty = branchTestPtr(Zero, BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
@@ -415,6 +425,9 @@ void JIT::emit_op_get_by_id(Instruction* currentInstruction)
 
     emitGetVirtualRegister(baseVReg, regT0);
     compileGetByIdHotPath(resultVReg, baseVReg, ident, m_propertyAccessInstructionIndex++);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::fastPath);
+#endif
     emitPutVirtualRegister(resultVReg);
 }
 
@@ -510,6 +523,9 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     // Jump to a slow case if either the base object is an immediate, or if the Structure does not match.
     emitJumpSlowCaseIfNotJSCell(regT0, baseVReg);
 
+    // The barrier goes ahead of the patchable sequence, which overwrites the base register.
+    emitWriteBarrier(regT0, regT2, regT3);
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -600,7 +616,7 @@ void JIT::testPrototype(Structure* structure, JumpList& failureCases)
     failureCases.append(branchPtr(NotEqual, Address(regT2), regT3));
 }
 
-void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct)
+void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct, CodeLocationLabel previousStub)
 {
     JumpList failureCases;
     // Check eax is an object of the right Structure.
@@ -619,6 +635,26 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     // emit a call only if storage realloc is needed
     bool willNeedStorageRealloc = oldStructure->propertyStorageCapacity() != newStructure->propertyStorageCapacity();
     if (willNeedStorageRealloc) {
+        JumpList storageReallocated;
+        if (oldStructure->propertyStorageCapacity() == JSObject::inlineStorageCapacity) {
+            // Move the object off its inline storage into storage the heap has kept, if there is any.
+            ASSERT(newStructure->propertyStorageCapacity() == JSObject::nonInlineBaseStorageCapacity);
+            move(ImmPtr(m_globalData->heap.addressOfFreePropertyStorageCount()), regT2);
+            load32(Address(regT2), regT3);
+            Jump noFreeStorage = branchTest32(Zero, regT3);
+            sub32(Imm32(1), regT3);
+            store32(regT3, Address(regT2));
+            move(ImmPtr(m_globalData->heap.freePropertyStorage()), regT2);
+            loadPtr(BaseIndex(regT2, regT3, ScalePtr), regT2);
+            for (unsigned i = 0; i < JSObject::inlineStorageCapacity; ++i) {
+                loadPtr(Address(regT0, OBJECT_OFFSETOF(JSObject, m_inlineStorage) + i * sizeof(JSValue)), regT3);
+                storePtr(regT3, Address(regT2, i * sizeof(JSValue)));
+            }
+            storePtr(regT2, Address(regT0, OBJECT_OFFSETOF(JSObject, m_externalStorage)));
+            storageReallocated.append(jump());
+            noFreeStorage.link(this);
+        }
+
         // This trampoline was called to like a JIT stub; before we can can call again we need to
         // remove the return address from the stack, to prevent the stack from becoming misaligned.
         preserveReturnAddressAfterCall(regT3);
@@ -633,6 +669,7 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
         emitGetJITStubArg(2, regT1);
 
         restoreReturnAddressBeforeReturn(regT3);
+        storageReallocated.link(this);
     }
 
     // Assumes m_refCount can be decremented easily, refcount decrement is safe as 
@@ -640,6 +677,7 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
     add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)));
+    emitWriteBarrier(regT0, regT2, regT3);
 
     // write the value
     compilePutDirectOffset(regT0, regT1, newStructure, cachedOffset);
@@ -647,13 +685,19 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     ret();
     
     ASSERT(!failureCases.empty());
-    failureCases.link(this);
-    restoreArgumentReferenceForTrampoline();
-    Call failureCall = tailRecursiveCall();
+    Call failureCall;
+    if (!previousStub) {
+        failureCases.link(this);
+        restoreArgumentReferenceForTrampoline();
+        failureCall = tailRecursiveCall();
+    }
 
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
 
-    patchBuffer.link(failureCall, FunctionPtr(direct ? cti_op_put_by_id_direct_fail : cti_op_put_by_id_fail));
+    if (!previousStub)
+        patchBuffer.link(failureCall, FunctionPtr(direct ? cti_op_put_by_id_direct_fail : cti_op_put_by_id_fail));
+    else
+        patchBuffer.link(failureCases, previousStub);
 
     if (willNeedStorageRealloc) {
         ASSERT(m_calls.size() == 1);
@@ -804,6 +848,9 @@ void JIT::privateCompileGetByIdProto(StructureStubInfo* stubInfo, Structure* str
         stubCall.call();
     } else
         compileGetDirectOffset(protoObject, regT1, regT0, cachedOffset);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
 
@@ -860,6 +907,9 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
         stubCall.call();
     } else
         compileGetDirectOffset(regT0, regT0, structure, cachedOffset);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::selfListStub);
+#endif
     Jump success = jump();
 
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -892,6 +942,47 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     repatchBuffer.relink(jumpLocation, entryLabel);
 }
 
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* polymorphicStructures, int listSize, const Identifier& ident)
+{
+    // regT0 holds a JSCell*. Look up its Structure and the property name in the
+    // global cache, and load the property from the offset recorded there.
+    UString::Rep* name = ident.ustring().rep();
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)), regT1);
+    move(regT1, regT2);
+    mul32(Imm32(static_cast<int32_t>(MegamorphicCache::structureHashMultiplier)), regT2, regT2);
+    urshift32(Imm32(MegamorphicCache::structureHashShift), regT2);
+    xor32(Imm32(MegamorphicCache::nameHash(name)), regT2);
+    mul32(Imm32(sizeof(MegamorphicCache::Entry)), regT2, regT2);
+    addPtr(ImmPtr(m_globalData->megamorphicCache.entries()), regT2);
+    Jump structureMiss = branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT1);
+    Jump nameMiss = branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, name)), ImmPtr(name));
+    loadPtr(Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    compileGetDirectOffset(regT0, regT0, regT1, regT3, regT2);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::megamorphicCache);
+#endif
+    Jump success = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    // A miss tries the Structures in the full self list, and then the slow case, which
+    // calls cti_op_get_by_id_megamorphic to fill the entry in.
+    CodeLocationLabel lastListStub = polymorphicStructures->list[listSize - 1].stubRoutine;
+    ASSERT(lastListStub);
+    patchBuffer.link(structureMiss, lastListStub);
+    patchBuffer.link(nameMiss, lastListStub);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    // Finally patch the jump to slow case back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+}
+
 void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructures, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset, CallFrame* callFrame)
 {
     // The prototype object definitely exists (if this stub exists the CodeBlock is referencing a Structure that is
@@ -931,6 +1022,9 @@ void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, Polymorphi
     } else
         compileGetDirectOffset(protoObject, regT1, regT0, cachedOffset);
 
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
 
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -1008,6 +1102,9 @@ void JIT::privateCompileGetByIdChainList(StructureStubInfo* stubInfo, Polymorphi
         stubCall.call();
     } else
         compileGetDirectOffset(protoObject, regT1, regT0, cachedOffset);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
 
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -1086,6 +1183,9 @@ void JIT::privateCompileGetByIdChain(StructureStubInfo* stubInfo, Structure* str
         stubCall.call();
     } else
         compileGetDirectOffset(protoObject, regT1, regT0, cachedOffset);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
 
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -366,6 +366,18 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     addSlowCase(branchPtr(NotEqual, Address(regT0), ImmPtr(m_globalData->jsArrayVPtr)));
     addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorLength))));
     
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    // Numbers need no write barrier; anything else stored into a number vector takes the slow case to change its mode.
+    emitLoadTag(value, regT1);
+    JumpList isNumber;
+    isNumber.append(branch32(Equal, regT1, Imm32(JSValue::Int32Tag)));
+    isNumber.append(branch32(Below, regT1, Imm32(JSValue::LowestTag)));
+    addSlowCase(branch32(Equal, Address(regT0, OBJECT_OFFSETOF(JSArray, m_vectorMode)), Imm32(JSArray::NumberVector)));
+    emitWriteBarrier(regT0, regT1, regT3);
+    isNumber.link(this);
+#else
+    emitWriteBarrier(regT0, regT1, regT3);
+#endif
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT3);
     
     Jump empty = branch32(Equal, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + 4), Imm32(JSValue::EmptyValueTag));
@@ -397,6 +409,9 @@ void JIT::emitSlow_op_put_by_val(Instruction* currentInstruction, Vector<SlowCas
     linkSlowCaseIfNotJSCell(iter, base); // base cell check
     linkSlowCase(iter); // base not array check
     linkSlowCase(iter); // in vector check
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    linkSlowCase(iter); // non-number stored in a number vector
+#endif
     
     JITStubCall stubPutByValCall(this, cti_op_put_by_val);
     stubPutByValCall.addArgument(base);
@@ -413,6 +428,9 @@ void JIT::emit_op_get_by_id(Instruction* currentInstruction)
     emitLoad(base, regT1, regT0);
     emitJumpSlowCaseIfNotJSCell(base, regT1);
     compileGetByIdHotPath();
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::fastPath);
+#endif
     emitStore(dst, regT1, regT0);
     map(m_bytecodeIndex + OPCODE_LENGTH(op_get_by_id), dst, regT1, regT0);
 }
@@ -527,6 +545,13 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     
     ASSERT(differenceBetween(hotPathBegin, displacementLabel1) == patchOffsetPutByIdPropertyMapOffset1);
     ASSERT(differenceBetween(hotPathBegin, displacementLabel2) == patchOffsetPutByIdPropertyMapOffset2);
+
+    // Every register is live ahead of the patchable sequence, and it overwrites the
+    // base, so reload the base for the barrier.
+    if (m_globalData->heap.isGenerationalCollectionEnabled()) {
+        emitLoadPayload(base, regT0);
+        emitWriteBarrier(regT0, regT2, regT3);
+    }
 }
 
 void JIT::emitSlow_op_put_by_id(Instruction* currentInstruction, Vector<SlowCaseEntry>::iterator& iter)
@@ -595,7 +620,7 @@ void JIT::testPrototype(Structure* structure, JumpList& failureCases)
     failureCases.append(branchPtr(NotEqual, AbsoluteAddress(&asCell(structure->m_prototype)->m_structure), ImmPtr(asCell(structure->m_prototype)->m_structure)));
 }
 
-void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct)
+void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure* oldStructure, Structure* newStructure, size_t cachedOffset, StructureChain* chain, ReturnAddressPtr returnAddress, bool direct, CodeLocationLabel previousStub)
 {
     // It is assumed that regT0 contains the basePayload and regT1 contains the baseTag.  The value can be found on the stack.
     
@@ -614,6 +639,26 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     Call callTarget;
     bool willNeedStorageRealloc = oldStructure->propertyStorageCapacity() != newStructure->propertyStorageCapacity();
     if (willNeedStorageRealloc) {
+        JumpList storageReallocated;
+        if (oldStructure->propertyStorageCapacity() == JSObject::inlineStorageCapacity) {
+            // Move the object off its inline storage into storage the heap has kept, if there is any.
+            ASSERT(newStructure->propertyStorageCapacity() == JSObject::nonInlineBaseStorageCapacity);
+            move(ImmPtr(m_globalData->heap.addressOfFreePropertyStorageCount()), regT2);
+            load32(Address(regT2), regT3);
+            Jump noFreeStorage = branchTest32(Zero, regT3);
+            sub32(Imm32(1), regT3);
+            store32(regT3, Address(regT2));
+            move(ImmPtr(m_globalData->heap.freePropertyStorage()), regT2);
+            loadPtr(BaseIndex(regT2, regT3, ScalePtr), regT2);
+            for (unsigned i = 0; i < JSObject::inlineStorageCapacity * sizeof(JSValue); i += sizeof(void*)) {
+                loadPtr(Address(regT0, OBJECT_OFFSETOF(JSObject, m_inlineStorage) + i), regT3);
+                storePtr(regT3, Address(regT2, i));
+            }
+            storePtr(regT2, Address(regT0, OBJECT_OFFSETOF(JSObject, m_externalStorage)));
+            storageReallocated.append(jump());
+            noFreeStorage.link(this);
+        }
+
         // This trampoline was called to like a JIT stub; before we can can call again we need to
         // remove the return address from the stack, to prevent the stack from becoming misaligned.
         preserveReturnAddressAfterCall(regT3);
@@ -627,11 +672,13 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
         stubCall.call(regT0);
         
         restoreReturnAddressBeforeReturn(regT3);
+        storageReallocated.link(this);
     }
     
     sub32(Imm32(1), AbsoluteAddress(oldStructure->addressOfCount()));
     add32(Imm32(1), AbsoluteAddress(newStructure->addressOfCount()));
     storePtr(ImmPtr(newStructure), Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)));
+    emitWriteBarrier(regT0, regT2, regT3);
     
     load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*)), regT3);
     load32(Address(stackPointerRegister, offsetof(struct JITStackFrame, args[2]) + sizeof(void*) + 4), regT2);
@@ -642,13 +689,19 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
     ret();
     
     ASSERT(!failureCases.empty());
-    failureCases.link(this);
-    restoreArgumentReferenceForTrampoline();
-    Call failureCall = tailRecursiveCall();
+    Call failureCall;
+    if (!previousStub) {
+        failureCases.link(this);
+        restoreArgumentReferenceForTrampoline();
+        failureCall = tailRecursiveCall();
+    }
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
     
-    patchBuffer.link(failureCall, FunctionPtr(direct ? cti_op_put_by_id_direct_fail : cti_op_put_by_id_fail));
+    if (!previousStub)
+        patchBuffer.link(failureCall, FunctionPtr(direct ? cti_op_put_by_id_direct_fail : cti_op_put_by_id_fail));
+    else
+        patchBuffer.link(failureCases, previousStub);
     
     if (willNeedStorageRealloc) {
         ASSERT(m_calls.size() == 1);
@@ -803,6 +856,9 @@ void JIT::privateCompileGetByIdProto(StructureStubInfo* stubInfo, Structure* str
     } else
         compileGetDirectOffset(protoObject, regT2, regT1, regT0, cachedOffset);
     
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -864,6 +920,9 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     } else
         compileGetDirectOffset(regT0, regT1, regT0, structure, cachedOffset);
 
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::selfListStub);
+#endif
     Jump success = jump();
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -894,6 +953,48 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     repatchBuffer.relink(jumpLocation, entryLabel);
 }
 
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* polymorphicStructures, int listSize, const Identifier& ident)
+{
+    // regT0 holds the payload of a JSCell*. Look up its Structure and the property name in the
+    // global cache, and load the property from the offset recorded there.
+    UString::Rep* name = ident.ustring().rep();
+    loadPtr(Address(regT0, OBJECT_OFFSETOF(JSCell, m_structure)), regT2);
+    move(regT2, regT3);
+    mul32(Imm32(static_cast<int32_t>(MegamorphicCache::structureHashMultiplier)), regT3, regT3);
+    urshift32(Imm32(MegamorphicCache::structureHashShift), regT3);
+    xor32(Imm32(MegamorphicCache::nameHash(name)), regT3);
+    mul32(Imm32(sizeof(MegamorphicCache::Entry)), regT3, regT3);
+    addPtr(ImmPtr(m_globalData->megamorphicCache.entries()), regT3);
+    Jump structureMiss = branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT2);
+    Jump nameMiss = branchPtr(NotEqual, Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, name)), ImmPtr(name));
+    loadPtr(Address(regT3, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    compileGetDirectOffset(regT0, regT1, regT2, regT2, regT3);
+    move(regT2, regT0);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::megamorphicCache);
+#endif
+    Jump success = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
+
+    // A miss tries the Structures in the full self list, and then the slow case, which
+    // calls cti_op_get_by_id_megamorphic to fill the entry in.
+    CodeLocationLabel lastListStub = polymorphicStructures->list[listSize - 1].stubRoutine;
+    ASSERT(lastListStub);
+    patchBuffer.link(structureMiss, lastListStub);
+    patchBuffer.link(nameMiss, lastListStub);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+
+    // Finally patch the jump to slow case back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+}
+
 void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructures, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset, CallFrame* callFrame)
 {
     // regT0 holds a JSCell*
@@ -934,6 +1035,9 @@ void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, Polymorphi
     } else
         compileGetDirectOffset(protoObject, regT2, regT1, regT0, cachedOffset);
     
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -1011,6 +1115,9 @@ void JIT::privateCompileGetByIdChainList(StructureStubInfo* stubInfo, Polymorphi
     } else
         compileGetDirectOffset(protoObject, regT2, regT1, regT0, cachedOffset);
 
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
@@ -1088,6 +1195,9 @@ void JIT::privateCompileGetByIdChain(StructureStubInfo* stubInfo, Structure* str
         stubCall.call();
     } else
         compileGetDirectOffset(protoObject, regT2, regT1, regT0, cachedOffset);
+#if ENABLE(SAMPLING_COUNTERS)
+    emitCount(GetByIdCounters::prototypeStub);
+#endif
     Jump success = jump();
     
     LinkBuffer patchBuffer(this, m_codeBlock->executablePool());
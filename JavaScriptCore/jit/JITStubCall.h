@@ -157,6 +157,9 @@ namespace JSC {
             if (m_jit->m_codeBlock->isConstantRegisterIndex(src))
                 addArgument(JIT::ImmPtr(JSValue::encode(m_jit->m_codeBlock->getConstant(src))));
             else {
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+                m_jit->emitFlushCachedRegisters();
+#endif
                 m_jit->loadPtr(JIT::Address(JIT::callFrameRegister, src * sizeof(Register)), scratchRegister);
                 addArgument(scratchRegister);
             }
@@ -171,6 +174,10 @@ namespace JSC {
                 m_jit->sampleInstruction(m_jit->m_codeBlock->instructions().begin() + m_jit->m_bytecodeIndex, true);
 #endif
 
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+            // Stubs read and write the register file, and may collect garbage.
+            m_jit->emitFlushCachedRegisters();
+#endif
             m_jit->restoreArgumentReference();
             JIT::Call call = m_jit->call();
             m_jit->m_calls.append(CallRecord(call, m_jit->m_bytecodeIndex, m_stub.value()));
@@ -184,6 +191,9 @@ namespace JSC {
             m_jit->unmap();
 #else
             m_jit->killLastResultRegister();
+#endif
+#if ENABLE(JIT_REGISTER_ALLOCATION)
+            m_jit->killCachedRegisters();
 #endif
             return call;
         }
@@ -917,7 +917,7 @@ NEVER_INLINE void JITThunks::tryCachePutByID(CallFrame* callFrame, CodeBlock* co
 
         StructureChain* prototypeChain = structure->prototypeChain(callFrame);
         stubInfo->initPutByIdTransition(structure->previousID(), structure, prototypeChain);
-        JIT::compilePutByIdTransition(callFrame->scopeChain()->globalData, codeBlock, stubInfo, structure->previousID(), structure, slot.cachedOffset(), prototypeChain, returnAddress, direct);
+        JIT::compilePutByIdTransition(callFrame->scopeChain()->globalData, codeBlock, stubInfo, structure->previousID(), structure, slot.cachedOffset(), prototypeChain, returnAddress, direct, CodeLocationLabel());
         return;
     }
     
@@ -1065,6 +1065,9 @@ struct StackHack {
 
 #endif
 
+// Tells allocation site sampling which bytecode the cells a stub allocates belong to.
+#define STUB_WILL_ALLOCATE() stackFrame.globalData->heap.willAllocate(stackFrame.callFrame, (STUB_RETURN_ADDRESS).value())
+
 // The reason this is not inlined is to avoid having to do a PIC branch
 // to get the address of the ctiVMThrowTrampoline function. It's also
 // good to keep the code size down by leaving as much of the exception
@@ -1258,6 +1261,7 @@ DEFINE_STUB_FUNCTION(void, op_end)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_add)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     JSValue v1 = stackFrame.args[0].jsValue();
     JSValue v2 = stackFrame.args[1].jsValue();
@@ -1341,6 +1345,7 @@ DEFINE_STUB_FUNCTION(int, op_loop_if_lesseq)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_object)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     return constructEmptyObject(stackFrame.callFrame);
 }
@@ -1374,6 +1379,10 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
     PropertySlot slot(baseValue);
     JSValue result = baseValue.get(callFrame, ident, slot);
 
+#if ENABLE(SAMPLING_COUNTERS)
+    GetByIdCounters::generic.count();
+#endif
+
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
 }
@@ -1418,6 +1427,51 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_direct)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
+// Called when none of the transition stubs of a put_by_id matched. If the put added the
+// property by a transition, add a stub for it in front of the ones there are.
+static void tryCachePutByIdTransitionList(CallFrame* callFrame, ReturnAddressPtr returnAddress, JSValue baseValue, const PutPropertySlot& slot, bool direct)
+{
+    if (!baseValue.isCell() || !slot.isCacheable() || slot.type() != PutPropertySlot::NewProperty)
+        return;
+
+    JSCell* baseCell = asCell(baseValue);
+    Structure* structure = baseCell->structure();
+    if (baseCell != slot.base() || structure->isDictionary())
+        return;
+
+    CodeBlock* codeBlock = callFrame->codeBlock();
+    StructureStubInfo* stubInfo = &codeBlock->getStubInfo(returnAddress);
+
+    PolymorphicTransitionList* transitionList;
+    int listIndex;
+    if (stubInfo->accessType == access_put_by_id_transition) {
+        transitionList = new PolymorphicTransitionList(stubInfo->stubRoutine, stubInfo->u.putByIdTransition.previousStructure, stubInfo->u.putByIdTransition.structure, stubInfo->u.putByIdTransition.chain);
+        stubInfo->stubRoutine = CodeLocationLabel();
+        stubInfo->initPutByIdTransitionList(transitionList, 1);
+        listIndex = 1;
+    } else if (stubInfo->accessType == access_put_by_id_transition_list) {
+        transitionList = stubInfo->u.putByIdTransitionList.transitionList;
+        listIndex = stubInfo->u.putByIdTransitionList.listSize;
+    } else
+        return;
+
+    // Once the list is full, transitions it does not hold keep coming here.
+    if (listIndex == POLYMORPHIC_LIST_CACHE_SIZE)
+        return;
+
+    normalizePrototypeChain(callFrame, baseCell);
+
+    Structure* previousStructure = structure->previousID();
+    StructureChain* prototypeChain = structure->prototypeChain(callFrame);
+    JIT::compilePutByIdTransition(callFrame->scopeChain()->globalData, codeBlock, stubInfo, previousStructure, structure, slot.cachedOffset(), prototypeChain, returnAddress, direct, transitionList->list[listIndex - 1].stubRoutine);
+
+    previousStructure->ref();
+    structure->ref();
+    prototypeChain->ref();
+    transitionList->list[listIndex].set(stubInfo->stubRoutine, previousStructure, structure, prototypeChain);
+    stubInfo->u.putByIdTransitionList.listSize++;
+}
+
 DEFINE_STUB_FUNCTION(void, op_put_by_id_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
@@ -1428,6 +1482,8 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_fail)
     PutPropertySlot slot;
     stackFrame.args[0].jsValue().put(callFrame, ident, stackFrame.args[2].jsValue(), slot);
 
+    tryCachePutByIdTransitionList(callFrame, STUB_RETURN_ADDRESS, stackFrame.args[0].jsValue(), slot, false);
+
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
@@ -1441,6 +1497,8 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_direct_fail)
     PutPropertySlot slot;
     stackFrame.args[0].jsValue().putDirect(callFrame, ident, stackFrame.args[2].jsValue(), slot);
     
+    tryCachePutByIdTransitionList(callFrame, STUB_RETURN_ADDRESS, stackFrame.args[0].jsValue(), slot, true);
+
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
@@ -1601,14 +1659,44 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
             stubInfo->u.getByIdSelfList.listSize++;
             JIT::compileGetByIdSelfList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, asCell(baseValue)->structure(), ident, slot, slot.cachedOffset());
 
-            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
+            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1)) {
+                // The list is full; put the global cache in front of it.
+                JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, POLYMORPHIC_LIST_CACHE_SIZE, ident);
+                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_megamorphic));
+            }
         }
     } else
         ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
     return JSValue::encode(result);
 }
 
+DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+
+    JSValue baseValue = stackFrame.args[0].jsValue();
+    PropertySlot slot(baseValue);
+    JSValue result = baseValue.get(callFrame, ident, slot);
+
+    CHECK_FOR_EXCEPTION();
+
+#if ENABLE(SAMPLING_COUNTERS)
+    GetByIdCounters::megamorphicCacheMiss.count();
+#endif
+
+    if (baseValue.isCell()
+        && slot.isCacheable()
+        && slot.cachedPropertyType() == PropertySlot::Value
+        && !asCell(baseValue)->structure()->isDictionary()
+        && slot.slotBase() == baseValue)
+        stackFrame.globalData->megamorphicCache.add(asCell(baseValue)->structure(), ident.ustring().rep(), slot.cachedOffset());
+
+    return JSValue::encode(result);
+}
+
 static PolymorphicAccessStructureList* getPolymorphicAccessStructureListSlot(StructureStubInfo* stubInfo, int& listIndex)
 {
     PolymorphicAccessStructureList* prototypeStructureList = 0;
@@ -1861,6 +1949,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_mul)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_func)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     return stackFrame.args[0].function()->make(stackFrame.callFrame, stackFrame.callFrame->scopeChain());
 }
@@ -1964,6 +2053,7 @@ DEFINE_STUB_FUNCTION(void*, vm_lazyLinkCall)
 DEFINE_STUB_FUNCTION(JSObject*, op_push_activation)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     JSActivation* activation = new (stackFrame.globalData) JSActivation(stackFrame.callFrame, static_cast<FunctionExecutable*>(stackFrame.callFrame->codeBlock()->ownerExecutable()));
     stackFrame.callFrame->setScopeChain(stackFrame.callFrame->scopeChain()->copy()->push(activation));
@@ -2022,6 +2112,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_call_NotJSFunction)
 DEFINE_STUB_FUNCTION(void, op_create_arguments)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     Arguments* arguments = new (stackFrame.globalData) Arguments(stackFrame.callFrame);
     stackFrame.callFrame->setCalleeArguments(arguments);
@@ -2031,6 +2122,7 @@ DEFINE_STUB_FUNCTION(void, op_create_arguments)
 DEFINE_STUB_FUNCTION(void, op_create_arguments_no_params)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     Arguments* arguments = new (stackFrame.globalData) Arguments(stackFrame.callFrame, Arguments::NoParameters);
     stackFrame.callFrame->setCalleeArguments(arguments);
@@ -2081,6 +2173,7 @@ DEFINE_STUB_FUNCTION(void, op_ret_scopeChain)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_array)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     ArgList argList(&stackFrame.callFrame->registers()[stackFrame.args[0].int32()], stackFrame.args[1].int32());
     return constructArray(stackFrame.callFrame, argList);
@@ -2117,6 +2210,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_resolve)
 DEFINE_STUB_FUNCTION(JSObject*, op_construct_JSConstruct)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     JSFunction* constructor = asFunction(stackFrame.args[0].jsValue());
     if (constructor->isHostFunction()) {
@@ -2143,6 +2237,7 @@ DEFINE_STUB_FUNCTION(JSObject*, op_construct_JSConstruct)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_construct_NotJSConstruct)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     CallFrame* callFrame = stackFrame.callFrame;
 
@@ -2887,6 +2982,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_resolve_with_base)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_func_exp)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
     CallFrame* callFrame = stackFrame.callFrame;
 
     FunctionExecutable* function = stackFrame.args[0].function();
@@ -2976,6 +3072,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_bitxor)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_regexp)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     return new (stackFrame.globalData) RegExpObject(stackFrame.callFrame->lexicalGlobalObject()->regExpStructure(), stackFrame.args[0].regExp());
 }
@@ -3055,6 +3152,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_throw)
 DEFINE_STUB_FUNCTION(JSPropertyNameIterator*, op_get_pnames)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     JSObject* o = stackFrame.args[0].jsObject();
@@ -3165,6 +3263,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_to_primitive)
 DEFINE_STUB_FUNCTION(EncodedJSValue, op_strcat)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     JSValue result = jsString(stackFrame.callFrame, &stackFrame.callFrame->registers()[stackFrame.args[0].int32()], stackFrame.args[1].int32());
     CHECK_FOR_EXCEPTION_AT_END();
@@ -3225,6 +3324,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_in)
 DEFINE_STUB_FUNCTION(JSObject*, op_push_new_scope)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     JSObject* scope = new (stackFrame.globalData) JSStaticScopeObject(stackFrame.callFrame, stackFrame.args[0].identifier(), stackFrame.args[1].jsValue(), DontDelete);
 
@@ -3370,6 +3470,7 @@ DEFINE_STUB_FUNCTION(void, op_put_setter)
 DEFINE_STUB_FUNCTION(JSObject*, op_new_error)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
+    STUB_WILL_ALLOCATE();
 
     CallFrame* callFrame = stackFrame.callFrame;
     CodeBlock* codeBlock = callFrame->codeBlock();
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MegamorphicCache_h
+#define MegamorphicCache_h
+
+#include "UString.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+
+#if ENABLE(JIT)
+
+namespace JSC {
+
+    class Structure;
+
+    // Offsets of own properties, shared by every get_by_id that has seen more
+    // Structures than its polymorphic list holds. The stub such an access is
+    // relinked to looks up the (Structure, property name) pair inline; a miss
+    // falls back to the full list, and then to cti_op_get_by_id_megamorphic,
+    // which fills the entry in.
+    //
+    // Entries hold references, so a Structure or name is never reused while an
+    // entry points to it. Dictionary Structures can change in place, so they
+    // are not cached.
+    class MegamorphicCache : public Noncopyable {
+    public:
+        struct Entry {
+            RefPtr<Structure> structure;
+            RefPtr<UString::Rep> name;
+            size_t offset;
+        };
+
+        static const unsigned sizeLog2 = 9;
+        static const unsigned size = 1 << sizeLog2;
+
+        // Structures are allocated at a fixed stride, so their addresses are
+        // mixed by a multiplicative hash rather than just shifted.
+        static const unsigned structureHashMultiplier = 0x9E3779B1U;
+        static const unsigned structureHashShift = 32 - sizeLog2;
+
+        static unsigned nameHash(UString::Rep* name) { return name->existingHash() & (size - 1); }
+        static unsigned index(Structure* structure, UString::Rep* name)
+        {
+            unsigned structureHash = (static_cast<unsigned>(reinterpret_cast<uintptr_t>(structure)) * structureHashMultiplier) >> structureHashShift;
+            return structureHash ^ nameHash(name);
+        }
+
+        void add(Structure*, UString::Rep* name, size_t offset);
+        void clear();
+
+        Entry* entries() { return m_entries; }
+
+    private:
+        Entry m_entries[size];
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(JIT)
+
+#endif // MegamorphicCache_h
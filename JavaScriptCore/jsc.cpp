@@ -22,15 +22,19 @@
 
 #include "config.h"
 
+#include "BytecodeCache.h"
 #include "BytecodeGenerator.h"
 #include "Completion.h"
 #include "CurrentTime.h"
+#include "ExecutableAllocator.h"
+#include "HeapSnapshot.h"
 #include "InitializeThreading.h"
 #include "JSArray.h"
 #include "JSFunction.h"
 #include "JSLock.h"
 #include "JSString.h"
 #include "PrototypeFunction.h"
+#include "SamplingProfiler.h"
 #include "SamplingTool.h"
 #include <math.h>
 #include <stdio.h>
@@ -101,11 +105,31 @@ struct Options {
     Options()
         : interactive(false)
         , dump(false)
+        , generationalCollection(false)
+        , markingHelperThreads(-1)
+        , heapStatistics(false)
+        , heapSnapshotFileName(0)
+        , allocationSiteSamplingInterval(0)
+        , bytecodeCacheDirectory(0)
+        , startupBenchmark(false)
+        , codeFlushingAge(-1)
+        , samplingProfileFileName(0)
+        , executableAllocatorStatistics(false)
     {
     }
 
     bool interactive;
     bool dump;
+    bool generationalCollection;
+    int markingHelperThreads; // -1 unless set with -m
+    bool heapStatistics;
+    const char* heapSnapshotFileName; // 0 unless set with -w
+    unsigned allocationSiteSamplingInterval;
+    const char* bytecodeCacheDirectory; // 0 unless set with -b or -B
+    bool startupBenchmark;
+    int codeFlushingAge; // -1 unless set with -F
+    const char* samplingProfileFileName; // 0 unless set with -p
+    bool executableAllocatorStatistics;
     Vector<Script> scripts;
     Vector<UString> arguments;
 };
@@ -414,6 +438,48 @@ static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scr
     return success;
 }
 
+#if ENABLE(BYTECODE_CACHE)
+// Runs the scripts in a new global object twice: first with their entries
+// removed from the bytecode cache, then loading them from it.
+static bool runStartupBenchmark(JSGlobalData* globalData, const Options& options)
+{
+    BytecodeCache* bytecodeCache = globalData->bytecodeCache.get();
+    Vector<SourceCode> sources;
+    for (size_t i = 0; i < options.scripts.size(); i++) {
+        if (options.scripts[i].isFile) {
+            Vector<char> scriptBuffer;
+            if (!fillBufferWithContentsOfFile(options.scripts[i].argument, scriptBuffer))
+                return false;
+            sources.append(makeSource(scriptBuffer.data(), options.scripts[i].argument));
+        } else
+            sources.append(makeSource(options.scripts[i].argument, "[Command Line]"));
+    }
+
+    bool success = true;
+    for (int warm = 0; warm < 2; warm++) {
+        if (!warm) {
+            for (size_t i = 0; i < sources.size(); i++)
+                bytecodeCache->remove(sources[i]);
+        }
+        BytecodeCache::Statistics before = bytecodeCache->statistics();
+
+        GlobalObject* globalObject = new (globalData) GlobalObject(options.arguments);
+        double startTime = currentTime();
+        for (size_t i = 0; i < sources.size(); i++) {
+            Completion completion = evaluate(globalObject->globalExec(), globalObject->globalScopeChain(), sources[i]);
+            success = success && completion.complType() != Throw;
+            globalObject->globalExec()->clearException();
+        }
+        double elapsed = currentTime() - startTime;
+
+        const BytecodeCache::Statistics& after = bytecodeCache->statistics();
+        printf("%s startup: %.3f ms, %lu programs loaded from the cache, %lu stored\n", warm ? "warm" : "cold", elapsed * 1000,
+            static_cast<unsigned long>(after.hits - before.hits), static_cast<unsigned long>(after.stores - before.stores));
+    }
+    return success;
+}
+#endif
+
 #define RUNNING_FROM_XCODE 0
 
 static void runInteractive(GlobalObject* globalObject)
@@ -455,14 +521,34 @@ static void runInteractive(GlobalObject* globalObject)
 static NO_RETURN void printUsageStatement(JSGlobalData* globalData, bool help = false)
 {
     fprintf(stderr, "Usage: jsc [options] [files] [-- arguments]\n");
+    fprintf(stderr, "  -a n       Records the allocation site of every nth cell in the heap snapshot\n");
+#if ENABLE(BYTECODE_CACHE)
+    fprintf(stderr, "  -b dir     Loads program bytecode from and stores it to dir\n");
+    fprintf(stderr, "  -B dir     Prints startup times without, then with, program bytecode cached in dir\n");
+#endif
+    fprintf(stderr, "  -c         Prints collector heap statistics on exit\n");
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
+#if ENABLE(CODE_FLUSHING)
+    fprintf(stderr, "  -F age     Discards code not called for age full collections and prints the code memory reclaimed on exit\n");
+#endif
+    fprintf(stderr, "  -g         Enables generational garbage collection and prints pause times on exit\n");
     fprintf(stderr, "  -h|--help  Prints this help message\n");
     fprintf(stderr, "  -i         Enables interactive mode (default if no files are specified)\n");
+#if ENABLE(PARALLEL_GC)
+    fprintf(stderr, "  -m count   Marks with count helper threads and prints marking time on exit\n");
+#endif
+#if ENABLE(SAMPLING_PROFILER)
+    fprintf(stderr, "  -p file    Samples call stacks 1000 times a second and writes them to file on exit, folded for flame graph tools\n");
+#endif
 #if HAVE(SIGNAL_H)
     fprintf(stderr, "  -s         Installs signal handlers that exit on a crash (Unix platforms only)\n");
 #endif
+    fprintf(stderr, "  -w file    Writes a heap snapshot to file on exit\n");
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
+    fprintf(stderr, "  -x         Prints executable memory pool statistics on exit\n");
+#endif
 
     cleanupGlobalData(globalData);
     exit(help ? EXIT_SUCCESS : EXIT_FAILURE);
@@ -489,10 +575,61 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
             options.interactive = true;
             continue;
         }
+        if (!strcmp(arg, "-a")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.allocationSiteSamplingInterval = atoi(argv[i]);
+            continue;
+        }
+#if ENABLE(BYTECODE_CACHE)
+        if (!strcmp(arg, "-b") || !strcmp(arg, "-B")) {
+            options.startupBenchmark = arg[1] == 'B';
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.bytecodeCacheDirectory = argv[i];
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "-c")) {
+            options.heapStatistics = true;
+            continue;
+        }
         if (!strcmp(arg, "-d")) {
             options.dump = true;
             continue;
         }
+#if ENABLE(CODE_FLUSHING)
+        if (!strcmp(arg, "-F")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.codeFlushingAge = atoi(argv[i]);
+            if (options.codeFlushingAge < 0)
+                printUsageStatement(globalData);
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "-g")) {
+            options.generationalCollection = true;
+            continue;
+        }
+#if ENABLE(PARALLEL_GC)
+        if (!strcmp(arg, "-m")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.markingHelperThreads = atoi(argv[i]);
+            if (options.markingHelperThreads < 0)
+                printUsageStatement(globalData);
+            continue;
+        }
+#endif
+#if ENABLE(SAMPLING_PROFILER)
+        if (!strcmp(arg, "-p")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.samplingProfileFileName = argv[i];
+            continue;
+        }
+#endif
         if (!strcmp(arg, "-s")) {
 #if HAVE(SIGNAL_H)
             signal(SIGILL, _exit);
@@ -502,6 +639,18 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
 #endif
             continue;
         }
+        if (!strcmp(arg, "-w")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            options.heapSnapshotFileName = argv[i];
+            continue;
+        }
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
+        if (!strcmp(arg, "-x")) {
+            options.executableAllocatorStatistics = true;
+            continue;
+        }
+#endif
         if (!strcmp(arg, "--")) {
             ++i;
             break;
@@ -518,6 +667,22 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
         options.arguments.append(argv[i]);
 }
 
+#if ENABLE(SAMPLING_PROFILER)
+static bool writeSamplingProfile(SamplingProfiler* samplingProfiler, const char* fileName)
+{
+    samplingProfiler->stop();
+
+    FILE* file = fopen(fileName, "w");
+    if (!file)
+        return false;
+    CString foldedStacks = samplingProfiler->foldedStacks().UTF8String();
+    bool success = fwrite(foldedStacks.data(), 1, foldedStacks.length(), file) == foldedStacks.length();
+    success = !fclose(file) && success;
+    printf("sampling profiler: %u samples\n", samplingProfiler->sampleCount());
+    return success;
+}
+#endif
+
 int jscmain(int argc, char** argv, JSGlobalData* globalData)
 {
     JSLock lock(SilenceAssertionsOnly);
@@ -525,11 +690,89 @@ int jscmain(int argc, char** argv, JSGlobalData* globalData)
     Options options;
     parseArguments(argc, argv, options, globalData);
 
+    if (options.generationalCollection)
+        globalData->heap.setGenerationalCollectionEnabled(true);
+#if ENABLE(PARALLEL_GC)
+    if (options.markingHelperThreads > 0)
+        globalData->setMarkingHelperThreadCount(options.markingHelperThreads);
+#endif
+
+    if (options.allocationSiteSamplingInterval)
+        globalData->heap.setAllocationSiteSamplingInterval(options.allocationSiteSamplingInterval);
+#if ENABLE(CODE_FLUSHING)
+    if (options.codeFlushingAge >= 0)
+        globalData->heap.setCodeFlushingAge(options.codeFlushingAge);
+#endif
+
+#if ENABLE(BYTECODE_CACHE)
+    if (options.bytecodeCacheDirectory)
+        globalData->bytecodeCache.set(new BytecodeCache(options.bytecodeCacheDirectory));
+    if (options.startupBenchmark)
+        return runStartupBenchmark(globalData, options) ? 0 : 3;
+#endif
+
+#if ENABLE(SAMPLING_PROFILER)
+    if (options.samplingProfileFileName) {
+        globalData->samplingProfiler.set(new SamplingProfiler(globalData));
+        globalData->samplingProfiler->start();
+    }
+#endif
+
     GlobalObject* globalObject = new (globalData) GlobalObject(options.arguments);
     bool success = runWithScripts(globalObject, options.scripts, options.dump);
     if (options.interactive && success)
         runInteractive(globalObject);
 
+#if ENABLE(SAMPLING_PROFILER)
+    if (options.samplingProfileFileName && !writeSamplingProfile(globalData->samplingProfiler.get(), options.samplingProfileFileName)) {
+        fprintf(stderr, "Could not write sampling profile: %s\n", options.samplingProfileFileName);
+        success = false;
+    }
+#endif
+
+    if (options.generationalCollection) {
+        const Heap::CollectionStatistics& statistics = globalData->heap.collectionStatistics();
+        printf("minor collections: %lu, total %.3f ms, max %.3f ms\n", static_cast<unsigned long>(statistics.minorCollections),
+            statistics.minorPauseTime * 1000, statistics.maxMinorPauseTime * 1000);
+        printf("full collections: %lu, total %.3f ms, max %.3f ms\n", static_cast<unsigned long>(statistics.fullCollections),
+            statistics.fullPauseTime * 1000, statistics.maxFullPauseTime * 1000);
+    }
+    if (options.markingHelperThreads >= 0) {
+        const Heap::CollectionStatistics& statistics = globalData->heap.collectionStatistics();
+        printf("marking with %d helper threads: total %.3f ms\n", options.markingHelperThreads, statistics.markTime * 1000);
+    }
+    if (options.codeFlushingAge >= 0) {
+        const Heap::CollectionStatistics& statistics = globalData->heap.collectionStatistics();
+        printf("code flushing: %lu functions, %lu KB reclaimed by %lu full collections, at most %lu KB by one\n",
+            static_cast<unsigned long>(statistics.functionsFlushed), static_cast<unsigned long>(statistics.codeBytesFlushed / 1024),
+            static_cast<unsigned long>(statistics.fullCollections), static_cast<unsigned long>(statistics.maxCodeBytesFlushed / 1024));
+    }
+    if (options.heapStatistics) {
+        Heap::Statistics statistics = globalData->heap.statistics();
+        size_t objectCount = globalData->heap.objectCount();
+        printf("heap: %lu KB, %lu cells, %.1f bytes per cell\n", static_cast<unsigned long>(statistics.size / 1024), static_cast<unsigned long>(objectCount),
+            objectCount ? static_cast<double>(statistics.size - statistics.free) / objectCount : 0);
+        const Heap::CollectionStatistics& collectionStatistics = globalData->heap.collectionStatistics();
+        printf("stack scanning: %lu words searched, %lu reused from the previous scan\n", static_cast<unsigned long>(collectionStatistics.stackWordsSearched),
+            static_cast<unsigned long>(collectionStatistics.stackWordsReused));
+    }
+#if ENABLE(EXECUTABLE_ALLOCATOR_FIXED)
+    if (options.executableAllocatorStatistics) {
+        ExecutableAllocator::Statistics statistics = ExecutableAllocator::statistics();
+        size_t freeBytes = statistics.reservedBytes - statistics.bytesAllocated;
+        printf("executable memory: %lu KB in use, at most %lu KB; %lu allocations, %lu from size classes; %lu coalesces\n",
+            static_cast<unsigned long>(statistics.bytesAllocated / 1024), static_cast<unsigned long>(statistics.highWaterMark / 1024),
+            static_cast<unsigned long>(statistics.allocations), static_cast<unsigned long>(statistics.sizeClassAllocations), static_cast<unsigned long>(statistics.coalesces));
+        printf("executable memory free: %lu KB in %lu chunks, largest %lu KB, %.2f%% fragmented\n",
+            static_cast<unsigned long>(freeBytes / 1024), static_cast<unsigned long>(statistics.freeChunks), static_cast<unsigned long>(statistics.largestFreeChunk / 1024),
+            freeBytes ? 100.0 * (freeBytes - statistics.largestFreeChunk) / freeBytes : 0);
+    }
+#endif
+    if (options.heapSnapshotFileName && !writeHeapSnapshot(globalData, options.heapSnapshotFileName)) {
+        fprintf(stderr, "Could not write heap snapshot: %s\n", options.heapSnapshotFileName);
+        success = false;
+    }
+
     return success ? 0 : 3;
 }
 
@@ -49,6 +49,7 @@ static const UChar byteOrderMark = 0xFEFF;
 
 Lexer::Lexer(JSGlobalData* globalData)
     : m_isReparsing(false)
+    , m_canSkipFunctionBodies(false)
     , m_globalData(globalData)
     , m_keywordTable(JSC::mainTable)
 {
@@ -161,11 +162,23 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
         }
     }
 
+    // Offsets only match the ones recorded in the provider when no BOMs were stripped.
+    m_canSkipFunctionBodies = m_codeWithoutBOMs.isEmpty() && source.provider()->hasFunctionBodyEnds();
+
     // Read the first characters into the 4-character buffer.
     shift4();
     ASSERT(currentOffset() == source.startOffset());
 }
 
+void Lexer::skipTo(int offset, int lineNumber)
+{
+    ASSERT(offset >= currentOffset());
+    m_code = m_codeStart + offset;
+    m_lineNumber = lineNumber;
+    shift4();
+    ASSERT(currentOffset() == offset);
+}
+
 void Lexer::copyCodeWithoutBOMs()
 {
     // Note: In this case, the character offset data for debugging will be incorrect.
@@ -516,6 +529,20 @@ start:
             lvalp->intValue = currentOffset();
             shift1();
             token = OPENBRACE;
+            if (UNLIKELY(m_canSkipFunctionBodies) && lvalp->intValue != m_source->startOffset()) {
+                // A function body whose syntax was checked by an earlier parse; its contents would
+                // be parsed without building nodes again, so go straight to the closing brace.
+                if (const SourceProvider::FunctionBodyEnd* end = m_source->provider()->functionBodyEnd(lvalp->intValue)) {
+                    llocp->first_line = m_lineNumber;
+                    llocp->last_line = m_lineNumber;
+                    llocp->first_column = startOffset;
+                    llocp->last_column = currentOffset();
+                    m_atLineStart = false;
+                    m_lastToken = token;
+                    skipTo(end->closeBrace, end->lineNumber);
+                    return token;
+                }
+            }
             break;
         case '}':
             lvalp->intValue = currentOffset();
@@ -1018,6 +1045,12 @@ void Lexer::clear()
     m_isReparsing = false;
 }
 
+void Lexer::recordFunctionBody(int openBrace, int closeBrace, int closeBraceLine)
+{
+    if (m_codeWithoutBOMs.isEmpty())
+        m_source->provider()->recordFunctionBodyEnd(openBrace, closeBrace, closeBraceLine);
+}
+
 SourceCode Lexer::sourceCode(int openBrace, int closeBrace, int firstLine)
 {
     if (m_codeWithoutBOMs.isEmpty())
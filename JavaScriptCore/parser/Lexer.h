@@ -51,6 +51,7 @@ namespace JSC {
         int lineNumber() const { return m_lineNumber; }
         bool prevTerminator() const { return m_terminator; }
         SourceCode sourceCode(int openBrace, int closeBrace, int firstLine);
+        void recordFunctionBody(int openBrace, int closeBrace, int closeBraceLine);
         bool scanRegExp(const Identifier*& pattern, const Identifier*& flags, UChar patternPrefix = 0);
         bool skipRegExp();
 
@@ -78,6 +79,7 @@ namespace JSC {
 
         int currentOffset() const;
         const UChar* currentCharacter() const;
+        void skipTo(int offset, int lineNumber);
 
         const Identifier* makeIdentifier(const UChar* characters, size_t length);
 
@@ -98,6 +100,7 @@ namespace JSC {
         const UChar* m_codeStart;
         const UChar* m_codeEnd;
         bool m_isReparsing;
+        bool m_canSkipFunctionBodies;
         bool m_atLineStart;
         bool m_error;
 
@@ -30,6 +30,7 @@
 #define SourceProvider_h
 
 #include "UString.h"
+#include <wtf/HashMap.h>
 #include <wtf/RefCounted.h>
 
 namespace JSC {
@@ -54,9 +55,31 @@ namespace JSC {
 
         SourceBOMPresence hasBOMs() const { return m_hasBOMs; }
 
+        // Nested function bodies are only checked for syntax when the code around them is parsed.
+        // Remembering where each checked body ends lets the parse of an enclosing function, which
+        // happens later when that function is first called, skip over them instead of rescanning.
+        struct FunctionBodyEnd {
+            int closeBrace;
+            int lineNumber;
+        };
+
+        void recordFunctionBodyEnd(int openBrace, int closeBrace, int lineNumber)
+        {
+            ASSERT(openBrace > 0);
+            FunctionBodyEnd end = { closeBrace, lineNumber };
+            m_functionBodyEnds.add(openBrace, end);
+        }
+        bool hasFunctionBodyEnds() const { return !m_functionBodyEnds.isEmpty(); }
+        const FunctionBodyEnd* functionBodyEnd(int openBrace) const
+        {
+            HashMap<int, FunctionBodyEnd>::const_iterator it = m_functionBodyEnds.find(openBrace);
+            return it == m_functionBodyEnds.end() ? 0 : &it->second;
+        }
+
     private:
         UString m_url;
         SourceBOMPresence m_hasBOMs;
+        HashMap<int, FunctionBodyEnd> m_functionBodyEnds;
     };
 
     class UStringSourceProvider : public SourceProvider {
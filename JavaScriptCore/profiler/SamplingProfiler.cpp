@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SamplingProfiler.h"
+
+#if ENABLE(SAMPLING_PROFILER)
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include "JSGlobalData.h"
+#include "Profiler.h"
+#include "StringBuilder.h"
+
+#if OS(WINDOWS)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace JSC {
+
+// Checks never get further apart than this many ticks while the profiler runs.
+static const unsigned maximumTicksUntilNextCheck = 1 << 20;
+
+// Only the innermost frames of deeper stacks are kept, below a "(truncated)" frame,
+// so that runaway recursion does not make every sample slow.
+static const size_t maximumSampledFrames = 128;
+
+#if OS(WINDOWS)
+
+static void sleepForMicroseconds(unsigned us)
+{
+    unsigned ms = us / 1000;
+    if (us && !ms)
+        ms = 1;
+    Sleep(ms);
+}
+
+#else
+
+static void sleepForMicroseconds(unsigned us)
+{
+    usleep(us);
+}
+
+#endif
+
+SamplingProfiler::SamplingProfiler(JSGlobalData* globalData)
+    : m_globalData(globalData)
+    , m_sampleCount(0)
+    , m_ticksUntilNextCheck(1024)
+    , m_periodsAtLastCheckpoint(0)
+    , m_periods(0)
+    , m_running(false)
+    , m_hertz(defaultHertz)
+    , m_timerThread(0)
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stop();
+}
+
+void* SamplingProfiler::threadStartFunc(void* argument)
+{
+    SamplingProfiler* profiler = static_cast<SamplingProfiler*>(argument);
+    unsigned period = 1000000 / profiler->m_hertz;
+    while (profiler->m_running) {
+        sleepForMicroseconds(period);
+        ++profiler->m_periods;
+    }
+    return 0;
+}
+
+void SamplingProfiler::start(unsigned hertz)
+{
+    if (m_running)
+        return;
+
+    m_hertz = min(max(hertz, 1u), 1000000u);
+    m_periodsAtLastCheckpoint = m_periods;
+    m_running = true;
+    m_timerThread = createThread(threadStartFunc, this, "JavaScriptCore::StackSampler");
+    if (!m_timerThread) {
+        m_running = false;
+        return;
+    }
+    m_globalData->timeoutChecker.setSamplingProfiler(this);
+}
+
+void SamplingProfiler::stop()
+{
+    if (!m_running)
+        return;
+
+    m_running = false;
+    waitForThreadCompletion(m_timerThread, 0);
+    m_timerThread = 0;
+    m_globalData->timeoutChecker.setSamplingProfiler(0);
+}
+
+void SamplingProfiler::clear()
+{
+    deleteAllValues(m_root.children);
+    m_root.children.clear();
+    m_root.sampleCount = 0;
+    m_sampleCount = 0;
+}
+
+void SamplingProfiler::didReachCheckpoint(ExecState* exec)
+{
+    unsigned periods = m_periods;
+    unsigned elapsedPeriods = periods - m_periodsAtLastCheckpoint;
+    if (!elapsedPeriods) {
+        // Checking more often than we sample, so check less often.
+        if (m_ticksUntilNextCheck < maximumTicksUntilNextCheck)
+            m_ticksUntilNextCheck *= 2;
+        return;
+    }
+    // Samples have been missed, so check more often.
+    if (elapsedPeriods > 1 && m_ticksUntilNextCheck > 1)
+        m_ticksUntilNextCheck /= 2;
+
+    m_periodsAtLastCheckpoint = periods;
+    takeSample(exec);
+}
+
+void SamplingProfiler::takeSample(ExecState* exec)
+{
+    m_frames.shrink(0);
+    for (CallFrame* frame = exec; frame; frame = frame->callerFrame()->removeHostCallFrameFlag()) {
+        if (m_frames.size() == maximumSampledFrames) {
+            m_frames.append(CallIdentifier("(truncated)", "", 0));
+            break;
+        }
+
+        // The code block of a host function's frame is not set, so look at the callee first.
+        if (JSFunction* callee = frame->callee()) {
+            m_frames.append(Profiler::createCallIdentifier(exec, callee, "", 0));
+            continue;
+        }
+
+        // Global and eval code have no callee. Neither has the global object's
+        // frame that calls from the API into script, which has no code block.
+        CodeBlock* codeBlock = frame->codeBlock();
+        if (!codeBlock)
+            continue;
+        ScriptExecutable* executable = codeBlock->ownerExecutable();
+        m_frames.append(CallIdentifier(codeBlock->codeType() == EvalCode ? "(eval)" : "(program)", executable->sourceURL(), executable->lineNo()));
+    }
+    if (m_frames.isEmpty())
+        return;
+
+    Node* node = &m_root;
+    for (size_t i = m_frames.size(); i--; ) {
+        pair<HashMap<CallIdentifier, Node*>::iterator, bool> result = node->children.add(m_frames[i], 0);
+        if (result.second)
+            result.first->second = new Node;
+        node = result.first->second;
+    }
+    ++node->sampleCount;
+    ++m_sampleCount;
+}
+
+static void appendFrameName(Vector<UChar>& stack, const CallIdentifier& frame)
+{
+    UString name = frame.m_url.isEmpty() ? frame.m_name : makeString(frame.m_name, " (", frame.m_url, ":", UString::from(frame.m_lineNumber), ")");
+    for (unsigned i = 0; i < name.size(); ++i) {
+        // Semicolons separate frames, and newlines separate stacks.
+        UChar c = name[i];
+        if (c == ';')
+            c = ',';
+        else if (c == '\n' || c == '\r')
+            c = ' ';
+        stack.append(c);
+    }
+}
+
+void SamplingProfiler::appendFoldedStacks(StringBuilder& builder, Vector<UChar>& stack, const Node* node)
+{
+    if (node->sampleCount) {
+        builder.append(stack.data(), stack.size());
+        builder.append(' ');
+        builder.append(UString::from(node->sampleCount));
+        builder.append('\n');
+    }
+
+    size_t stackSize = stack.size();
+    HashMap<CallIdentifier, Node*>::const_iterator end = node->children.end();
+    for (HashMap<CallIdentifier, Node*>::const_iterator it = node->children.begin(); it != end; ++it) {
+        if (stackSize)
+            stack.append(';');
+        appendFrameName(stack, it->first);
+        appendFoldedStacks(builder, stack, it->second);
+        stack.shrink(stackSize);
+    }
+}
+
+UString SamplingProfiler::foldedStacks() const
+{
+    StringBuilder builder;
+    Vector<UChar> stack;
+    appendFoldedStacks(builder, stack, &m_root);
+    return builder.build();
+}
+
+} // namespace JSC
+
+#endif // ENABLE(SAMPLING_PROFILER)
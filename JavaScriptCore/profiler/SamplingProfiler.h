@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SamplingProfiler_h
+#define SamplingProfiler_h
+
+#if ENABLE(SAMPLING_PROFILER)
+
+#include "CallIdentifier.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class ExecState;
+    class JSGlobalData;
+    class StringBuilder;
+
+    // Samples the script call stack of a JSGlobalData at a fixed rate, and can be
+    // started and stopped at any time. A timer thread counts off the sampling
+    // periods; the thread running script takes each sample at its next timeout
+    // check, where both the interpreter and the JIT have a consistent chain of
+    // call frames to walk. Samples are kept as a call tree, which is written out
+    // as folded stacks, the text format flame graph tools read.
+    class SamplingProfiler : public Noncopyable {
+    public:
+        static const unsigned defaultHertz = 1000;
+
+        SamplingProfiler(JSGlobalData*);
+        ~SamplingProfiler();
+
+        void start(unsigned hertz = defaultHertz);
+        void stop();
+        bool isRunning() const { return m_running; }
+
+        // Samples are kept across start() and stop() until they are cleared.
+        void clear();
+        unsigned sampleCount() const { return m_sampleCount; }
+
+        // One line per distinct stack, outermost frame first, frames separated by
+        // semicolons and followed by the number of samples, e.g.
+        // "(program) (test.js:1);draw (test.js:12);fillRect 37".
+        UString foldedStacks() const;
+
+        // Called by the TimeoutChecker at every check while the profiler runs.
+        // The profiler takes a sample if a period has passed since the last one,
+        // and spaces out the checks so that they come about once a period.
+        void didReachCheckpoint(ExecState*);
+        unsigned ticksUntilNextCheck() const { return m_ticksUntilNextCheck; }
+
+    private:
+        struct Node : public Noncopyable {
+            Node() : sampleCount(0) { }
+            ~Node() { deleteAllValues(children); }
+
+            HashMap<CallIdentifier, Node*> children;
+            unsigned sampleCount; // Samples with this node as the innermost frame.
+        };
+
+        static void* threadStartFunc(void*);
+        void takeSample(ExecState*);
+        static void appendFoldedStacks(StringBuilder&, Vector<UChar>& stack, const Node*);
+
+        JSGlobalData* m_globalData;
+        Node m_root;
+        unsigned m_sampleCount;
+        Vector<CallIdentifier, 32> m_frames; // Reused by every sample.
+
+        unsigned m_ticksUntilNextCheck;
+        unsigned m_periodsAtLastCheckpoint;
+        volatile unsigned m_periods; // Advanced by the timer thread.
+
+        volatile bool m_running;
+        unsigned m_hertz;
+        ThreadIdentifier m_timerThread;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(SAMPLING_PROFILER)
+
+#endif // SamplingProfiler_h
@@ -221,6 +221,7 @@ void Arguments::put(ExecState* exec, unsigned i, JSValue value)
 {
     PutPropertySlot slot;
     if (i < d->numArguments && (!d->deletedArguments || !d->deletedArguments[i])) {
+        writeBarrier(value);
         if (i < d->numParameters)
             d->registers[d->firstParameterIndex + i] = JSValue(value);
         else
@@ -236,6 +237,7 @@ void Arguments::put(ExecState* exec, const Identifier& propertyName, JSValue val
     bool isArrayIndex;
     unsigned i = propertyName.toArrayIndex(&isArrayIndex);
     if (isArrayIndex && i < d->numArguments && (!d->deletedArguments || !d->deletedArguments[i])) {
+        writeBarrier(value);
         if (i < d->numParameters)
             d->registers[d->firstParameterIndex + i] = JSValue(value);
         else
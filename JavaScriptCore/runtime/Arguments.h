@@ -83,6 +83,7 @@ namespace JSC {
         bool isTornOff() const { return d->registerArray; }
         void setActivation(JSActivation* activation)
         {
+            Heap::writeBarrier(this);
             d->activation = activation;
             d->registers = &activation->registerAt(0);
         }
@@ -110,6 +111,14 @@ namespace JSC {
 
         void init(CallFrame*);
 
+        void writeBarrier(JSValue value)
+        {
+            Heap::writeBarrier(this, value);
+            // Once the activation is torn off, parameters are stored in its registers.
+            if (d->activation)
+                Heap::writeBarrier(d->activation, value);
+        }
+
         OwnPtr<ArgumentsData> d;
     };
 
@@ -215,6 +224,7 @@ namespace JSC {
 
         Register* registerArray = new Register[registerArraySize];
         memcpy(registerArray, d->registers - registerOffset, registerArraySize * sizeof(Register));
+        Heap::writeBarrier(this);
         d->registerArray.set(registerArray);
         d->registers = registerArray + registerOffset;
     }
@@ -222,20 +232,15 @@ namespace JSC {
     // This JSActivation function is defined here so it can get at Arguments::setRegisters.
     inline void JSActivation::copyRegisters(Arguments* arguments)
     {
-        ASSERT(!d()->registerArray);
-
-        size_t numParametersMinusThis = d()->functionExecutable->generatedBytecode().m_numParameters - 1;
-        size_t numVars = d()->functionExecutable->generatedBytecode().m_numVars;
-        size_t numLocals = numVars + numParametersMinusThis;
-
-        if (!numLocals)
-            return;
+        ASSERT(!isTornOff());
 
-        int registerOffset = numParametersMinusThis + RegisterFile::CallFrameHeaderSize;
-        size_t registerArraySize = numLocals + RegisterFile::CallFrameHeaderSize;
+        CodeBlock& codeBlock = d()->functionExecutable->generatedBytecode();
+        int registerOffset = JSActivationData::registerOffset(codeBlock);
+        size_t registerArraySize = JSActivationData::registerCount(codeBlock);
 
-        Register* registerArray = copyRegisterArray(d()->registers - registerOffset, registerArraySize);
-        setRegisters(registerArray + registerOffset, registerArray);
+        memcpy(d()->tornOffRegisters - registerOffset, d()->registers - registerOffset, registerArraySize * sizeof(Register));
+        Heap::writeBarrier(this);
+        d()->registers = d()->tornOffRegisters;
         if (arguments && !arguments->isTornOff())
             static_cast<Arguments*>(arguments)->setActivation(this);
     }
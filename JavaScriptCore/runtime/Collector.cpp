@@ -25,7 +25,13 @@
 #include "CallFrame.h"
 #include "CodeBlock.h"
 #include "CollectorHeapIterator.h"
+#include "DateInstance.h"
+#include "Executable.h"
+#include "HeapSnapshot.h"
 #include "Interpreter.h"
+#include "JSActivation.h"
+#include "Arguments.h"
+#include "BooleanObject.h"
 #include "JSArray.h"
 #include "JSGlobalObject.h"
 #include "JSLock.h"
@@ -35,11 +41,14 @@
 #include "JSZombie.h"
 #include "MarkStack.h"
 #include "Nodes.h"
+#include "NumberObject.h"
+#include "StringObject.h"
 #include "Tracing.h"
 #include <algorithm>
 #include <limits.h>
 #include <setjmp.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -104,6 +113,11 @@ namespace JSC {
 const size_t GROWTH_FACTOR = 2;
 const size_t LOW_WATER_FACTOR = 4;
 const size_t ALLOCATIONS_PER_COLLECTION = 3600;
+// With generational collection on, a full collection is done once the number of
+// live cells has grown by this factor since the last full collection.
+const size_t OLD_GENERATION_GROWTH_FACTOR = 2;
+// Full collections a function may go without being called before its code is thrown away.
+const unsigned CODE_FLUSHING_AGE = 16;
 // This value has to be a macro to be used in max() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_ARRAY_SIZE (static_cast<size_t>(14))
@@ -129,12 +143,28 @@ public:
     pthread_t posixThread;
     PlatformThread platformThread;
     void* stackBase;
+    ConservativeRootCache roots;
 };
 
 #endif
 
 Heap::Heap(JSGlobalData* globalData)
-    : m_markListSet(0)
+    : m_operationInProgress(NoOperation)
+    , m_extraCost(0)
+    , m_didShrink(false)
+    , m_allocationBudget(ALLOCATIONS_PER_COLLECTION * CELL_SIZE)
+    , m_markListSet(0)
+    , m_generationalCollectionEnabled(false)
+    , m_isMinorCollection(false)
+    , m_cellsAfterFullCollection(0)
+#if ENABLE(CODE_FLUSHING)
+    , m_codeFlushingAge(CODE_FLUSHING_AGE)
+#endif
+    , m_conservativeScanNumber(0)
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+    , m_blockFreeingThread(0)
+    , m_blockFreeingThreadShouldExit(false)
+#endif
 #if ENABLE(JSC_MULTIPLE_THREADS)
     , m_registeredThreads(0)
     , m_currentThreadRegistrar(0)
@@ -142,11 +172,18 @@ Heap::Heap(JSGlobalData* globalData)
 #if OS(SYMBIAN)
     , m_blockallocator(JSCCOLLECTOR_VIRTUALMEM_RESERVATION, BLOCK_SIZE)
 #endif
+    , m_freePropertyStorageCount(0)
     , m_globalData(globalData)
 {
     ASSERT(globalData);
-    memset(&m_heap, 0, sizeof(CollectorHeap));
-    allocateBlock();
+    memset(m_heaps, 0, sizeof(m_heaps));
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        heap.atomsPerCell = MIN_CELL_ATOMS + sizeClass;
+        heap.cellSize = heap.atomsPerCell * CELL_ATOM_SIZE;
+        heap.cellsPerBlock = ATOMS_PER_BLOCK / heap.atomsPerCell;
+    }
+    memset(&m_collectionStatistics, 0, sizeof(CollectionStatistics));
 }
 
 Heap::~Heap()
@@ -172,7 +209,23 @@ void Heap::destroy()
     delete m_markListSet;
     m_markListSet = 0;
 
+    m_rememberedCells.clear();
+    m_compiledFunctions.clear();
+#if ENABLE(CODE_FLUSHING)
+    m_functionsWithCode.clear();
+#endif
+#if ENABLE(PARALLEL_GC)
+    m_parallelMarker.clear();
+#endif
+    m_allocationSiteSampler.clear();
+
     freeBlocks();
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+    stopBlockFreeingThread();
+#endif
+
+    while (EncodedJSValue* storage = takeFreePropertyStorage())
+        delete [] storage;
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
     if (m_currentThreadRegistrar) {
@@ -193,7 +246,42 @@ void Heap::destroy()
     m_globalData = 0;
 }
 
-NEVER_INLINE CollectorBlock* Heap::allocateBlock()
+NEVER_INLINE CollectorBlock* Heap::allocateBlock(CollectorHeap& heap)
+{
+    CollectorBlock* block = 0;
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+    block = takeRecycledBlock();
+#endif
+    if (!block)
+        block = allocateBlockPtr();
+
+    // Initialize block.
+
+    block->heap = this;
+    clearMarkBits(heap, block);
+    clearCards(block);
+
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+    for (size_t i = 0; i < heap.cellsPerBlock; ++i)
+        new (block->atoms + i * heap.atomsPerCell) JSCell(dummyMarkableCellStructure);
+    
+    // Add block to blocks vector.
+
+    size_t numBlocks = heap.numBlocks;
+    if (heap.usedBlocks == numBlocks) {
+        static const size_t maxNumBlocks = ULONG_MAX / sizeof(CollectorBlock*) / GROWTH_FACTOR;
+        if (numBlocks > maxNumBlocks)
+            CRASH();
+        numBlocks = max(MIN_ARRAY_SIZE, numBlocks * GROWTH_FACTOR);
+        heap.numBlocks = numBlocks;
+        heap.blocks = static_cast<CollectorBlock**>(fastRealloc(heap.blocks, numBlocks * sizeof(CollectorBlock*)));
+    }
+    heap.blocks[heap.usedBlocks++] = block;
+
+    return block;
+}
+
+NEVER_INLINE CollectorBlock* Heap::allocateBlockPtr()
 {
 #if OS(DARWIN)
     vm_address_t address = 0;
@@ -246,38 +334,15 @@ NEVER_INLINE CollectorBlock* Heap::allocateBlock()
     address += adjust;
 #endif
 
-    // Initialize block.
-
-    CollectorBlock* block = reinterpret_cast<CollectorBlock*>(address);
-    block->heap = this;
-    clearMarkBits(block);
-
-    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
-    for (size_t i = 0; i < HeapConstants::cellsPerBlock; ++i)
-        new (block->cells + i) JSCell(dummyMarkableCellStructure);
-    
-    // Add block to blocks vector.
-
-    size_t numBlocks = m_heap.numBlocks;
-    if (m_heap.usedBlocks == numBlocks) {
-        static const size_t maxNumBlocks = ULONG_MAX / sizeof(CollectorBlock*) / GROWTH_FACTOR;
-        if (numBlocks > maxNumBlocks)
-            CRASH();
-        numBlocks = max(MIN_ARRAY_SIZE, numBlocks * GROWTH_FACTOR);
-        m_heap.numBlocks = numBlocks;
-        m_heap.blocks = static_cast<CollectorBlock**>(fastRealloc(m_heap.blocks, numBlocks * sizeof(CollectorBlock*)));
-    }
-    m_heap.blocks[m_heap.usedBlocks++] = block;
-
-    return block;
+    return reinterpret_cast<CollectorBlock*>(address);
 }
 
-NEVER_INLINE void Heap::freeBlock(size_t block)
+NEVER_INLINE void Heap::freeBlock(CollectorHeap& heap, size_t block)
 {
-    m_heap.didShrink = true;
+    m_didShrink = true;
 
-    ObjectIterator it(m_heap, block);
-    ObjectIterator end(m_heap, block + 1);
+    ObjectIterator it(heap, block);
+    ObjectIterator end(heap, block + 1);
 
 #if ENABLE(APOLLO_PROFILER)
     //duplicates the original iteration for maximum speed
@@ -306,15 +371,19 @@ NEVER_INLINE void Heap::freeBlock(size_t block)
         (*it)->~JSCell();
 #endif
 
-    freeBlockPtr(m_heap.blocks[block]);
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+    recycleBlock(heap.blocks[block]);
+#else
+    freeBlockPtr(heap.blocks[block]);
+#endif
 
     // swap with the last block so we compact as we go
-    m_heap.blocks[block] = m_heap.blocks[m_heap.usedBlocks - 1];
-    m_heap.usedBlocks--;
+    heap.blocks[block] = heap.blocks[heap.usedBlocks - 1];
+    heap.usedBlocks--;
 
-    if (m_heap.numBlocks > MIN_ARRAY_SIZE && m_heap.usedBlocks < m_heap.numBlocks / LOW_WATER_FACTOR) {
-        m_heap.numBlocks = m_heap.numBlocks / GROWTH_FACTOR; 
-        m_heap.blocks = static_cast<CollectorBlock**>(fastRealloc(m_heap.blocks, m_heap.numBlocks * sizeof(CollectorBlock*)));
+    if (heap.numBlocks > MIN_ARRAY_SIZE && heap.usedBlocks < heap.numBlocks / LOW_WATER_FACTOR) {
+        heap.numBlocks = heap.numBlocks / GROWTH_FACTOR; 
+        heap.blocks = static_cast<CollectorBlock**>(fastRealloc(heap.blocks, heap.numBlocks * sizeof(CollectorBlock*)));
     }
 }
 
@@ -339,6 +408,104 @@ NEVER_INLINE void Heap::freeBlockPtr(CollectorBlock* block)
 #endif
 }
 
+NEVER_INLINE void Heap::releaseExcessBlocks(CollectorHeap& heap)
+{
+    ASSERT(!heap.nextCell);
+    ASSERT(m_operationInProgress == NoOperation);
+
+    // freeBlock() moves the last block into the freed slot, so the allocator
+    // looks at the same index again.
+    while (heap.excessBlocks && heap.nextBlock < heap.usedBlocks) {
+        CollectorBlock* block = heap.blocks[heap.nextBlock];
+
+        // Clear the always-on last bit, so isEmpty() isn't fooled by it.
+        block->marked.clear(heap.sentinelAtom());
+        bool isEmpty = block->marked.isEmpty();
+        block->marked.set(heap.sentinelAtom());
+        if (!isEmpty)
+            return;
+
+        m_operationInProgress = Allocation;
+        freeBlock(heap, heap.nextBlock);
+        m_operationInProgress = NoOperation;
+        --heap.excessBlocks;
+    }
+}
+
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+
+// How long a freed block stays available for reuse before it is returned to the system.
+static const double blockFreeingDelay = 1.0;
+
+void Heap::recycleBlock(CollectorBlock* block)
+{
+    MutexLocker locker(m_recycledBlocksLock);
+    if (!m_blockFreeingThread)
+        m_blockFreeingThread = createThread(blockFreeingThreadStartFunc, this, "JavaScriptCore::BlockFree");
+    m_recycledBlocks.append(block);
+    if (m_recycledBlocks.size() == 1)
+        m_recycledBlocksCondition.signal();
+}
+
+CollectorBlock* Heap::takeRecycledBlock()
+{
+    MutexLocker locker(m_recycledBlocksLock);
+    if (m_recycledBlocks.isEmpty())
+        return 0;
+    CollectorBlock* block = m_recycledBlocks.last();
+    m_recycledBlocks.removeLast();
+    return block;
+}
+
+void* Heap::blockFreeingThreadStartFunc(void* heap)
+{
+    static_cast<Heap*>(heap)->blockFreeingThreadMain();
+    return 0;
+}
+
+void Heap::blockFreeingThreadMain()
+{
+    MutexLocker locker(m_recycledBlocksLock);
+    while (!m_blockFreeingThreadShouldExit) {
+        if (m_recycledBlocks.isEmpty()) {
+            m_recycledBlocksCondition.wait(m_recycledBlocksLock);
+            continue;
+        }
+
+        m_recycledBlocksCondition.timedWait(m_recycledBlocksLock, currentTime() + blockFreeingDelay);
+        if (m_blockFreeingThreadShouldExit)
+            break;
+
+        // Whatever the heap has not reused by now is returned to the system.
+        WTF::Vector<CollectorBlock*> blocks;
+        blocks.swap(m_recycledBlocks);
+        m_recycledBlocksLock.unlock();
+        for (size_t i = 0; i < blocks.size(); ++i)
+            freeBlockPtr(blocks[i]);
+        m_recycledBlocksLock.lock();
+    }
+}
+
+void Heap::stopBlockFreeingThread()
+{
+    ThreadIdentifier thread;
+    {
+        MutexLocker locker(m_recycledBlocksLock);
+        m_blockFreeingThreadShouldExit = true;
+        m_recycledBlocksCondition.signal();
+        thread = m_blockFreeingThread;
+        m_blockFreeingThread = 0;
+    }
+    if (thread)
+        waitForThreadCompletion(thread, 0);
+
+    for (size_t i = 0; i < m_recycledBlocks.size(); ++i)
+        freeBlockPtr(m_recycledBlocks[i]);
+    m_recycledBlocks.clear();
+}
+
+#endif
+
 void Heap::freeBlocks()
 {
     ProtectCountSet protectedValuesCopy = m_protectedValues;
@@ -348,36 +515,39 @@ void Heap::freeBlocks()
     for (ProtectCountSet::iterator it = protectedValuesCopy.begin(); it != protectedValuesEnd; ++it)
         markCell(it->first);
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
-    DeadObjectIterator end(m_heap, m_heap.usedBlocks);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        heap.nextCell = 0;
+        heap.nextBlock = 0;
+        DeadObjectIterator it(heap, heap.nextBlock, heap.nextCell);
+        DeadObjectIterator end(heap, heap.usedBlocks);
 
 #if ENABLE(APOLLO_PROFILER)
-    //duplicates the original iteration for maximum speed
-    if (UNLIKELY(SamplerApollo::enabled()))
-    {
-        SamplerApollo* sampler = *SamplerApollo::enabledSamplerReference();
-
-        for ( ; it != end; ++it)
+        //duplicates the original iteration for maximum speed
+        if (UNLIKELY(SamplerApollo::enabled()))
         {
-            if (!(*it)->isNumber())
-            {  
-                //this also happens for dummy cells - having no real corespondent
-                //we should be fine since such cells should not be found in sampler's livenodes list
+            SamplerApollo* sampler = *SamplerApollo::enabledSamplerReference();
 
-                sampler->unregisterNodeHelper((void*)*it);
+            for ( ; it != end; ++it)
+            {
+                if (!(*it)->isNumber())
+                {  
+                    //this also happens for dummy cells - having no real corespondent
+                    //we should be fine since such cells should not be found in sampler's livenodes list
+
+                    sampler->unregisterNodeHelper((void*)*it);
+                }
+                (*it)->~JSCell();
             }
-            (*it)->~JSCell();
         }
-    }
-    else
-    for ( ; it != end; ++it)
-        (*it)->~JSCell();
+        else
+        for ( ; it != end; ++it)
+            (*it)->~JSCell();
 #else
-    for ( ; it != end; ++it)
-        (*it)->~JSCell();
+        for ( ; it != end; ++it)
+            (*it)->~JSCell();
 #endif
+    }
 
     ASSERT(!protectedObjectCount());
 
@@ -409,12 +579,19 @@ void Heap::freeBlocks()
         it->first->~JSCell();
 #endif
 
-    for (size_t block = 0; block < m_heap.usedBlocks; ++block)
-        freeBlockPtr(m_heap.blocks[block]);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t block = 0; block < heap.usedBlocks; ++block)
+            freeBlockPtr(heap.blocks[block]);
 
-    fastFree(m_heap.blocks);
+        fastFree(heap.blocks);
 
-    memset(&m_heap, 0, sizeof(CollectorHeap));
+        heap.blocks = 0;
+        heap.numBlocks = 0;
+        heap.usedBlocks = 0;
+        heap.excessBlocks = 0;
+        heap.allocatedCells = 0;
+    }
 }
 
 void Heap::recordExtraCost(size_t cost)
@@ -430,15 +607,15 @@ void Heap::recordExtraCost(size_t cost)
     // if a large value survives one garbage collection, there is not much point to
     // collecting more frequently as long as it stays alive.
 
-    if (m_heap.extraCost > maxExtraCost && m_heap.extraCost > m_heap.usedBlocks * BLOCK_SIZE / 2) {
+    if (m_extraCost > maxExtraCost && m_extraCost > usedBlocks() * BLOCK_SIZE / 2) {
         // If the last iteration through the heap deallocated blocks, we need
         // to clean up remaining garbage before marking. Otherwise, the conservative
         // marking mechanism might follow a pointer to unmapped memory.
-        if (m_heap.didShrink)
+        if (m_didShrink)
             sweep();
         reset();
     }
-    m_heap.extraCost += cost;
+    m_extraCost += cost;
 }
 
 #if ENABLE(APOLLO_PROFILER)
@@ -477,15 +654,18 @@ void Heap::samplerUnregisterAllJSCell()
         SamplerApollo* sampler = *SamplerApollo::enabledSamplerReference();
 
         // iterate all over the jscells in the heap and unregister only those that are not numbers
-        DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
-        DeadObjectIterator end(m_heap, m_heap.usedBlocks);
-        for ( ; it != end; ++it) {
-            JSCell* cell = *it;
+        for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+            CollectorHeap& heap = m_heaps[sizeClass];
+            DeadObjectIterator it(heap, heap.nextBlock, heap.nextCell);
+            DeadObjectIterator end(heap, heap.usedBlocks);
+            for ( ; it != end; ++it) {
+                JSCell* cell = *it;
 #if USE(JSVALUE32)
-            if (cell->isNumber())
-                continue;
+                if (cell->isNumber())
+                    continue;
 #endif
-            sampler->unregisterNodeHelper((void*)cell);
+                sampler->unregisterNodeHelper((void*)cell);
+            }
         }
     }
 }
@@ -494,37 +674,43 @@ void Heap::samplerUnregisterAllJSCell()
 
 #if ENABLE(APOLLO_PROFILER)
 void* Heap::allocate(size_t s, bool isNumber)
-#else
+#elif PLATFORM(APOLLO)
 void* Heap::allocate(size_t s, bool)
+#else
+void* Heap::allocate(size_t s)
 #endif
 {
-    typedef HeapConstants::Block Block;
-    typedef HeapConstants::Cell Cell;
-    
     ASSERT(JSLock::lockCount() > 0);
     ASSERT(JSLock::currentThreadIsHoldingLock());
-    ASSERT_UNUSED(s, s <= HeapConstants::cellSize);
+    ASSERT(s <= CELL_SIZE);
 
-    ASSERT(m_heap.operationInProgress == NoOperation);
+    ASSERT(m_operationInProgress == NoOperation);
 
 #if COLLECT_ON_EVERY_ALLOCATION
     collectAllGarbage();
-    ASSERT(m_heap.operationInProgress == NoOperation);
+    ASSERT(m_operationInProgress == NoOperation);
 #endif
 
+    CollectorHeap& heap = m_heaps[sizeClassFor(s)];
+
 allocate:
 
     // Fast case: find the next garbage cell and recycle it.
 
-    do {
-        ASSERT(m_heap.nextBlock < m_heap.usedBlocks);
-        Block* block = reinterpret_cast<Block*>(m_heap.blocks[m_heap.nextBlock]);
+    while (heap.nextBlock != heap.usedBlocks) {
+        if (UNLIKELY(heap.excessBlocks) && !heap.nextCell) {
+            releaseExcessBlocks(heap);
+            if (heap.nextBlock == heap.usedBlocks)
+                break;
+        }
+
+        CollectorBlock* block = heap.blocks[heap.nextBlock];
         do {
-            ASSERT(m_heap.nextCell < HeapConstants::cellsPerBlock);
-            if (!block->marked.get(m_heap.nextCell)) { // Always false for the last cell in the block
-                Cell* cell = block->cells + m_heap.nextCell;
+            ASSERT(heap.nextCell < heap.cellsPerBlock);
+            if (!block->marked.get(heap.nextCell * heap.atomsPerCell)) { // Always false for the last cell in the block
+                CollectorAtom* cell = block->atoms + heap.nextCell * heap.atomsPerCell;
 
-                m_heap.operationInProgress = Allocation;
+                m_operationInProgress = Allocation;
                 JSCell* imp = reinterpret_cast<JSCell*>(cell);
 
 #if ENABLE(APOLLO_PROFILER)
@@ -538,8 +724,12 @@ allocate:
                     }
 #endif
                 imp->~JSCell();
-                m_heap.operationInProgress = NoOperation;
-                ++m_heap.nextCell;
+                m_operationInProgress = NoOperation;
+                ++heap.nextCell;
+                ++heap.allocatedCells;
+
+                if (UNLIKELY(m_allocationSiteSampler != 0))
+                    m_allocationSiteSampler->didAllocate(imp);
 
 #if ENABLE(APOLLO_PROFILER)
                 if (!isNumber)
@@ -547,58 +737,90 @@ allocate:
 #endif
                 return cell;
             }
-        } while (++m_heap.nextCell != HeapConstants::cellsPerBlock);
-        m_heap.nextCell = 0;
-    } while (++m_heap.nextBlock != m_heap.usedBlocks);
+        } while (++heap.nextCell != heap.cellsPerBlock);
+        heap.nextCell = 0;
+        ++heap.nextBlock;
+    }
 
-    // Slow case: reached the end of the heap. Mark live objects and start over.
+    // Slow case: reached the end of the size class. Give it another block while
+    // the heap is within its allocation budget, otherwise mark live objects and
+    // start over.
 
-    reset();
+    if (allocatedBytes() < m_allocationBudget) {
+        heap.excessBlocks = 0;
+        allocateBlock(heap);
+    } else
+        reset();
     goto allocate;
 }
 
-void Heap::resizeBlocks()
+size_t Heap::allocatedBytes() const
 {
-    m_heap.didShrink = false;
-
-    size_t usedCellCount = markedCells();
-    size_t minCellCount = usedCellCount + max(ALLOCATIONS_PER_COLLECTION, usedCellCount);
-    size_t minBlockCount = (minCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
-
-    size_t maxCellCount = 1.25f * minCellCount;
-    size_t maxBlockCount = (maxCellCount + HeapConstants::cellsPerBlock - 1) / HeapConstants::cellsPerBlock;
+    size_t result = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        result += m_heaps[sizeClass].allocatedCells * m_heaps[sizeClass].cellSize;
+    return result;
+}
 
-    if (m_heap.usedBlocks < minBlockCount)
-        growBlocks(minBlockCount);
-    else if (m_heap.usedBlocks > maxBlockCount)
-        shrinkBlocks(maxBlockCount);
+void Heap::resizeBlocks()
+{
+    m_didShrink = false;
+
+    size_t liveBytes = 0;
+    size_t allocatedBytes = this->allocatedBytes();
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        liveBytes += markedCells(m_heaps[sizeClass]) * m_heaps[sizeClass].cellSize;
+    m_allocationBudget = max(ALLOCATIONS_PER_COLLECTION * CELL_SIZE, liveBytes);
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        heap.excessBlocks = 0;
+
+        // Each size class gets the part of the budget it allocated last time.
+        size_t usedCellCount = markedCells(heap);
+        size_t minCellCount = usedCellCount;
+        if (allocatedBytes)
+            minCellCount += static_cast<size_t>(static_cast<double>(m_allocationBudget) * heap.allocatedCells / allocatedBytes);
+        heap.allocatedCells = 0;
+        size_t minBlockCount = (minCellCount + heap.cellsPerBlock - 1) / heap.cellsPerBlock;
+
+        size_t maxCellCount = 1.25f * minCellCount;
+        size_t maxBlockCount = (maxCellCount + heap.cellsPerBlock - 1) / heap.cellsPerBlock;
+
+        // Sweeping empty blocks and returning them to the system is left to the
+        // allocator, so that it is not part of the collection pause.
+        if (heap.usedBlocks < minBlockCount)
+            growBlocks(heap, minBlockCount);
+        else if (heap.usedBlocks > maxBlockCount)
+            heap.excessBlocks = heap.usedBlocks - maxBlockCount;
+    }
 }
 
-void Heap::growBlocks(size_t neededBlocks)
+void Heap::growBlocks(CollectorHeap& heap, size_t neededBlocks)
 {
-    ASSERT(m_heap.usedBlocks < neededBlocks);
-    while (m_heap.usedBlocks < neededBlocks)
-        allocateBlock();
+    ASSERT(heap.usedBlocks < neededBlocks);
+    while (heap.usedBlocks < neededBlocks)
+        allocateBlock(heap);
 }
 
-void Heap::shrinkBlocks(size_t neededBlocks)
+void Heap::shrinkBlocks(CollectorHeap& heap, size_t neededBlocks)
 {
-    ASSERT(m_heap.usedBlocks > neededBlocks);
+    ASSERT(heap.usedBlocks > neededBlocks);
     
     // Clear the always-on last bit, so isEmpty() isn't fooled by it.
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        m_heap.blocks[i]->marked.clear(HeapConstants::cellsPerBlock - 1);
+    for (size_t i = 0; i < heap.usedBlocks; ++i)
+        heap.blocks[i]->marked.clear(heap.sentinelAtom());
 
-    for (size_t i = 0; i != m_heap.usedBlocks && m_heap.usedBlocks != neededBlocks; ) {
-        if (m_heap.blocks[i]->marked.isEmpty()) {
-            freeBlock(i);
+    for (size_t i = 0; i != heap.usedBlocks && heap.usedBlocks != neededBlocks; ) {
+        if (heap.blocks[i]->marked.isEmpty()) {
+            freeBlock(heap, i);
         } else
             ++i;
     }
 
     // Reset the always-on last bit.
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        m_heap.blocks[i]->marked.set(HeapConstants::cellsPerBlock - 1);
+    for (size_t i = 0; i < heap.usedBlocks; ++i)
+        heap.blocks[i]->marked.set(heap.sentinelAtom());
 }
 
 #if OS(WINCE)
@@ -851,32 +1073,60 @@ inline bool isPointerAligned(void* p)
     return (((intptr_t)(p) & (sizeof(char*) - 1)) == 0);
 }
 
-// Cell size needs to be a power of two for isPossibleCell to be valid.
-COMPILE_ASSERT(sizeof(CollectorCell) % 2 == 0, Collector_cell_size_is_power_of_two);
+// Atom size needs to be a power of two for isPossibleCell to be valid.
+COMPILE_ASSERT(!(sizeof(CollectorAtom) & (sizeof(CollectorAtom) - 1)), Collector_atom_size_is_power_of_two);
+COMPILE_ASSERT(sizeof(CollectorBlock) <= BLOCK_SIZE, CollectorBlock_fits_in_block);
 
-#if USE(JSVALUE32)
-static bool isHalfCellAligned(void *p)
+static inline bool isAtomAligned(void *p)
 {
-    return (((intptr_t)(p) & (CELL_MASK >> 1)) == 0);
+    return (((intptr_t)(p) & (CELL_ATOM_SIZE - 1)) == 0);
 }
 
 static inline bool isPossibleCell(void* p)
 {
-    return isHalfCellAligned(p) && p;
+    return isAtomAligned(p) && p;
 }
 
-#else
-
-static inline bool isCellAligned(void *p)
+inline JSCell* Heap::cellForConservativePointer(void* p)
 {
-    return (((intptr_t)(p) & CELL_MASK) == 0);
+    if (!isPossibleCell(p))
+        return 0;
+
+    uintptr_t xAsBits = reinterpret_cast<uintptr_t>(p);
+    uintptr_t offset = xAsBits & BLOCK_OFFSET_MASK;
+    size_t atom = offset / CELL_ATOM_SIZE;
+    if (atom >= ATOMS_PER_BLOCK)
+        return 0;
+
+    CollectorBlock* blockAddr = reinterpret_cast<CollectorBlock*>(xAsBits - offset);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        // Only the start of a cell is a possible pointer to it.
+        if (atom % heap.atomsPerCell || atom > heap.sentinelAtom())
+            continue;
+
+        CollectorBlock** blocks = heap.blocks;
+        size_t usedBlocks = heap.usedBlocks;
+        for (size_t block = 0; block < usedBlocks; block++) {
+            if (blocks[block] == blockAddr)
+                return reinterpret_cast<JSCell*>(xAsBits);
+        }
+    }
+    return 0;
 }
 
-static inline bool isPossibleCell(void* p)
+inline void Heap::markConservativeRoot(MarkStack& markStack, JSCell* cell)
 {
-    return isCellAligned(p) && p;
+    if (m_generationalCollectionEnabled) {
+        // The cell may be under construction, still to receive references
+        // that are stored without a barrier, so trace it again next time.
+        if (m_isMinorCollection && isCellMarked(cell))
+            markStack.appendChildren(cell);
+        markStack.remember(cell);
+    }
+    markStack.append(cell);
+    markStack.drain();
 }
-#endif // USE(JSVALUE32)
 
 void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
 {
@@ -893,37 +1143,88 @@ void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
     char** p = static_cast<char**>(start);
     char** e = static_cast<char**>(end);
 
-    CollectorBlock** blocks = m_heap.blocks;
     while (p != e) {
-        char* x = *p++;
-        if (isPossibleCell(x)) {
-            size_t usedBlocks;
-            uintptr_t xAsBits = reinterpret_cast<uintptr_t>(x);
-            xAsBits &= CELL_ALIGN_MASK;
-
-            uintptr_t offset = xAsBits & BLOCK_OFFSET_MASK;
-            const size_t lastCellOffset = sizeof(CollectorCell) * (CELLS_PER_BLOCK - 1);
-            if (offset > lastCellOffset)
-                continue;
-
-            CollectorBlock* blockAddr = reinterpret_cast<CollectorBlock*>(xAsBits - offset);
-            usedBlocks = m_heap.usedBlocks;
-            for (size_t block = 0; block < usedBlocks; block++) {
-                if (blocks[block] != blockAddr)
-                    continue;
-                markStack.append(reinterpret_cast<JSCell*>(xAsBits));
-                markStack.drain();
-            }
+        if (JSCell* cell = cellForConservativePointer(*p++))
+            markConservativeRoot(markStack, cell);
+    }
+}
+
+void Heap::markStackConservatively(MarkStack& markStack, ConservativeRootCache& cache, void* stackPointer, void* stackBase, bool mayAllocate)
+{
+    typedef ConservativeRootCache::Root Root;
+
+    void** top = static_cast<void**>(stackPointer);
+    void** base = static_cast<void**>(stackBase);
+    ASSERT(top <= base);
+    ASSERT(isPointerAligned(top));
+    ASSERT(isPointerAligned(base));
+
+    WTF::Vector<void*>& contents = cache.m_stackContents;
+    WTF::Vector<Root>& roots = cache.m_roots;
+
+    // The cells of a cache that missed a scan may have been collected since.
+    void** unchanged = base;
+    size_t rootCount = 0;
+    if (cache.m_stackBase == stackBase && cache.m_scanNumber + 1 == m_conservativeScanNumber) {
+        void** limit = max(top, base - contents.size());
+        void** cached = contents.end();
+        while (unchanged != limit && unchanged[-1] == cached[-1]) {
+            --unchanged;
+            --cached;
         }
+        for (; rootCount < roots.size() && roots[rootCount].location >= unchanged; ++rootCount)
+            markConservativeRoot(markStack, roots[rootCount].cell);
+    }
+    roots.shrink(rootCount);
+
+    m_collectionStatistics.stackWordsSearched += unchanged - top;
+    m_collectionStatistics.stackWordsReused += base - unchanged;
+
+    // A thread that is suspended may hold the malloc lock, so unless allocation
+    // is allowed, the cache is only filled in as far as it has room.
+    bool isComplete = true;
+    for (void** p = unchanged; p != top; ) {
+        --p;
+        JSCell* cell = cellForConservativePointer(*p);
+        if (!cell)
+            continue;
+        markConservativeRoot(markStack, cell);
+        ++rootCount;
+        if (mayAllocate || roots.size() < roots.capacity()) {
+            Root root = { p, cell };
+            roots.append(root);
+        } else
+            isComplete = false;
+    }
+
+    size_t stackSize = base - top;
+    if (isComplete && (mayAllocate || contents.capacity() >= stackSize)) {
+        contents.shrink(0);
+        contents.append(top, stackSize);
+        cache.m_stackBase = stackBase;
+        cache.m_scanNumber = m_conservativeScanNumber;
+    } else {
+        cache.m_stackBase = 0;
+        cache.m_requiredStackCapacity = stackSize;
+        cache.m_requiredRootCapacity = rootCount;
     }
 }
 
+void ConservativeRootCache::reserveRequiredCapacity()
+{
+    // Leave room for the stack to grow a little.
+    if (m_stackContents.capacity() < m_requiredStackCapacity)
+        m_stackContents.reserveCapacity(m_requiredStackCapacity + m_requiredStackCapacity / 4);
+    if (m_roots.capacity() < m_requiredRootCapacity)
+        m_roots.reserveCapacity(m_requiredRootCapacity + m_requiredRootCapacity / 4);
+}
+
 void NEVER_INLINE Heap::markCurrentThreadConservativelyInternal(MarkStack& markStack)
 {
     void* dummy;
     void* stackPointer = &dummy;
     void* stackBase = currentThreadStackBase();
-    markConservatively(markStack, stackPointer, stackBase);
+    markStackConservatively(markStack, m_currentThreadRoots, stackPointer, stackBase, true);
 }
 
 #if COMPILER(GCC)
@@ -1088,7 +1389,7 @@ void Heap::markOtherThreadConservatively(MarkStack& markStack, Thread* thread)
     markConservatively(markStack, static_cast<void*>(&regs), static_cast<void*>(reinterpret_cast<char*>(&regs) + regSize));
 
     void* stackPointer = otherThreadStackPointer(regs);
-    markConservatively(markStack, stackPointer, thread->stackBase);
+    markStackConservatively(markStack, thread->roots, stackPointer, thread->stackBase, false);
 
     resumeThread(thread->platformThread);
 }
@@ -1097,6 +1398,7 @@ void Heap::markOtherThreadConservatively(MarkStack& markStack, Thread* thread)
 
 void Heap::markStackObjectsConservatively(MarkStack& markStack)
 {
+    ++m_conservativeScanNumber;
     markCurrentThreadConservatively(markStack);
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
@@ -1120,6 +1422,8 @@ void Heap::markStackObjectsConservatively(MarkStack& markStack)
 #ifndef NDEBUG
         fastMallocAllow();
 #endif
+        for (Thread* thread = m_registeredThreads; thread; thread = thread->next)
+            thread->roots.reserveRequiredCapacity();
     }
 #endif
 }
@@ -1184,39 +1488,64 @@ void Heap::markTempSortVectors(MarkStack& markStack)
     
 void Heap::clearMarkBits()
 {
-    for (size_t i = 0; i < m_heap.usedBlocks; ++i)
-        clearMarkBits(m_heap.blocks[i]);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i)
+            clearMarkBits(heap, heap.blocks[i]);
+    }
 }
 
-void Heap::clearMarkBits(CollectorBlock* block)
+void Heap::clearMarkBits(const CollectorHeap& heap, CollectorBlock* block)
 {
     // allocate assumes that the last cell in every block is marked.
     block->marked.clearAll();
-    block->marked.set(HeapConstants::cellsPerBlock - 1);
+    block->marked.set(heap.sentinelAtom());
 }
 
-size_t Heap::markedCells(size_t startBlock, size_t startCell) const
+void Heap::clearCards()
 {
-    ASSERT(startBlock <= m_heap.usedBlocks);
-    ASSERT(startCell < HeapConstants::cellsPerBlock);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i)
+            clearCards(heap.blocks[i]);
+    }
+}
+
+void Heap::clearCards(CollectorBlock* block)
+{
+    memset(block->cards, 0, sizeof(block->cards));
+}
 
-    if (startBlock >= m_heap.usedBlocks)
+size_t Heap::markedCells() const
+{
+    size_t result = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        result += markedCells(m_heaps[sizeClass]);
+    return result;
+}
+
+size_t Heap::markedCells(const CollectorHeap& heap, size_t startBlock, size_t startCell) const
+{
+    ASSERT(startBlock <= heap.usedBlocks);
+    ASSERT(startCell < heap.cellsPerBlock);
+
+    if (startBlock >= heap.usedBlocks)
         return 0;
 
     size_t result = 0;
-    result += m_heap.blocks[startBlock]->marked.count(startCell);
-    for (size_t i = startBlock + 1; i < m_heap.usedBlocks; ++i)
-        result += m_heap.blocks[i]->marked.count();
+    result += heap.blocks[startBlock]->marked.count(startCell * heap.atomsPerCell);
+    for (size_t i = startBlock + 1; i < heap.usedBlocks; ++i)
+        result += heap.blocks[i]->marked.count();
 
     return result;
 }
 
 void Heap::sweep()
 {
-    ASSERT(m_heap.operationInProgress == NoOperation);
-    if (m_heap.operationInProgress != NoOperation)
+    ASSERT(m_operationInProgress == NoOperation);
+    if (m_operationInProgress != NoOperation)
         CRASH();
-    m_heap.operationInProgress = Collection;
+    m_operationInProgress = Collection;
     
 #if !ENABLE(JSC_ZOMBIES)
     Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
@@ -1226,43 +1555,134 @@ void Heap::sweep()
     const bool apolloProfilerEnabled = SamplerApollo::enabled();
 #endif
 
-    DeadObjectIterator it(m_heap, m_heap.nextBlock, m_heap.nextCell);
-    DeadObjectIterator end(m_heap, m_heap.usedBlocks);
-    for ( ; it != end; ++it) {
-        JSCell* cell = *it;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        DeadObjectIterator it(heap, heap.nextBlock, heap.nextCell);
+        DeadObjectIterator end(heap, heap.usedBlocks);
+        for ( ; it != end; ++it) {
+            JSCell* cell = *it;
 
 #if ENABLE(APOLLO_PROFILER)
-        if (UNLIKELY(apolloProfilerEnabled))
-        {
-            if (!cell->isNumber())
-            {  
-                //this also happens for dummy cells - having no real corespondent
-                //we should be fine since such cells should not be found in sampler's livenodes list
-
-                (*SamplerApollo::enabledSamplerReference())->unregisterNodeHelper((void*)cell);
+            if (UNLIKELY(apolloProfilerEnabled))
+            {
+                if (!cell->isNumber())
+                {  
+                    //this also happens for dummy cells - having no real corespondent
+                    //we should be fine since such cells should not be found in sampler's livenodes list
+
+                    (*SamplerApollo::enabledSamplerReference())->unregisterNodeHelper((void*)cell);
+                }
             }
-        }
 #endif
 
 #if ENABLE(JSC_ZOMBIES)
-        if (!cell->isZombie()) {
-            const ClassInfo* info = cell->classInfo();
-            cell->~JSCell();
-            new (cell) JSZombie(info, JSZombie::leakedZombieStructure());
-            Heap::markCell(cell);
-        }
+            if (!cell->isZombie()) {
+                const ClassInfo* info = cell->classInfo();
+                cell->~JSCell();
+                new (cell) JSZombie(info, JSZombie::leakedZombieStructure());
+                Heap::markCell(cell);
+            }
 #else
-        cell->~JSCell();
-        // Callers of sweep assume it's safe to mark any cell in the heap.
-        new (cell) JSCell(dummyMarkableCellStructure);
+            cell->~JSCell();
+            // Callers of sweep assume it's safe to mark any cell in the heap.
+            new (cell) JSCell(dummyMarkableCellStructure);
 		
 #endif
+        }
     }
 
-    m_heap.operationInProgress = NoOperation;
+    m_operationInProgress = NoOperation;
 }
 
-void Heap::markRoots()
+void Heap::markRememberedCells(MarkStack& markStack)
+{
+    // Old cells in dirty cards may hold the only reference to a cell allocated
+    // since the last collection.
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        for (size_t i = 0; i < heap.usedBlocks; ++i) {
+            CollectorBlock* block = heap.blocks[i];
+            for (size_t card = 0; card < CARDS_PER_BLOCK; ++card) {
+                if (!block->cards[card])
+                    continue;
+                block->cards[card] = 0;
+
+                // A card holds the cells that start in it.
+                size_t startCell = (card * CARD_SIZE + heap.cellSize - 1) / heap.cellSize;
+                size_t endCell = std::min(((card + 1) * CARD_SIZE + heap.cellSize - 1) / heap.cellSize, heap.cellsPerBlock - 1);
+                for (size_t cell = startCell; cell < endCell; ++cell) {
+                    if (heap.isMarked(i, cell))
+                        markStack.appendChildren(heap.cell(i, cell));
+                }
+            }
+            markStack.drain();
+        }
+    }
+
+    // Tracing the remembered cells records them again, along with any other
+    // unbarriered cell reached for the first time.
+    Vector<JSCell*> rememberedCells;
+    rememberedCells.swap(m_rememberedCells);
+    size_t size = rememberedCells.size();
+    for (size_t i = 0; i < size; ++i) {
+        markStack.appendChildren(rememberedCells[i]);
+        markStack.drain();
+    }
+
+    size = m_compiledFunctions.size();
+    for (size_t i = 0; i < size; ++i)
+        m_compiledFunctions[i]->markAggregate(markStack);
+    markStack.drain();
+}
+
+#if ENABLE(PARALLEL_GC)
+void Heap::setMarkingHelperThreadCount(unsigned count)
+{
+    ASSERT(!isBusy());
+    if (count == markingHelperThreadCount())
+        return;
+    m_parallelMarker.set(count ? new ParallelMarker(JSGlobalData::jsArrayVPtr, count) : 0);
+}
+
+unsigned Heap::markingHelperThreadCount() const
+{
+    return m_parallelMarker ? m_parallelMarker->helperThreadCount() : 0;
+}
+#endif
+
+void Heap::setAllocationSiteSamplingInterval(unsigned interval)
+{
+    ASSERT(!isBusy());
+    m_allocationSiteSampler.set(interval ? new AllocationSiteSampler(interval) : 0);
+}
+
+void Heap::setAllocationSite(ExecState* callFrame, void* pc)
+{
+    m_allocationSiteSampler->setCurrentInstruction(callFrame, pc);
+}
+
+void Heap::setAllocationSite(ExecState* callFrame)
+{
+    m_allocationSiteSampler->setCurrentFrame(callFrame);
+}
+
+bool Heap::hasBarrieredChildren(JSCell* cell)
+{
+    // Classes that override markChildren, and store every reference through a
+    // write barrier. The match is exact, since a subclass may add fields.
+    const ClassInfo* info = cell->classInfo();
+    return !info
+        || info == &JSFunction::info
+        || info == &JSActivation::info
+        || info == &Arguments::info
+        || info == &JSArray::info
+        || info == &BooleanObject::info
+        || info == &NumberObject::info
+        || info == &StringObject::info
+        || info == &DateInstance::info;
+}
+
+void Heap::markRoots(CollectionType type)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance()) {
@@ -1271,16 +1691,32 @@ void Heap::markRoots()
     }
 #endif
 
-    ASSERT(m_heap.operationInProgress == NoOperation);
-    if (m_heap.operationInProgress != NoOperation)
+    ASSERT(m_operationInProgress == NoOperation);
+    if (m_operationInProgress != NoOperation)
         CRASH();
 
-    m_heap.operationInProgress = Collection;
+    m_operationInProgress = Collection;
 
+    double startTime = currentTime();
     MarkStack& markStack = m_globalData->markStack;
+#if ENABLE(PARALLEL_GC)
+    markStack.setParallelMarker(m_parallelMarker.get());
+#endif
 
-    // Reset mark bits.
-    clearMarkBits();
+    m_isMinorCollection = type == MinorCollection;
+    if (m_generationalCollectionEnabled)
+        markStack.setRememberedCells(&m_rememberedCells);
+
+    if (m_isMinorCollection) {
+        // Cells that survived an earlier collection keep their mark bits, so only
+        // cells allocated since then are traced.
+        markRememberedCells(markStack);
+    } else {
+        // Reset mark bits.
+        clearMarkBits();
+        clearCards();
+        m_rememberedCells.clear();
+    }
 
     // Mark stack roots.
     markStackObjectsConservatively(markStack);
@@ -1308,22 +1744,49 @@ void Heap::markRoots()
 
     markStack.drain();
     markStack.compact();
+    markStack.setRememberedCells(0);
+#if ENABLE(PARALLEL_GC)
+    markStack.setParallelMarker(0);
+    if (m_parallelMarker)
+        m_parallelMarker->compact();
+#endif
 
-    m_heap.operationInProgress = NoOperation;
+    m_collectionStatistics.markTime += currentTime() - startTime;
+
+    m_operationInProgress = NoOperation;
 }
 
 size_t Heap::objectCount() const
 {
-    return m_heap.nextBlock * HeapConstants::cellsPerBlock // allocated full blocks
-           + m_heap.nextCell // allocated cells in current block
-           + markedCells(m_heap.nextBlock, m_heap.nextCell) // marked cells in remainder of m_heap
-           - m_heap.usedBlocks; // 1 cell per block is a dummy sentinel
+    size_t result = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        result += objectCount(m_heaps[sizeClass]);
+    return result;
+}
+
+size_t Heap::objectCount(const CollectorHeap& heap) const
+{
+    return heap.nextBlock * heap.cellsPerBlock // allocated full blocks
+           + heap.nextCell // allocated cells in current block
+           + markedCells(heap, heap.nextBlock, heap.nextCell) // marked cells in remainder of heap
+           - heap.usedBlocks; // 1 cell per block is a dummy sentinel
+}
+
+size_t Heap::usedBlocks() const
+{
+    size_t result = 0;
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        result += m_heaps[sizeClass].usedBlocks;
+    return result;
 }
 
 void Heap::addToStatistics(Heap::Statistics& statistics) const
 {
-    statistics.size += m_heap.usedBlocks * BLOCK_SIZE;
-    statistics.free += m_heap.usedBlocks * BLOCK_SIZE - (objectCount() * HeapConstants::cellSize);
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        const CollectorHeap& heap = m_heaps[sizeClass];
+        statistics.size += heap.usedBlocks * BLOCK_SIZE;
+        statistics.free += heap.usedBlocks * BLOCK_SIZE - (objectCount(heap) * heap.cellSize);
+    }
 }
 
 Heap::Statistics Heap::statistics() const
@@ -1366,7 +1829,7 @@ size_t Heap::protectedObjectCount()
     return m_protectedValues.size();
 }
 
-static const char* typeName(JSCell* cell)
+const char* Heap::typeName(JSCell* cell)
 {
     if (cell->isString())
         return "string";
@@ -1411,26 +1874,164 @@ HashCountedSet<const char*>* Heap::objectTypeCounts()
 
 bool Heap::isBusy()
 {
-    return m_heap.operationInProgress != NoOperation;
+    return m_operationInProgress != NoOperation;
+}
+
+void Heap::setGenerationalCollectionEnabled(bool enabled)
+{
+    // JIT code compiled before this point has no write barriers.
+    ASSERT(!m_globalData->head);
+    m_generationalCollectionEnabled = enabled;
+}
+
+void Heap::didCompileFunction(FunctionExecutable* executable)
+{
+    if (!m_generationalCollectionEnabled)
+        return;
+    if (!m_compiledFunctions.isEmpty() && m_compiledFunctions.last() == executable)
+        return;
+    m_compiledFunctions.append(executable);
+}
+
+#if ENABLE(CODE_FLUSHING)
+static void removeCodeBlocks(HashSet<CodeBlock*>& codeBlocks, void** begin, void** end)
+{
+    for (void** p = begin; p != end; ++p) {
+        CodeBlock* codeBlock = static_cast<CodeBlock*>(*p);
+        if (codeBlock && codeBlock != reinterpret_cast<CodeBlock*>(-1))
+            codeBlocks.remove(codeBlock);
+    }
+}
+
+// Call frames in the register file say which code blocks are running. The machine
+// stack, and the registers the caller saved on it, may refer to a code block that
+// is about to get a call frame.
+static NEVER_INLINE void removeCodeBlocksInUse(HashSet<CodeBlock*>& codeBlocks, RegisterFile& registerFile)
+{
+    removeCodeBlocks(codeBlocks, reinterpret_cast<void**>(registerFile.start()), reinterpret_cast<void**>(registerFile.end()));
+    void* dummy;
+    removeCodeBlocks(codeBlocks, &dummy, static_cast<void**>(currentThreadStackBase()));
+}
+
+void Heap::didGenerateFunctionCode(FunctionExecutable* executable)
+{
+    if (m_codeFlushingAge)
+        m_functionsWithCode.add(executable);
+}
+
+void Heap::flushColdFunctionCode()
+{
+    typedef HashSet<RefPtr<FunctionExecutable> >::iterator Iterator;
+
+    Vector<RefPtr<FunctionExecutable> > coldFunctions;
+    Vector<FunctionExecutable*> unusedFunctions;
+    HashSet<CodeBlock*> coldCodeBlocks;
+    Iterator end = m_functionsWithCode.end();
+    for (Iterator it = m_functionsWithCode.begin(); it != end; ++it) {
+        FunctionExecutable* executable = it->get();
+        if (!m_codeFlushingAge || !executable->isGenerated() || executable->hasOneRef()) {
+            unusedFunctions.append(executable);
+            continue;
+        }
+        CodeBlock& codeBlock = executable->generatedBytecode();
+        if (++codeBlock.m_collectionsSinceLastCall < m_codeFlushingAge)
+            continue;
+        coldFunctions.append(executable);
+        coldCodeBlocks.add(&codeBlock);
+    }
+    // Dropping the last reference may free other functions, so nothing is removed while iterating.
+    for (size_t i = 0; i < unusedFunctions.size(); ++i)
+        m_functionsWithCode.remove(unusedFunctions[i]);
+    if (coldCodeBlocks.isEmpty())
+        return;
+
+    // A function can go uncalled for a long time and still be running, in a long loop
+    // or below a call that does not return.
+    jmp_buf registers REGISTER_BUFFER_ALIGNMENT;
+#if COMPILER(MSVC)
+#pragma warning(push)
+#pragma warning(disable: 4611)
+#endif
+    setjmp(registers);
+#if COMPILER(MSVC)
+#pragma warning(pop)
+#endif
+    removeCodeBlocksInUse(coldCodeBlocks, m_globalData->interpreter->registerFile());
+    if (coldCodeBlocks.isEmpty())
+        return;
+
+    size_t bytesFlushed = 0;
+    size_t functionsFlushed = 0;
+    for (size_t i = 0; i < coldFunctions.size(); ++i) {
+        FunctionExecutable* executable = coldFunctions[i].get();
+        if (!coldCodeBlocks.contains(&executable->generatedBytecode()))
+            continue;
+        bytesFlushed += executable->discardCode();
+        ++functionsFlushed;
+        m_functionsWithCode.remove(executable);
+    }
+
+    m_collectionStatistics.functionsFlushed += functionsFlushed;
+    m_collectionStatistics.codeBytesFlushed += bytesFlushed;
+    m_collectionStatistics.maxCodeBytesFlushed = max(m_collectionStatistics.maxCodeBytesFlushed, bytesFlushed);
+}
+#endif
+
+void Heap::didCollect(CollectionType type, double pauseTime)
+{
+    if (type == MinorCollection) {
+        ++m_collectionStatistics.minorCollections;
+        m_collectionStatistics.minorPauseTime += pauseTime;
+        m_collectionStatistics.maxMinorPauseTime = max(m_collectionStatistics.maxMinorPauseTime, pauseTime);
+        return;
+    }
+
+    ++m_collectionStatistics.fullCollections;
+    m_collectionStatistics.fullPauseTime += pauseTime;
+    m_collectionStatistics.maxFullPauseTime = max(m_collectionStatistics.maxFullPauseTime, pauseTime);
 }
 
 void Heap::reset()
+{
+    CollectionType type = FullCollection;
+    if (m_generationalCollectionEnabled && markedCells() < m_cellsAfterFullCollection * OLD_GENERATION_GROWTH_FACTOR + ALLOCATIONS_PER_COLLECTION)
+        type = MinorCollection;
+    reset(type);
+}
+
+void Heap::reset(CollectionType type)
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
-    markRoots();
+    double startTime = currentTime();
+
+    if (type == FullCollection)
+        m_compiledFunctions.clear();
+    markRoots(type);
+    if (type == FullCollection && m_generationalCollectionEnabled)
+        m_cellsAfterFullCollection = markedCells();
+#if ENABLE(CODE_FLUSHING)
+    if (type == FullCollection)
+        flushColdFunctionCode();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    m_heap.nextNumber = 0;
-    m_heap.extraCost = 0;
+    if (m_allocationSiteSampler)
+        m_allocationSiteSampler->removeUnmarkedCells();
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        m_heaps[sizeClass].nextCell = 0;
+        m_heaps[sizeClass].nextBlock = 0;
+    }
+    m_extraCost = 0;
 #if ENABLE(JSC_ZOMBIES)
     sweep();
 #endif
     resizeBlocks();
 
+    didCollect(type, currentTime() - startTime);
+
     JAVASCRIPTCORE_GC_END();
 }
 
@@ -1438,34 +2039,56 @@ void Heap::collectAllGarbage()
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
+    double startTime = currentTime();
+
     // If the last iteration through the heap deallocated blocks, we need
     // to clean up remaining garbage before marking. Otherwise, the conservative
     // marking mechanism might follow a pointer to unmapped memory.
-    if (m_heap.didShrink)
+    if (m_didShrink)
         sweep();
 
-    markRoots();
+    m_compiledFunctions.clear();
+    markRoots(FullCollection);
+    if (m_generationalCollectionEnabled)
+        m_cellsAfterFullCollection = markedCells();
+#if ENABLE(CODE_FLUSHING)
+    flushColdFunctionCode();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
-    m_heap.nextCell = 0;
-    m_heap.nextBlock = 0;
-    m_heap.nextNumber = 0;
-    m_heap.extraCost = 0;
+    if (m_allocationSiteSampler)
+        m_allocationSiteSampler->removeUnmarkedCells();
+
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        m_heaps[sizeClass].nextCell = 0;
+        m_heaps[sizeClass].nextBlock = 0;
+    }
+    m_extraCost = 0;
     sweep();
     resizeBlocks();
+    // Callers expect the memory to be released right away.
+    for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass) {
+        CollectorHeap& heap = m_heaps[sizeClass];
+        if (heap.excessBlocks) {
+            shrinkBlocks(heap, heap.usedBlocks - heap.excessBlocks);
+            heap.excessBlocks = 0;
+        }
+    }
+
+    didCollect(FullCollection, currentTime() - startTime);
 
     JAVASCRIPTCORE_GC_END();
 }
 
 LiveObjectIterator Heap::primaryHeapBegin()
 {
-    return LiveObjectIterator(m_heap, 0);
+    return LiveObjectIterator(m_heaps, 0, 0);
 }
 
 LiveObjectIterator Heap::primaryHeapEnd()
 {
-    return LiveObjectIterator(m_heap, m_heap.usedBlocks);
+    return LiveObjectIterator(m_heaps, NUM_SIZE_CLASSES - 1, m_heaps[NUM_SIZE_CLASSES - 1].usedBlocks);
 }
 
 } // namespace JSC
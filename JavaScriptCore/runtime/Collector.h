@@ -29,8 +29,10 @@
 #include <wtf/HashSet.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/OwnPtr.h>
+#include <wtf/RefPtr.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
 #include <pthread.h>
@@ -44,31 +46,112 @@
 
 namespace JSC {
 
+    class AllocationSiteSampler;
     class CollectorBlock;
+    class ExecState;
+    class FunctionExecutable;
+    class Heap;
     class JSCell;
     class JSGlobalData;
     class JSValue;
     class MarkedArgumentBuffer;
     class MarkStack;
+    class ParallelMarker;
 
     enum OperationInProgress { NoOperation, Allocation, Collection };
 
     class LiveObjectIterator;
 
+    // tunable parameters
+    template<size_t bytesPerWord> struct CellSize;
+
+    // cell size needs to be a power of two for certain optimizations in collector.cpp
+#if USE(JSVALUE32)
+    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 32; };
+#else
+    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 64; };
+#endif
+    template<> struct CellSize<sizeof(uint64_t)> { static const size_t m_value = 64; };
+
+#if OS(WINCE) || OS(SYMBIAN)
+    const size_t BLOCK_SIZE = 64 * 1024; // 64k
+#else
+    const size_t BLOCK_SIZE = 64 * 4096; // 256k
+#endif
+
+    // derived constants
+    const size_t BLOCK_OFFSET_MASK = BLOCK_SIZE - 1;
+    const size_t BLOCK_MASK = ~BLOCK_OFFSET_MASK;
+    const size_t MINIMUM_CELL_SIZE = CellSize<sizeof(void*)>::m_value;
+    const size_t CELL_ARRAY_LENGTH = (MINIMUM_CELL_SIZE / sizeof(double)) + (MINIMUM_CELL_SIZE % sizeof(double) != 0 ? sizeof(double) : 0);
+    const size_t CELL_SIZE = CELL_ARRAY_LENGTH * sizeof(double);
+    // Cells are allocated in size classes, each a multiple of CELL_ATOM_SIZE from
+    // half a cell up to CELL_SIZE. Cells start on an atom boundary.
+    const size_t CELL_ATOM_SIZE = CELL_SIZE / 4;
+    const size_t MIN_CELL_ATOMS = 2;
+    const size_t NUM_SIZE_CLASSES = CELL_SIZE / CELL_ATOM_SIZE - MIN_CELL_ATOMS + 1;
+    // The write barrier dirties one card per CARD_SIZE bytes of a block.
+    const size_t CARD_SHIFT = 9;
+    const size_t CARD_SIZE = 1 << CARD_SHIFT;
+    const size_t CARD_OFFSET_MASK = CARD_SIZE - 1;
+    const size_t CARDS_PER_BLOCK = BLOCK_SIZE / CARD_SIZE;
+    const size_t ATOMS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*) - CARDS_PER_BLOCK * sizeof(uint32_t)) * 8 * CELL_ATOM_SIZE / (8 * CELL_ATOM_SIZE + 1) / CELL_ATOM_SIZE; // one bitmap byte can represent 8 atoms.
+
+    // The cells of one size class, and the allocator's position in them.
     struct CollectorHeap {
         size_t nextBlock;
         size_t nextCell;
         CollectorBlock** blocks;
-        
-        void* nextNumber;
 
         size_t numBlocks;
         size_t usedBlocks;
 
-        size_t extraCost;
-        bool didShrink;
+        // Empty blocks beyond what the heap needs after the last collection. They
+        // are released as the allocator reaches them.
+        size_t excessBlocks;
+        size_t allocatedCells; // since the last collection
+
+        size_t cellSize;
+        size_t atomsPerCell;
+        size_t cellsPerBlock;
 
-        OperationInProgress operationInProgress;
+        JSCell* cell(size_t block, size_t cell) const;
+        bool isMarked(size_t block, size_t cell) const;
+        size_t sentinelAtom() const { return (cellsPerBlock - 1) * atomsPerCell; }
+    };
+
+    // The cells a conservative scan of one thread's stack found, and a copy of the
+    // stack it scanned. Words that still hold what they held at the last scan point
+    // to the cells found then, so the next scan only searches the part of the stack
+    // above the deepest word that changed.
+    class ConservativeRootCache : public Noncopyable {
+    public:
+        ConservativeRootCache()
+            : m_stackBase(0)
+            , m_scanNumber(0)
+            , m_requiredStackCapacity(0)
+            , m_requiredRootCapacity(0)
+        {
+        }
+
+        // A scan that may not allocate leaves the cache empty if it did not fit.
+        // This grows it to fit the next time.
+        void reserveRequiredCapacity();
+
+    private:
+        friend class Heap;
+
+        struct Root {
+            void** location;
+            JSCell* cell;
+        };
+
+        void* m_stackBase; // 0 if the cache is empty.
+        size_t m_scanNumber;
+        size_t m_requiredStackCapacity;
+        size_t m_requiredRootCapacity;
+        WTF::Vector<void*> m_stackContents;
+        WTF::Vector<Root> m_roots; // From the base of the stack up.
     };
 
     class Heap : public Noncopyable {
@@ -77,6 +160,8 @@ namespace JSC {
 
         void destroy();
 
+        // Cells are allocated from the smallest size class they fit in; each size
+        // class has blocks of its own.
         void* allocateNumber(size_t);
 #if PLATFORM(APOLLO)
         void* allocate(size_t, bool isNumber = false);
@@ -87,11 +172,98 @@ namespace JSC {
         bool isBusy(); // true if an allocation or collection is in progress
         void collectAllGarbage();
 
+        // Generational collection. When enabled, collections triggered by allocation
+        // only trace cells allocated since the previous collection, plus the cells the
+        // write barrier recorded as modified. Must be set before any global object is
+        // created, since JIT code only emits barriers when this is on.
+        void setGenerationalCollectionEnabled(bool);
+        bool isGenerationalCollectionEnabled() const { return m_generationalCollectionEnabled; }
+
+        // Write barrier. Must be called whenever a reference to a cell is stored into
+        // an existing cell, so that a minor collection can find the new reference.
+        static void writeBarrier(const JSCell* owner);
+        static void writeBarrier(const JSCell* owner, JSValue);
+
+        // Code blocks create their constants lazily, without a barrier, so functions
+        // compiled since the last full collection are treated as roots.
+        void didCompileFunction(FunctionExecutable*);
+
+#if ENABLE(CODE_FLUSHING)
+        // Full collections throw away the code of functions that have not been called
+        // during the last age full collections; it is generated again on the next call.
+        // Zero turns this off.
+        void setCodeFlushingAge(unsigned age) { m_codeFlushingAge = age; }
+        unsigned codeFlushingAge() const { return m_codeFlushingAge; }
+        void didGenerateFunctionCode(FunctionExecutable*);
+#endif
+
+#if ENABLE(PARALLEL_GC)
+        // Number of threads that help the collecting thread mark. Zero, the default,
+        // marks on the collecting thread alone.
+        void setMarkingHelperThreadCount(unsigned);
+        unsigned markingHelperThreadCount() const;
+#endif
+
+        // Heap snapshots can tell which bytecode allocated every interval-th cell.
+        // Zero, the default, turns this off. Functions compiled while it is on keep
+        // the tables that map their JIT code back to bytecode.
+        void setAllocationSiteSamplingInterval(unsigned interval);
+        AllocationSiteSampler* allocationSiteSampler() const { return m_allocationSiteSampler.get(); }
+
+        // Bytecode that allocates says where it is, a JIT return address or an
+        // Instruction*, before it allocates. Cells allocated for a call frame but
+        // not by its bytecode say which frame they belong to.
+        void willAllocate(ExecState* callFrame, void* pc)
+        {
+            if (UNLIKELY(m_allocationSiteSampler != 0))
+                setAllocationSite(callFrame, pc);
+        }
+        void willAllocate(ExecState* callFrame)
+        {
+            if (UNLIKELY(m_allocationSiteSampler != 0))
+                setAllocationSite(callFrame);
+        }
+
+        struct CollectionStatistics {
+            size_t minorCollections;
+            size_t fullCollections;
+            double minorPauseTime; // seconds, cumulative
+            double fullPauseTime;
+            double maxMinorPauseTime;
+            double maxFullPauseTime;
+            double markTime; // seconds, cumulative for both kinds of collection
+            size_t stackWordsSearched; // by conservative stack scans
+            size_t stackWordsReused; // found unchanged since the previous scan
+            size_t functionsFlushed; // whose code was thrown away, cumulative
+            size_t codeBytesFlushed; // cumulative
+            size_t maxCodeBytesFlushed; // by a single full collection
+        };
+        const CollectionStatistics& collectionStatistics() const { return m_collectionStatistics; }
+
         static const size_t minExtraCost = 256;
         static const size_t maxExtraCost = 1024 * 1024;
 
         void reportExtraMemoryCost(size_t cost);
 
+        // Out of line property storage with room for JSObject::nonInlineBaseStorageCapacity
+        // values. Dying objects leave theirs here and objects moving off their inline
+        // storage take it, so that this needs no malloc, and put_by_id transition stubs
+        // can do it without calling out of JIT code.
+        static const unsigned maxFreePropertyStorage = 64;
+        EncodedJSValue* takeFreePropertyStorage()
+        {
+            return m_freePropertyStorageCount ? m_freePropertyStorage[--m_freePropertyStorageCount] : 0;
+        }
+        bool addFreePropertyStorage(EncodedJSValue* storage)
+        {
+            if (m_freePropertyStorageCount == maxFreePropertyStorage)
+                return false;
+            m_freePropertyStorage[m_freePropertyStorageCount++] = storage;
+            return true;
+        }
+        EncodedJSValue** freePropertyStorage() { return m_freePropertyStorage; }
+        unsigned* addressOfFreePropertyStorageCount() { return &m_freePropertyStorageCount; }
+
         size_t objectCount() const;
         struct Statistics {
             size_t size;
@@ -112,11 +284,15 @@ namespace JSC {
         size_t protectedGlobalObjectCount();
         HashCountedSet<const char*>* protectedObjectTypeCounts();
         HashCountedSet<const char*>* objectTypeCounts();
+        static const char* typeName(JSCell*); // The names the type counts use
 
         void registerThread(); // Only needs to be called by clients that can use the same heap from multiple threads.
 
         static bool isCellMarked(const JSCell*);
         static void markCell(JSCell*);
+#if ENABLE(PARALLEL_GC)
+        static bool testAndSetMarkedConcurrently(JSCell*);
+#endif
 
         void markConservatively(MarkStack&, void* start, void* end);
 
@@ -132,10 +308,16 @@ namespace JSC {
         LiveObjectIterator primaryHeapEnd();
 
     private:
+        friend class MarkStack;
+
+        enum CollectionType { MinorCollection, FullCollection };
+
         void reset();
+        void reset(CollectionType);
         void sweep();
         static CollectorBlock* cellBlock(const JSCell*);
         static size_t cellOffset(const JSCell*);
+        static size_t sizeClassFor(size_t);
 
 #if PLATFORM(APOLLO)
         void samplerRegisterJSCell(void* cell, size_t s);
@@ -146,38 +328,104 @@ namespace JSC {
         Heap(JSGlobalData*);
         ~Heap();
 
-        NEVER_INLINE CollectorBlock* allocateBlock();
-        NEVER_INLINE void freeBlock(size_t);
+        NEVER_INLINE CollectorBlock* allocateBlock(CollectorHeap&);
+        NEVER_INLINE CollectorBlock* allocateBlockPtr();
+        NEVER_INLINE void freeBlock(CollectorHeap&, size_t);
         NEVER_INLINE void freeBlockPtr(CollectorBlock*);
+        NEVER_INLINE void releaseExcessBlocks(CollectorHeap&);
         void freeBlocks();
         void resizeBlocks();
-        void growBlocks(size_t neededBlocks);
-        void shrinkBlocks(size_t neededBlocks);
+        void growBlocks(CollectorHeap&, size_t neededBlocks);
+        void shrinkBlocks(CollectorHeap&, size_t neededBlocks);
         void clearMarkBits();
-        void clearMarkBits(CollectorBlock*);
-        size_t markedCells(size_t startBlock = 0, size_t startCell = 0) const;
+        void clearMarkBits(const CollectorHeap&, CollectorBlock*);
+        size_t markedCells() const;
+        size_t markedCells(const CollectorHeap&, size_t startBlock = 0, size_t startCell = 0) const;
+        size_t objectCount(const CollectorHeap&) const;
+        size_t usedBlocks() const;
+        size_t allocatedBytes() const;
 
         void recordExtraCost(size_t);
 
+        NEVER_INLINE void setAllocationSite(ExecState*, void* pc);
+        NEVER_INLINE void setAllocationSite(ExecState*);
+
         void addToStatistics(Statistics&) const;
 
-        void markRoots();
+        void markRoots(CollectionType = FullCollection);
+        void markRememberedCells(MarkStack&);
+        void clearCards();
+        void clearCards(CollectorBlock*);
+        void didCollect(CollectionType, double pauseTime);
+        static bool hasBarrieredChildren(JSCell*);
         void markProtectedObjects(MarkStack&);
         void markTempSortVectors(MarkStack&);
+        JSCell* cellForConservativePointer(void*);
+        void markConservativeRoot(MarkStack&, JSCell*);
+        void markStackConservatively(MarkStack&, ConservativeRootCache&, void* stackPointer, void* stackBase, bool mayAllocate);
         void markCurrentThreadConservatively(MarkStack&);
         void markCurrentThreadConservativelyInternal(MarkStack&);
         void markOtherThreadConservatively(MarkStack&, Thread*);
         void markStackObjectsConservatively(MarkStack&);
+#if ENABLE(CODE_FLUSHING)
+        void flushColdFunctionCode();
+#endif
 
         typedef HashCountedSet<JSCell*> ProtectCountSet;
 
-        CollectorHeap m_heap;
+        CollectorHeap m_heaps[NUM_SIZE_CLASSES];
+        OperationInProgress m_operationInProgress;
+        size_t m_extraCost;
+        bool m_didShrink;
+        // Bytes that may be allocated before the next collection. A size class that
+        // runs out of cells grows while the heap as a whole is within this budget.
+        size_t m_allocationBudget;
 
         ProtectCountSet m_protectedValues;
         WTF::Vector<WTF::Vector<ValueStringPair>* > m_tempSortingVectors;
 
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
+        bool m_generationalCollectionEnabled;
+        bool m_isMinorCollection;
+        size_t m_cellsAfterFullCollection;
+        // Cells rescanned by every minor collection: cells whose class stores references
+        // without a write barrier, and cells found by the conservative stack scan.
+        WTF::Vector<JSCell*> m_rememberedCells;
+        WTF::Vector<RefPtr<FunctionExecutable> > m_compiledFunctions;
+#if ENABLE(CODE_FLUSHING)
+        // Functions that have code. Entries that turn out to be the last reference
+        // are dropped by the next full collection.
+        HashSet<RefPtr<FunctionExecutable> > m_functionsWithCode;
+        unsigned m_codeFlushingAge;
+#endif
+        CollectionStatistics m_collectionStatistics;
+
+        size_t m_conservativeScanNumber;
+        ConservativeRootCache m_currentThreadRoots; // The collecting thread's, whichever it is.
+
+#if ENABLE(PARALLEL_GC)
+        OwnPtr<ParallelMarker> m_parallelMarker;
+#endif
+
+        OwnPtr<AllocationSiteSampler> m_allocationSiteSampler;
+
+#if ENABLE(BACKGROUND_BLOCK_FREEING)
+        // Freed blocks wait here for a while, so that the heap can reuse them
+        // instead of going back to the system.
+        void recycleBlock(CollectorBlock*);
+        CollectorBlock* takeRecycledBlock();
+        void stopBlockFreeingThread();
+        static void* blockFreeingThreadStartFunc(void*);
+        void blockFreeingThreadMain();
+
+        Mutex m_recycledBlocksLock;
+        ThreadCondition m_recycledBlocksCondition;
+        WTF::Vector<CollectorBlock*> m_recycledBlocks;
+        ThreadIdentifier m_blockFreeingThread;
+        bool m_blockFreeingThreadShouldExit;
+#endif
+
 #if ENABLE(JSC_MULTIPLE_THREADS)
         void makeUsableFromMultipleThreads();
 
@@ -194,38 +442,13 @@ namespace JSC {
         WTF::AlignedBlockAllocator m_blockallocator; 
 #endif
         
+        EncodedJSValue* m_freePropertyStorage[maxFreePropertyStorage];
+        unsigned m_freePropertyStorageCount;
+
         JSGlobalData* m_globalData;
     };
 
-    // tunable parameters
-    template<size_t bytesPerWord> struct CellSize;
-
-    // cell size needs to be a power of two for certain optimizations in collector.cpp
-#if USE(JSVALUE32)
-    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 32; };
-#else
-    template<> struct CellSize<sizeof(uint32_t)> { static const size_t m_value = 64; };
-#endif
-    template<> struct CellSize<sizeof(uint64_t)> { static const size_t m_value = 64; };
-
-#if OS(WINCE) || OS(SYMBIAN)
-    const size_t BLOCK_SIZE = 64 * 1024; // 64k
-#else
-    const size_t BLOCK_SIZE = 64 * 4096; // 256k
-#endif
-
-    // derived constants
-    const size_t BLOCK_OFFSET_MASK = BLOCK_SIZE - 1;
-    const size_t BLOCK_MASK = ~BLOCK_OFFSET_MASK;
-    const size_t MINIMUM_CELL_SIZE = CellSize<sizeof(void*)>::m_value;
-    const size_t CELL_ARRAY_LENGTH = (MINIMUM_CELL_SIZE / sizeof(double)) + (MINIMUM_CELL_SIZE % sizeof(double) != 0 ? sizeof(double) : 0);
-    const size_t CELL_SIZE = CELL_ARRAY_LENGTH * sizeof(double);
-    const size_t SMALL_CELL_SIZE = CELL_SIZE / 2;
-    const size_t CELL_MASK = CELL_SIZE - 1;
-    const size_t CELL_ALIGN_MASK = ~CELL_MASK;
-    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*)) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
-    
-    const size_t BITMAP_SIZE = (CELLS_PER_BLOCK + 7) / 8;
+    const size_t BITMAP_SIZE = (ATOMS_PER_BLOCK + 7) / 8;
     const size_t BITMAP_WORDS = (BITMAP_SIZE + 3) / sizeof(uint32_t);
 
     struct CollectorBitmap {
@@ -234,6 +457,22 @@ namespace JSC {
         void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
         void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
         void clearAll() { memset(bits, 0, sizeof(bits)); }
+#if ENABLE(PARALLEL_GC)
+        // Sets bit n, returning whether it was already set. Safe to call from
+        // several threads at once.
+        bool testAndSetConcurrently(size_t n)
+        {
+            unsigned volatile* word = reinterpret_cast<unsigned volatile*>(&bits[n >> 5]);
+            unsigned mask = 1 << (n & 0x1F);
+            while (true) {
+                unsigned oldValue = *word;
+                if (oldValue & mask)
+                    return true;
+                if (weakCompareAndSwap(word, oldValue, oldValue | mask))
+                    return false;
+            }
+        }
+#endif
         size_t count(size_t startCell = 0)
         {
             size_t result = 0;
@@ -241,8 +480,10 @@ namespace JSC {
                 if (get(startCell))
                     ++result;
             }
-            for (size_t i = startCell >> 5; i < BITMAP_WORDS; ++i)
-                result += WTF::bitCount(bits[i]);
+            for (size_t i = startCell >> 5; i < BITMAP_WORDS; ++i) {
+                if (bits[i])
+                    result += WTF::bitCount(bits[i]);
+            }
             return result;
         }
         size_t isEmpty() // Much more efficient than testing count() == 0.
@@ -258,19 +499,27 @@ namespace JSC {
         double memory[CELL_ARRAY_LENGTH];
     };
 
+    struct CollectorAtom {
+        double memory[CELL_ATOM_SIZE / sizeof(double)];
+    };
+
     class CollectorBlock {
     public:
-        CollectorCell cells[CELLS_PER_BLOCK];
-        CollectorBitmap marked;
+        CollectorAtom atoms[ATOMS_PER_BLOCK];
+        CollectorBitmap marked; // A cell's mark is the bit of its first atom.
+        uint32_t cards[CARDS_PER_BLOCK]; // Written by JIT code, so a word rather than a byte per card.
         Heap* heap;
     };
 
-    struct HeapConstants {
-        static const size_t cellSize = CELL_SIZE;
-        static const size_t cellsPerBlock = CELLS_PER_BLOCK;
-        typedef CollectorCell Cell;
-        typedef CollectorBlock Block;
-    };
+    inline JSCell* CollectorHeap::cell(size_t block, size_t cell) const
+    {
+        return reinterpret_cast<JSCell*>(blocks[block]->atoms + cell * atomsPerCell);
+    }
+
+    inline bool CollectorHeap::isMarked(size_t block, size_t cell) const
+    {
+        return blocks[block]->marked.get(cell * atomsPerCell);
+    }
 
     inline CollectorBlock* Heap::cellBlock(const JSCell* cell)
     {
@@ -279,7 +528,13 @@ namespace JSC {
 
     inline size_t Heap::cellOffset(const JSCell* cell)
     {
-        return (reinterpret_cast<uintptr_t>(cell) & BLOCK_OFFSET_MASK) / CELL_SIZE;
+        return (reinterpret_cast<uintptr_t>(cell) & BLOCK_OFFSET_MASK) / CELL_ATOM_SIZE;
+    }
+
+    inline size_t Heap::sizeClassFor(size_t bytes)
+    {
+        size_t atoms = (bytes + CELL_ATOM_SIZE - 1) / CELL_ATOM_SIZE;
+        return atoms > MIN_CELL_ATOMS ? atoms - MIN_CELL_ATOMS : 0;
     }
 
     inline bool Heap::isCellMarked(const JSCell* cell)
@@ -292,6 +547,18 @@ namespace JSC {
         cellBlock(cell)->marked.set(cellOffset(cell));
     }
 
+#if ENABLE(PARALLEL_GC)
+    inline bool Heap::testAndSetMarkedConcurrently(JSCell* cell)
+    {
+        return cellBlock(cell)->marked.testAndSetConcurrently(cellOffset(cell));
+    }
+#endif
+
+    inline void Heap::writeBarrier(const JSCell* owner)
+    {
+        cellBlock(owner)->cards[(reinterpret_cast<uintptr_t>(owner) & BLOCK_OFFSET_MASK) >> CARD_SHIFT] = 1;
+    }
+
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
         if (cost > minExtraCost) 
@@ -300,20 +567,13 @@ namespace JSC {
     
     inline void* Heap::allocateNumber(size_t s)
     {
-        if (void* result = m_heap.nextNumber) {
-            m_heap.nextNumber = 0;
-            return result;
-        }
-
 #if PLATFORM(APOLLO)
         // tell that we intend to allocate a number. This is important for the Sampler
         // since we do not want to track numbers.
-        void* result = allocate(s, true);
+        return allocate(s, true);
 #else
-        void* result = allocate(s);
+        return allocate(s);
 #endif
-        m_heap.nextNumber = static_cast<char*>(result) + (CELL_SIZE / 2);
-        return result;
     }
 
 } // namespace JSC
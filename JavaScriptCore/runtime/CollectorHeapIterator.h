@@ -35,20 +35,26 @@ namespace JSC {
     public:
         bool operator!=(const CollectorHeapIterator& other);
         JSCell* operator*() const;
+        size_t cellSize() const { return m_heap->cellSize; }
     
     protected:
         CollectorHeapIterator(CollectorHeap&, size_t startBlock, size_t startCell);
-        void advance(size_t max);
+        void advance();
 
-        CollectorHeap& m_heap;
+        CollectorHeap* m_heap;
         size_t m_block;
         size_t m_cell;
     };
 
+    // Visits the live cells of every size class, in size class order.
     class LiveObjectIterator : public CollectorHeapIterator {
     public:
-        LiveObjectIterator(CollectorHeap&, size_t startBlock, size_t startCell = 0);
+        LiveObjectIterator(CollectorHeap* heaps, size_t sizeClass, size_t startBlock, size_t startCell = 0);
         LiveObjectIterator& operator++();
+
+    private:
+        CollectorHeap* m_heaps;
+        size_t m_sizeClass;
     };
 
     class DeadObjectIterator : public CollectorHeapIterator {
@@ -64,7 +70,7 @@ namespace JSC {
     };
 
     inline CollectorHeapIterator::CollectorHeapIterator(CollectorHeap& heap, size_t startBlock, size_t startCell)
-        : m_heap(heap)
+        : m_heap(&heap)
         , m_block(startBlock)
         , m_cell(startCell)
     {
@@ -72,40 +78,49 @@ namespace JSC {
 
     inline bool CollectorHeapIterator::operator!=(const CollectorHeapIterator& other)
     {
-        return m_block != other.m_block || m_cell != other.m_cell;
+        return m_block != other.m_block || m_cell != other.m_cell || m_heap != other.m_heap;
     }
 
     inline JSCell* CollectorHeapIterator::operator*() const
     {
-        return reinterpret_cast<JSCell*>(m_heap.blocks[m_block]->cells + m_cell);
+        return m_heap->cell(m_block, m_cell);
     }
     
     // Iterators advance up to the next-to-last -- and not the last -- cell in a
     // block, since the last cell is a dummy sentinel.
-    inline void CollectorHeapIterator::advance(size_t max)
+    inline void CollectorHeapIterator::advance()
     {
         ++m_cell;
-        if (m_cell == max) {
+        if (m_cell == m_heap->cellsPerBlock - 1) {
             m_cell = 0;
             ++m_block;
         }
     }
 
-    inline LiveObjectIterator::LiveObjectIterator(CollectorHeap& heap, size_t startBlock, size_t startCell)
-        : CollectorHeapIterator(heap, startBlock, startCell - 1)
+    inline LiveObjectIterator::LiveObjectIterator(CollectorHeap* heaps, size_t sizeClass, size_t startBlock, size_t startCell)
+        : CollectorHeapIterator(heaps[sizeClass], startBlock, startCell - 1)
+        , m_heaps(heaps)
+        , m_sizeClass(sizeClass)
     {
         ++(*this);
     }
 
     inline LiveObjectIterator& LiveObjectIterator::operator++()
     {
-        advance(HeapConstants::cellsPerBlock - 1);
-        if (m_block < m_heap.nextBlock || (m_block == m_heap.nextBlock && m_cell < m_heap.nextCell))
-            return *this;
-
-        while (m_block < m_heap.usedBlocks && !m_heap.blocks[m_block]->marked.get(m_cell))
-            advance(HeapConstants::cellsPerBlock - 1);
-        return *this;
+        while (true) {
+            advance();
+            if (m_block < m_heap->nextBlock || (m_block == m_heap->nextBlock && m_cell < m_heap->nextCell))
+                return *this;
+
+            while (m_block < m_heap->usedBlocks && !m_heap->isMarked(m_block, m_cell))
+                advance();
+            if (m_block < m_heap->usedBlocks || m_sizeClass == NUM_SIZE_CLASSES - 1)
+                return *this;
+
+            m_heap = &m_heaps[++m_sizeClass];
+            m_block = 0;
+            m_cell = static_cast<size_t>(-1);
+        }
     }
 
     inline DeadObjectIterator::DeadObjectIterator(CollectorHeap& heap, size_t startBlock, size_t startCell)
@@ -117,9 +132,9 @@ namespace JSC {
     inline DeadObjectIterator& DeadObjectIterator::operator++()
     {
         do {
-            advance(HeapConstants::cellsPerBlock - 1);
-            ASSERT(m_block > m_heap.nextBlock || (m_block == m_heap.nextBlock && m_cell >= m_heap.nextCell));
-        } while (m_block < m_heap.usedBlocks && m_heap.blocks[m_block]->marked.get(m_cell));
+            advance();
+            ASSERT(m_block > m_heap->nextBlock || (m_block == m_heap->nextBlock && m_cell >= m_heap->nextCell));
+        } while (m_block < m_heap->usedBlocks && m_heap->isMarked(m_block, m_cell));
         return *this;
     }
 
@@ -131,7 +146,7 @@ namespace JSC {
 
     inline ObjectIterator& ObjectIterator::operator++()
     {
-        advance(HeapConstants::cellsPerBlock - 1);
+        advance();
         return *this;
     }
 
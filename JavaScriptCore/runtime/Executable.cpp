@@ -26,6 +26,7 @@
 #include "config.h"
 #include "Executable.h"
 
+#include "BytecodeCache.h"
 #include "BytecodeGenerator.h"
 #include "CodeBlock.h"
 #include "JIT.h"
@@ -102,6 +103,16 @@ JSObject* ProgramExecutable::checkSyntax(ExecState* exec)
 
 JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChainNode)
 {
+    ScopeChain scopeChain(scopeChainNode);
+    JSGlobalObject* globalObject = scopeChain.globalObject();
+    ASSERT(!m_programCodeBlock);
+
+#if ENABLE(BYTECODE_CACHE)
+    BytecodeCache* bytecodeCache = BytecodeCache::canCache(globalObject) ? exec->globalData().bytecodeCache.get() : 0;
+    if (bytecodeCache && (m_programCodeBlock = bytecodeCache->load(exec, globalObject, this)))
+        return 0;
+#endif
+
     int errLine;
     UString errMsg;
     RefPtr<ProgramNode> programNode = exec->globalData().parser->parse<ProgramNode>(&exec->globalData(), exec->lexicalGlobalObject()->debugger(), exec, m_source, &errLine, &errMsg);
@@ -109,14 +120,21 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
         return Error::create(exec, SyntaxError, errMsg, errLine, m_source.provider()->asID(), m_source.provider()->url());
     recordParse(programNode->features(), programNode->lineNo(), programNode->lastLine());
 
-    ScopeChain scopeChain(scopeChainNode);
-    JSGlobalObject* globalObject = scopeChain.globalObject();
-    
-    ASSERT(!m_programCodeBlock);
+#if ENABLE(BYTECODE_CACHE)
+    BytecodeCache::GlobalState globalState;
+    if (bytecodeCache)
+        bytecodeCache->recordGlobalState(exec, globalObject, programNode.get(), globalState);
+#endif
+
     m_programCodeBlock = new ProgramCodeBlock(this, GlobalCode, globalObject, source().provider());
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(programNode.get(), globalObject->debugger(), scopeChain, &globalObject->symbolTable(), m_programCodeBlock));
     generator->generate();
 
+#if ENABLE(BYTECODE_CACHE)
+    if (bytecodeCache)
+        bytecodeCache->store(exec, globalObject, this, m_programCodeBlock, globalState);
+#endif
+
     programNode->destroyData();
     return 0;
 }
@@ -136,10 +154,17 @@ void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
     ASSERT(!m_codeBlock);
     m_codeBlock = new FunctionCodeBlock(this, FunctionCode, source().provider(), source().startOffset());
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(body.get(), globalObject->debugger(), scopeChain, m_codeBlock->symbolTable(), m_codeBlock));
+    // The generator adds constants to the code block without a write barrier, and
+    // may allocate, so register both before and after generating.
+    globalData->heap.didCompileFunction(this);
     generator->generate();
+    globalData->heap.didCompileFunction(this);
     m_numParameters = m_codeBlock->m_numParameters;
     ASSERT(m_numParameters);
     m_numVariables = m_codeBlock->m_numVars;
+#if ENABLE(CODE_FLUSHING)
+    globalData->heap.didGenerateFunctionCode(this);
+#endif
 
     body->destroyData();
 }
@@ -249,6 +274,20 @@ void FunctionExecutable::recompile(ExecState*)
 #endif
 }
 
+#if ENABLE(CODE_FLUSHING)
+size_t FunctionExecutable::discardCode()
+{
+    ASSERT(m_codeBlock);
+    size_t size = m_codeBlock->instructions().capacity() * sizeof(Instruction);
+#if ENABLE(JIT)
+    if (!!m_jitCode)
+        size += m_jitCode.size();
+#endif
+    recompile(0);
+    return size;
+}
+#endif
+
 PassRefPtr<FunctionExecutable> FunctionExecutable::fromGlobalCode(const Identifier& functionName, ExecState* exec, Debugger* debugger, const SourceCode& source, int* errLine, UString* errMsg)
 {
     RefPtr<ProgramNode> program = exec->globalData().parser->parse<ProgramNode>(&exec->globalData(), debugger, exec, source, errLine, errMsg);
@@ -203,6 +203,7 @@ namespace JSC {
     };
 
     class ProgramExecutable : public ScriptExecutable {
+        friend class BytecodeCache;
     public:
         static PassRefPtr<ProgramExecutable> create(ExecState* exec, const SourceCode& source)
         {
@@ -305,7 +306,9 @@ namespace JSC {
         }
 
         const Identifier& name() { return m_name; }
+        FunctionParameters* parameters() const { return m_parameters.get(); }
         size_t parameterCount() const { return m_parameters->size(); }
+        bool forceUsesArguments() const { return m_forceUsesArguments; }
         unsigned variableCount() const { return m_numVariables; }
         UString paramString() const;
 		
@@ -314,6 +317,10 @@ namespace JSC {
 #endif
 
         void recompile(ExecState*);
+#if ENABLE(CODE_FLUSHING)
+        // Like recompile, but returns roughly how many bytes of code it freed.
+        size_t discardCode();
+#endif
         ExceptionInfo* reparseExceptionInfo(JSGlobalData*, ScopeChainNode*, CodeBlock*);
         void markAggregate(MarkStack& markStack);
         static PassRefPtr<FunctionExecutable> fromGlobalCode(const Identifier&, ExecState*, Debugger*, const SourceCode&, int* errLine = 0, UString* errMsg = 0);
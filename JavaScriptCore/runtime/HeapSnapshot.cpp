@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "HeapSnapshot.h"
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "CollectorHeapIterator.h"
+#include "Executable.h"
+#include "JSFunction.h"
+#include "JSGlobalData.h"
+#include "MarkStack.h"
+#include <stdio.h>
+#include <wtf/text/CString.h>
+
+namespace JSC {
+
+AllocationSiteSampler::AllocationSiteSampler(unsigned interval)
+    : m_interval(interval)
+    , m_countdown(interval)
+    , m_frame(0)
+    , m_instructionFrame(0)
+    , m_instructionPC(0)
+{
+    ASSERT(interval);
+}
+
+AllocationSiteSampler::~AllocationSiteSampler()
+{
+}
+
+static bool isHostCallFrame(CallFrame* callFrame)
+{
+    // The JIT's native call thunk leaves the code block slot of the frame it
+    // sets up alone, so look at the callee first.
+    if (JSFunction* callee = callFrame->callee())
+        return callee->isHostFunction();
+    return !callFrame->codeBlock();
+}
+
+void AllocationSiteSampler::sample(JSCell* cell)
+{
+    m_countdown = m_interval;
+
+    unsigned site = 0;
+    if (m_instructionFrame && (!m_frame || m_frame == m_instructionFrame))
+        site = siteNumber(m_instructionFrame, m_instructionPC, false);
+    else if (m_frame && !isHostCallFrame(m_frame))
+        site = siteNumber(m_frame, 0, false);
+    else if (m_frame) {
+        // A host function allocated the cell; blame the call to it.
+        CallFrame* callerFrame = m_frame->callerFrame();
+        if (!callerFrame->hasHostCallFrameFlag() && !isHostCallFrame(callerFrame))
+            site = siteNumber(callerFrame, m_frame->returnPC(), true);
+    }
+    clearCurrentSite();
+
+    if (site)
+        m_cells.set(cell, site);
+}
+
+unsigned AllocationSiteSampler::siteNumber(ExecState* callFrame, void* pc, bool isReturnPC)
+{
+    CodeBlock* codeBlock = callFrame->codeBlock();
+    unsigned bytecodeOffset = UINT_MAX;
+
+    // Mapping a pc to bytecode needs the code block's exception info, which is
+    // only kept for code compiled while sampling. Regenerating it here could
+    // allocate, so cells allocated by older code only get their function.
+    if (pc && codeBlock->hasExceptionInfo()) {
+#if ENABLE(JIT)
+        UNUSED_PARAM(isReturnPC);
+        JITCode& jitCode = codeBlock->getJITCode();
+        char* start = static_cast<char*>(jitCode.start());
+        char* returnAddress = static_cast<char*>(pc);
+        if (returnAddress > start && returnAddress <= start + jitCode.size())
+            bytecodeOffset = codeBlock->getBytecodeIndex(callFrame, ReturnAddressPtr(pc));
+#else
+        bytecodeOffset = static_cast<Instruction*>(pc) - codeBlock->instructions().begin();
+        // A return pc points past the call instruction.
+        if (isReturnPC)
+            --bytecodeOffset;
+#endif
+    }
+
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    std::pair<HashMap<std::pair<ScriptExecutable*, unsigned>, unsigned>::iterator, bool> result = m_siteNumbers.add(std::make_pair(executable, bytecodeOffset), m_sites.size() + 1);
+    if (!result.second)
+        return result.first->second;
+
+    AllocationSite site;
+    site.executable = executable;
+    if (codeBlock->codeType() == FunctionCode)
+        site.functionName = static_cast<FunctionExecutable*>(executable)->name().ustring();
+    site.lineNumber = bytecodeOffset == UINT_MAX ? -1 : codeBlock->lineNumberForBytecodeOffset(callFrame, bytecodeOffset);
+    site.bytecodeOffset = bytecodeOffset;
+    m_sites.append(site);
+    return m_sites.size();
+}
+
+void AllocationSiteSampler::removeUnmarkedCells()
+{
+    Vector<JSCell*> deadCells;
+    HashMap<JSCell*, unsigned>::iterator end = m_cells.end();
+    for (HashMap<JSCell*, unsigned>::iterator it = m_cells.begin(); it != end; ++it) {
+        if (!Heap::isCellMarked(it->first))
+            deadCells.append(it->first);
+    }
+    for (size_t i = 0; i < deadCells.size(); ++i)
+        m_cells.remove(deadCells[i]);
+}
+
+// Heap snapshot format, version 1. Numbers are in the byte order of the machine
+// that wrote the file; a reader can tell it from the version field.
+//
+// Header
+//     char[8]  "JSCHEAP\0"
+//     uint32   version
+//     uint32   number of cells
+//     uint32   number of allocation sites
+//     uint32   number of strings
+// Cells
+//     uint64   address of the cell
+//     uint64   address of its Structure
+//     uint32   class name, an index into the strings
+//     uint32   size in bytes
+//     uint32   allocation site, one more than an index into the sites; 0 if not sampled
+//     uint32   number of references
+//     uint64   addresses of the referenced cells
+// Allocation sites
+//     uint32   source URL, an index into the strings
+//     uint32   function name, an index into the strings; empty for global and eval code
+//     int32    line number, -1 if unknown
+//     uint32   bytecode offset, 0xFFFFFFFF if unknown
+// Strings
+//     uint32   length in bytes
+//     char[]   UTF-8, not null terminated
+
+static const char heapSnapshotMagic[8] = { 'J', 'S', 'C', 'H', 'E', 'A', 'P', '\0' };
+static const uint32_t heapSnapshotVersion = 1;
+
+class HeapSnapshotWriter : public Noncopyable {
+public:
+    HeapSnapshotWriter(FILE* file)
+        : m_file(file)
+        , m_failed(false)
+    {
+    }
+
+    void write32(uint32_t value) { write(&value, sizeof(value)); }
+    void write64(uint64_t value) { write(&value, sizeof(value)); }
+    void write(const void* data, size_t size)
+    {
+        if (size && fwrite(data, size, 1, m_file) != 1)
+            m_failed = true;
+    }
+
+    unsigned string(const char* string)
+    {
+        std::pair<HashMap<const char*, unsigned>::iterator, bool> result = m_stringIndices.add(string, m_strings.size());
+        if (result.second)
+            m_strings.append(CString(string));
+        return result.first->second;
+    }
+
+    unsigned string(const UString& string)
+    {
+        m_strings.append(string.UTF8String());
+        return m_strings.size() - 1;
+    }
+
+    void writeStrings()
+    {
+        for (size_t i = 0; i < m_strings.size(); ++i) {
+            write32(m_strings[i].length());
+            write(m_strings[i].data(), m_strings[i].length());
+        }
+    }
+
+    size_t stringCount() const { return m_strings.size(); }
+    bool failed() const { return m_failed; }
+
+private:
+    FILE* m_file;
+    bool m_failed;
+    HashMap<const char*, unsigned> m_stringIndices;
+    Vector<CString> m_strings;
+};
+
+bool writeHeapSnapshot(JSGlobalData* globalData, const char* fileName)
+{
+    FILE* file = fopen(fileName, "wb");
+    if (!file)
+        return false;
+
+    Heap& heap = globalData->heap;
+    AllocationSiteSampler* sampler = heap.allocationSiteSampler();
+
+    // Leaves exactly the live cells marked.
+    heap.collectAllGarbage();
+
+    HeapSnapshotWriter writer(file);
+    writer.write(heapSnapshotMagic, sizeof(heapSnapshotMagic));
+    writer.write32(heapSnapshotVersion);
+    long countsOffset = ftell(file);
+    writer.write32(0);
+    writer.write32(0);
+    writer.write32(0);
+
+    MarkStack& markStack = globalData->markStack;
+    Vector<JSCell*> references;
+    uint32_t cellCount = 0;
+    LiveObjectIterator end = heap.primaryHeapEnd();
+    for (LiveObjectIterator it = heap.primaryHeapBegin(); it != end; ++it) {
+        JSCell* cell = *it;
+        markStack.appendReferences(cell, references);
+
+        writer.write64(reinterpret_cast<uintptr_t>(cell));
+        writer.write64(reinterpret_cast<uintptr_t>(cell->structure()));
+        writer.write32(writer.string(Heap::typeName(cell)));
+        writer.write32(it.cellSize());
+        writer.write32(sampler ? sampler->siteNumber(cell) : 0);
+        writer.write32(references.size());
+        for (size_t i = 0; i < references.size(); ++i)
+            writer.write64(reinterpret_cast<uintptr_t>(references[i]));
+
+        references.shrink(0);
+        ++cellCount;
+    }
+
+    uint32_t siteCount = 0;
+    if (sampler) {
+        const Vector<AllocationSite>& sites = sampler->sites();
+        siteCount = sites.size();
+        for (size_t i = 0; i < sites.size(); ++i) {
+            writer.write32(writer.string(sites[i].executable->sourceURL()));
+            writer.write32(writer.string(sites[i].functionName));
+            writer.write32(sites[i].lineNumber);
+            writer.write32(sites[i].bytecodeOffset);
+        }
+    }
+
+    uint32_t stringCount = writer.stringCount();
+    writer.writeStrings();
+
+    if (fseek(file, countsOffset, SEEK_SET)) {
+        fclose(file);
+        return false;
+    }
+    writer.write32(cellCount);
+    writer.write32(siteCount);
+    writer.write32(stringCount);
+
+    bool failed = writer.failed();
+    return !fclose(file) && !failed;
+}
+
+} // namespace JSC
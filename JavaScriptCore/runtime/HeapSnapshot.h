@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HeapSnapshot_h
+#define HeapSnapshot_h
+
+#include "Collector.h"
+#include "UString.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class ExecState;
+    class JSCell;
+    class JSGlobalData;
+    class ScriptExecutable;
+
+    struct AllocationSite {
+        RefPtr<ScriptExecutable> executable;
+        UString functionName;
+        int lineNumber; // -1 if unknown
+        unsigned bytecodeOffset; // UINT_MAX if unknown
+    };
+
+    // Remembers which bytecode allocated every interval-th cell. Bytecode that
+    // allocates tells the heap where it is through Heap::willAllocate(); cells
+    // allocated for a host function are attributed to the call that invoked it.
+    class AllocationSiteSampler : public Noncopyable {
+    public:
+        AllocationSiteSampler(unsigned interval);
+        ~AllocationSiteSampler();
+
+        void setCurrentInstruction(ExecState* callFrame, void* pc)
+        {
+            m_instructionFrame = callFrame;
+            m_instructionPC = pc;
+        }
+        void setCurrentFrame(ExecState* callFrame) { m_frame = callFrame; }
+
+        void didAllocate(JSCell* cell)
+        {
+            if (--m_countdown)
+                clearCurrentSite();
+            else
+                sample(cell);
+        }
+
+        // Forgets the cells the last collection found dead.
+        void removeUnmarkedCells();
+
+        // One more than the index of the site cell was allocated at, or 0 if the
+        // cell was not sampled.
+        unsigned siteNumber(JSCell* cell) const { return m_cells.get(cell); }
+        const Vector<AllocationSite>& sites() const { return m_sites; }
+
+    private:
+        void clearCurrentSite()
+        {
+            m_frame = 0;
+            m_instructionFrame = 0;
+        }
+        void sample(JSCell*);
+        unsigned siteNumber(ExecState* callFrame, void* pc, bool isReturnPC);
+
+        unsigned m_interval;
+        unsigned m_countdown;
+
+        ExecState* m_frame;
+        ExecState* m_instructionFrame;
+        void* m_instructionPC;
+
+        HashMap<JSCell*, unsigned> m_cells;
+        Vector<AllocationSite> m_sites;
+        HashMap<std::pair<ScriptExecutable*, unsigned>, unsigned> m_siteNumbers;
+    };
+
+    // Writes every live cell, with its class, structure, size, allocation site
+    // and the cells it references, to fileName. The format is described in
+    // HeapSnapshot.cpp. Collects garbage first. Returns false if the file could
+    // not be written.
+    bool writeHeapSnapshot(JSGlobalData*, const char* fileName);
+
+} // namespace JSC
+
+#endif // HeapSnapshot_h
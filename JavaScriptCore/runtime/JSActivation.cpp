@@ -39,25 +39,41 @@ ASSERT_CLASS_FITS_IN_CELL(JSActivation);
 
 const ClassInfo JSActivation::info = { "JSActivation", 0, 0, 0 };
 
+JSActivation::JSActivationData* JSActivation::JSActivationData::create(NonNullPassRefPtr<FunctionExecutable> passedExecutable, Register* registers)
+{
+    RefPtr<FunctionExecutable> functionExecutable = passedExecutable;
+    CodeBlock& codeBlock = functionExecutable->generatedBytecode();
+    COMPILE_ASSERT(!(sizeof(JSActivationData) % sizeof(Register)), JSActivationData_is_register_aligned);
+    void* block = fastMalloc(sizeof(JSActivationData) + registerCount(codeBlock) * sizeof(Register));
+    Register* storage = reinterpret_cast<Register*>(static_cast<JSActivationData*>(block) + 1);
+    return new (block) JSActivationData(functionExecutable.release(), registers, storage + registerOffset(codeBlock));
+}
+
+void JSActivation::JSActivationData::destroy(JSActivationData* data)
+{
+    data->~JSActivationData();
+    fastFree(data);
+}
+
 JSActivation::JSActivation(CallFrame* callFrame, NonNullPassRefPtr<FunctionExecutable> functionExecutable)
-    : Base(callFrame->globalData().activationStructure, new JSActivationData(functionExecutable, callFrame->registers()))
+    : Base(callFrame->globalData().activationStructure, JSActivationData::create(functionExecutable, callFrame->registers()))
 {
 }
 
 JSActivation::~JSActivation()
 {
-    delete d();
+    JSActivationData::destroy(d());
 }
 
 void JSActivation::markChildren(MarkStack& markStack)
 {
     Base::markChildren(markStack);
 
-    Register* registerArray = d()->registerArray.get();
-    if (!registerArray)
+    if (!isTornOff())
         return;
 
     size_t numParametersMinusThis = d()->functionExecutable->parameterCount();
+    Register* registerArray = d()->registers - numParametersMinusThis - RegisterFile::CallFrameHeaderSize;
 
     size_t count = numParametersMinusThis;
     markStack.appendValues(registerArray, count);
@@ -61,6 +61,7 @@ namespace JSC {
         virtual JSObject* toThisObject(ExecState*) const;
 
         void copyRegisters(Arguments* arguments);
+        bool isTornOff() const { return d()->registers == d()->tornOffRegisters; }
         
         virtual const ClassInfo* classInfo() const { return &info; }
         static const ClassInfo info;
@@ -71,21 +72,36 @@ namespace JSC {
         static const unsigned StructureFlags = OverridesGetOwnPropertySlot | NeedsThisConversion | OverridesMarkChildren | OverridesGetPropertyNames | JSVariableObject::StructureFlags;
 
     private:
+        friend class JIT;
+
+        // The storage that the locals are torn off into is laid out from the code block when the
+        // activation is created, and allocated in the same block as the data, so that tearing off
+        // is a straight copy with no allocation.
         struct JSActivationData : public JSVariableObjectData {
-            JSActivationData(NonNullPassRefPtr<FunctionExecutable> _functionExecutable, Register* registers)
+            static JSActivationData* create(NonNullPassRefPtr<FunctionExecutable>, Register* registers);
+            static void destroy(JSActivationData*);
+
+            ~JSActivationData()
+            {
+                static_cast<SharedSymbolTable*>(symbolTable)->deref();
+            }
+
+            static int registerOffset(CodeBlock& codeBlock) { return codeBlock.m_numParameters - 1 + RegisterFile::CallFrameHeaderSize; }
+            static size_t registerCount(CodeBlock& codeBlock) { return registerOffset(codeBlock) + codeBlock.m_numVars; }
+
+            RefPtr<FunctionExecutable> functionExecutable;
+            Register* tornOffRegisters; // "r" in the storage that follows this struct.
+
+        private:
+            JSActivationData(NonNullPassRefPtr<FunctionExecutable> _functionExecutable, Register* registers, Register* _tornOffRegisters)
                 : JSVariableObjectData(_functionExecutable->generatedBytecode().symbolTable(), registers)
                 , functionExecutable(_functionExecutable)
+                , tornOffRegisters(_tornOffRegisters)
             {
                 // We have to manually ref and deref the symbol table as JSVariableObjectData
                 // doesn't know about SharedSymbolTable
                 functionExecutable->generatedBytecode().sharedSymbolTable()->ref();
             }
-            ~JSActivationData()
-            {
-                static_cast<SharedSymbolTable*>(symbolTable)->deref();
-            }
-
-            RefPtr<FunctionExecutable> functionExecutable;
         };
         
         static JSValue argumentsGetter(ExecState*, JSValue, const Identifier&);
@@ -66,6 +66,10 @@ ASSERT_CLASS_FITS_IN_CELL(JSArray);
 //     (1 / minDensityMultiplier) of the entries would be populated).
 //   * Where (MAX_STORAGE_VECTOR_INDEX < i <= MAX_ARRAY_INDEX) the value will always be stored
 //     in the sparse array.
+//
+// An array starts out as a NumberVector and stays one while every array index it is given
+// holds a number (see JSArray::VectorMode). Numeric arrays, which can be large and long lived,
+// then cost the collector nothing to mark.
 
 // The definition of MAX_STORAGE_VECTOR_LENGTH is dependant on the definition storageSize
 // function below - the MAX_STORAGE_VECTOR_LENGTH limit is defined such that the storage
@@ -148,6 +152,9 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure)
 
     m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
     m_vectorLength = initialCapacity;
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    m_vectorMode = NumberVector;
+#endif
 
     checkConsistency();
 }
@@ -160,6 +167,9 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
     m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
     m_storage->m_length = initialLength;
     m_vectorLength = initialCapacity;
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    m_vectorMode = NumberVector;
+#endif
     m_storage->m_numValuesInVector = 0;
     m_storage->m_sparseValueMap = 0;
     m_storage->subclassData = 0;
@@ -182,6 +192,9 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
     m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
     m_storage->m_length = initialCapacity;
     m_vectorLength = initialCapacity;
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+    m_vectorMode = NumberVector;
+#endif
     m_storage->m_numValuesInVector = initialCapacity;
     m_storage->m_sparseValueMap = 0;
     m_storage->subclassData = 0;
@@ -189,8 +202,10 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
 
     size_t i = 0;
     ArgList::const_iterator end = list.end();
-    for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i)
+    for (ArgList::const_iterator it = list.begin(); it != end; ++it, ++i) {
+        updateVectorMode(*it);
         m_storage->m_vector[i] = *it;
+    }
 
     checkConsistency();
 
@@ -308,6 +323,9 @@ void JSArray::put(ExecState* exec, unsigned i, JSValue value)
 {
     checkConsistency();
 
+    updateVectorMode(value);
+    Heap::writeBarrier(this, value);
+
     unsigned length = m_storage->m_length;
     if (i >= length && i <= MAX_ARRAY_INDEX) {
         length = i + 1;
@@ -357,7 +375,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
             }
 
             size_t capacity = map->capacity();
-            if (capacity != storage->reportedMapCapacity) {
+            if (capacity > storage->reportedMapCapacity) {
                 Heap::heap(this)->reportExtraMemoryCost((capacity - storage->reportedMapCapacity) * (sizeof(unsigned) + sizeof(JSValue)));
                 storage->reportedMapCapacity = capacity;
             }
@@ -381,8 +399,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
     // Decide how many values it would be best to move from the map.
     unsigned newNumValuesInVector = storage->m_numValuesInVector + 1;
     unsigned newVectorLength = increasedVectorLength(i + 1);
-    for (unsigned j = max(m_vectorLength, MIN_SPARSE_ARRAY_INDEX); j < newVectorLength; ++j)
-        newNumValuesInVector += map->contains(j);
+    newNumValuesInVector += map->count(max(m_vectorLength, MIN_SPARSE_ARRAY_INDEX), newVectorLength);
     if (i >= MIN_SPARSE_ARRAY_INDEX)
         newNumValuesInVector -= map->contains(i);
     if (isDenseEnoughForVector(newVectorLength, newNumValuesInVector)) {
@@ -390,8 +407,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
         // If newVectorLength is already the maximum - MAX_STORAGE_VECTOR_LENGTH - then do not attempt to grow any further.
         while (newVectorLength < MAX_STORAGE_VECTOR_LENGTH) {
             unsigned proposedNewVectorLength = increasedVectorLength(newVectorLength + 1);
-            for (unsigned j = max(newVectorLength, MIN_SPARSE_ARRAY_INDEX); j < proposedNewVectorLength; ++j)
-                proposedNewNumValuesInVector += map->contains(j);
+            proposedNewNumValuesInVector += map->count(max(newVectorLength, MIN_SPARSE_ARRAY_INDEX), proposedNewVectorLength);
             if (!isDenseEnoughForVector(proposedNewVectorLength, proposedNewNumValuesInVector))
                 break;
             newVectorLength = proposedNewVectorLength;
@@ -412,10 +428,9 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
         if (i > MIN_SPARSE_ARRAY_INDEX)
             map->remove(i);
     } else {
-        for (unsigned j = vectorLength; j < max(vectorLength, MIN_SPARSE_ARRAY_INDEX); ++j)
+        for (unsigned j = vectorLength; j < newVectorLength; ++j)
             storage->m_vector[j] = JSValue();
-        for (unsigned j = max(vectorLength, MIN_SPARSE_ARRAY_INDEX); j < newVectorLength; ++j)
-            storage->m_vector[j] = map->take(j);
+        map->takeRange(max(vectorLength, MIN_SPARSE_ARRAY_INDEX), newVectorLength, storage->m_vector);
     }
 
     storage->m_vector[i] = value;
@@ -551,12 +566,7 @@ void JSArray::setLength(unsigned newLength)
         }
 
         if (SparseArrayValueMap* map = storage->m_sparseValueMap) {
-            SparseArrayValueMap copy = *map;
-            SparseArrayValueMap::iterator end = copy.end();
-            for (SparseArrayValueMap::iterator it = copy.begin(); it != end; ++it) {
-                if (it->first >= newLength)
-                    map->remove(it->first);
-            }
+            map->removeFrom(newLength);
             if (map->isEmpty()) {
                 delete map;
                 storage->m_sparseValueMap = 0;
@@ -615,6 +625,9 @@ void JSArray::push(ExecState* exec, JSValue value)
 {
     checkConsistency();
 
+    updateVectorMode(value);
+    Heap::writeBarrier(this, value);
+
     if (m_storage->m_length < m_vectorLength) {
         m_storage->m_vector[m_storage->m_length] = value;
         ++m_storage->m_numValuesInVector;
@@ -1058,6 +1071,9 @@ void JSArray::checkConsistency(ConsistencyCheckType type)
     for (unsigned i = 0; i < m_vectorLength; ++i) {
         if (JSValue value = m_storage->m_vector[i]) {
             ASSERT(i < m_storage->m_length);
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+            ASSERT(m_vectorMode == ValueVector || value.isNumber());
+#endif
             if (type != DestructorConsistencyCheck)
                 value->type(); // Likely to crash if the object was deallocated.
             ++numValuesInVector;
@@ -1070,13 +1086,19 @@ void JSArray::checkConsistency(ConsistencyCheckType type)
     ASSERT(numValuesInVector <= m_storage->m_length);
 
     if (m_storage->m_sparseValueMap) {
+        unsigned previousIndex = 0;
         SparseArrayValueMap::iterator end = m_storage->m_sparseValueMap->end();
         for (SparseArrayValueMap::iterator it = m_storage->m_sparseValueMap->begin(); it != end; ++it) {
             unsigned index = it->first;
+            ASSERT(it == m_storage->m_sparseValueMap->begin() || index > previousIndex);
+            previousIndex = index;
             ASSERT(index < m_storage->m_length);
             ASSERT(index >= m_vectorLength);
             ASSERT(index <= MAX_ARRAY_INDEX);
             ASSERT(it->second);
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+            ASSERT(m_vectorMode == ValueVector || it->second.isNumber());
+#endif
             if (type != DestructorConsistencyCheck)
                 it->second->type(); // Likely to crash if the object was deallocated.
         }
@@ -22,11 +22,10 @@
 #define JSArray_h
 
 #include "JSObject.h"
+#include "SparseArrayValueMap.h"
 
 namespace JSC {
 
-    typedef HashMap<unsigned, JSValue> SparseArrayValueMap;
-
     struct ArrayStorage {
         unsigned m_length;
         unsigned m_numValuesInVector;
@@ -41,6 +40,13 @@ namespace JSC {
         friend class Walker;
 
     public:
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+        // Numbers are stored unboxed in a JSValue, so an array that has only ever held
+        // numbers, in its vector or its sparse map, has nothing for the collector to mark
+        // and needs no write barrier. Storing anything else makes it a ValueVector for good.
+        enum VectorMode { NumberVector, ValueVector };
+#endif
+
         explicit JSArray(NonNullPassRefPtr<Structure>);
         JSArray(NonNullPassRefPtr<Structure>, unsigned initialLength);
         JSArray(NonNullPassRefPtr<Structure>, const ArgList& initialValues);
@@ -74,6 +80,8 @@ namespace JSC {
         void setIndex(unsigned i, JSValue v)
         {
             ASSERT(canSetIndex(i));
+            updateVectorMode(v);
+            Heap::writeBarrier(this, v);
             JSValue& x = m_storage->m_vector[i];
             if (!x) {
                 ++m_storage->m_numValuesInVector;
@@ -115,6 +123,16 @@ namespace JSC {
         void putSlowCase(ExecState*, unsigned propertyName, JSValue);
 
         bool increaseVectorLength(unsigned newLength);
+
+        void updateVectorMode(JSValue value)
+        {
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+            if (m_vectorMode == NumberVector && !value.isNumber())
+                m_vectorMode = ValueVector;
+#else
+            UNUSED_PARAM(value);
+#endif
+        }
         
         unsigned compactForSorting();
 
@@ -122,6 +140,9 @@ namespace JSC {
         void checkConsistency(ConsistencyCheckType = NormalConsistencyCheck);
 
         unsigned m_vectorLength;
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+        unsigned m_vectorMode;
+#endif
         ArrayStorage* m_storage;
     };
 
@@ -160,6 +181,11 @@ namespace JSC {
     {
         JSObject::markChildrenDirect(markStack);
         
+#if ENABLE(NUMBER_ARRAY_STORAGE)
+        if (m_vectorMode == NumberVector)
+            return;
+#endif
+
         ArrayStorage* storage = m_storage;
 
         unsigned usedVectorLength = std::min(storage->m_length, m_vectorLength);
@@ -191,10 +217,25 @@ namespace JSC {
             asArray(cell)->markChildrenDirect(*this);
             return;
         }
+        if (UNLIKELY(m_rememberedCells != 0) && !Heap::hasBarrieredChildren(cell))
+            m_rememberedCells->append(cell);
         cell->markChildren(*this);
     }
 
     inline void MarkStack::drain()
+    {
+#if ENABLE(PARALLEL_GC)
+        // Some cells mark their children by draining, so a drain may be nested in
+        // another one, possibly on a helper thread.
+        if (m_parallelMarker && !m_isMarkingInParallel) {
+            m_parallelMarker->drain(*this);
+            return;
+        }
+#endif
+        drainLocally();
+    }
+
+    inline void MarkStack::drainLocally()
     {
         while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
             while (!m_markSets.isEmpty() && m_values.size() < 50) {
@@ -210,7 +251,7 @@ namespace JSC {
                 current.m_values++;
 
                 JSCell* cell;
-                if (!value || !value.isCell() || Heap::isCellMarked(cell = value.asCell())) {
+                if (!value || !value.isCell() || testAndSetMarked(cell = value.asCell())) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
                         continue;
@@ -218,7 +259,6 @@ namespace JSC {
                     goto findNextUnmarkedNullValue;
                 }
 
-                Heap::markCell(cell);
                 if (cell->structure()->typeInfo().type() < CompoundType) {
                     if (current.m_values == end) {
                         m_markSets.removeLast();
@@ -231,11 +271,28 @@ namespace JSC {
                     m_markSets.removeLast();
 
                 markChildren(cell);
+#if ENABLE(PARALLEL_GC)
+                donateIfNeeded();
+#endif
             }
-            while (!m_values.isEmpty())
+            while (!m_values.isEmpty()) {
                 markChildren(m_values.removeLast());
+#if ENABLE(PARALLEL_GC)
+                donateIfNeeded();
+#endif
+            }
         }
     }
+
+#if ENABLE(PARALLEL_GC)
+    ALWAYS_INLINE void MarkStack::donateIfNeeded()
+    {
+        // Checking for idle threads only every so often keeps the cost of sharing
+        // work out of the common path.
+        if (m_isMarkingInParallel && !(++m_cellsSinceDonationCheck & 0x3F))
+            m_parallelMarker->donateIfNeeded(*this);
+    }
+#endif
     
 } // namespace JSC
 
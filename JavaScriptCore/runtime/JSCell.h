@@ -181,7 +181,9 @@ namespace JSC {
 
     inline void* JSCell::operator new(size_t size, ExecState* exec)
     {
-        return exec->heap()->allocate(size);
+        Heap* heap = exec->heap();
+        heap->willAllocate(exec);
+        return heap->allocate(size);
     }
 
     // --- JSValue inlines ----------------------------
@@ -338,9 +340,32 @@ namespace JSC {
     {
         ASSERT(!m_isCheckingForDefaultMarkViolation);
         ASSERT(cell);
-        if (Heap::isCellMarked(cell))
+        if (testAndSetMarked(cell))
             return;
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+
+    // Marks the cell, and returns whether it was already marked.
+    ALWAYS_INLINE bool MarkStack::testAndSetMarked(JSCell* cell)
+    {
+        if (UNLIKELY(m_references != 0)) {
+            m_references->append(cell);
+            return true;
+        }
+#if ENABLE(PARALLEL_GC)
+        if (m_isMarkingInParallel)
+            return Heap::testAndSetMarkedConcurrently(cell);
+#endif
+        if (Heap::isCellMarked(cell))
+            return true;
         Heap::markCell(cell);
+        return false;
+    }
+
+    inline void MarkStack::appendChildren(JSCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
@@ -352,6 +377,12 @@ namespace JSC {
             append(value.asCell());
     }
 
+    inline void Heap::writeBarrier(const JSCell* owner, JSValue value)
+    {
+        if (value.isCell())
+            writeBarrier(owner);
+    }
+
     inline Heap* Heap::heap(JSValue v)
     {
         if (!v.isCell())
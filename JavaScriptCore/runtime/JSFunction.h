@@ -50,7 +50,11 @@ namespace JSC {
         JSObject* construct(ExecState*, const ArgList&);
         JSValue call(ExecState*, JSValue thisValue, const ArgList&);
 
-        void setScope(const ScopeChain& scopeChain) { setScopeChain(scopeChain); }
+        void setScope(const ScopeChain& scopeChain)
+        {
+            Heap::writeBarrier(this);
+            setScopeChain(scopeChain);
+        }
         ScopeChain& scope() { return scopeChain(); }
 
         ExecutableBase* executable() const { return m_executable.get(); }
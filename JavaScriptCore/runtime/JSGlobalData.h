@@ -36,6 +36,7 @@
 #include "JITStubs.h"
 #include "JSValue.h"
 #include "MarkStack.h"
+#include "MegamorphicCache.h"
 #include "NumericStrings.h"
 #include "SmallStrings.h"
 #include "Terminator.h"
@@ -43,6 +44,7 @@
 #include "WeakRandom.h"
 #include <wtf/Forward.h>
 #include <wtf/HashMap.h>
+#include <wtf/OwnPtr.h>
 #include <wtf/RefCounted.h>
 
 struct OpaqueJSClass;
@@ -50,6 +52,7 @@ struct OpaqueJSClassContextData;
 
 namespace JSC {
 
+    class BytecodeCache;
     class CodeBlock;
     class CommonIdentifiers;
     class IdentifierTable;
@@ -59,6 +62,7 @@ namespace JSC {
     class Lexer;
     class Parser;
     class RegExpCache;
+    class SamplingProfiler;
     class Stringifier;
     class Structure;
     class UString;
@@ -121,6 +125,12 @@ namespace JSC {
         void makeUsableFromMultipleThreads() { heap.makeUsableFromMultipleThreads(); }
 #endif
 
+#if ENABLE(PARALLEL_GC)
+        // Threads that mark alongside the collecting thread; zero disables parallel marking.
+        void setMarkingHelperThreadCount(unsigned count) { heap.setMarkingHelperThreadCount(count); }
+        unsigned markingHelperThreadCount() const { return heap.markingHelperThreadCount(); }
+#endif
+
         GlobalDataType globalDataType;
         ClientData* clientData;
 
@@ -176,15 +186,24 @@ namespace JSC {
         Lexer* lexer;
         Parser* parser;
         Interpreter* interpreter;
+#if ENABLE(BYTECODE_CACHE)
+        // Programs are loaded from and stored to this cache when it is set.
+        OwnPtr<BytecodeCache> bytecodeCache;
+#endif
 #if ENABLE(JIT)
         JITThunks jitStubs;
         NativeExecutable* getThunk(ThunkGenerator generator)
         {
             return jitStubs.specializedThunk(this, generator);
         }
+        MegamorphicCache megamorphicCache;
 #endif
         TimeoutChecker timeoutChecker;
         Terminator terminator;
+#if ENABLE(SAMPLING_PROFILER)
+        // Created the first time call stacks are sampled; see JSContextStartSamplingProfiler().
+        OwnPtr<SamplingProfiler> samplingProfiler;
+#endif
         Heap heap;
 
         JSValue exception;
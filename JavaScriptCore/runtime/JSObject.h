@@ -193,7 +193,11 @@ namespace JSC {
 
         // Fast access to known property offsets.
         JSValue getDirectOffset(size_t offset) const { return JSValue::decode(propertyStorage()[offset]); }
-        void putDirectOffset(size_t offset, JSValue value) { propertyStorage()[offset] = JSValue::encode(value); }
+        void putDirectOffset(size_t offset, JSValue value)
+        {
+            Heap::writeBarrier(this, value);
+            propertyStorage()[offset] = JSValue::encode(value);
+        }
 
         void fillGetterPropertySlot(PropertySlot&, JSValue* location);
 
@@ -239,6 +243,7 @@ namespace JSC {
         void putAnonymousValue(unsigned index, JSValue value)
         {
             ASSERT(index < m_structure->anonymousSlotCount());
+            Heap::writeBarrier(this, value);
             *locationForOffset(index) = value;
         }
         JSValue getAnonymousValue(unsigned index) const
@@ -314,8 +319,10 @@ inline JSObject::JSObject(NonNullPassRefPtr<Structure> structure)
 inline JSObject::~JSObject()
 {
     ASSERT(m_structure);
-    if (!isUsingInlineStorage())
-        delete [] m_externalStorage;
+    if (!isUsingInlineStorage()) {
+        if (m_structure->propertyStorageCapacity() != nonInlineBaseStorageCapacity || !Heap::heap(this)->addFreePropertyStorage(m_externalStorage))
+            delete [] m_externalStorage;
+    }
     m_structure->deref();
 }
 
@@ -333,6 +340,8 @@ inline void JSObject::setPrototype(JSValue prototype)
 
 inline void JSObject::setStructure(NonNullPassRefPtr<Structure> structure)
 {
+    // The new structure may have a different prototype.
+    Heap::writeBarrier(this);
     m_structure->deref();
     m_structure = structure.releaseRef(); // ~JSObject balances this ref()
 }
@@ -716,13 +725,19 @@ ALWAYS_INLINE void JSObject::allocatePropertyStorageInline(size_t oldSize, size_
     bool wasInline = (oldSize == JSObject::inlineStorageCapacity);
 
     PropertyStorage oldPropertyStorage = (wasInline ? m_inlineStorage : m_externalStorage);
-    PropertyStorage newPropertyStorage = new EncodedJSValue[newSize];
+    PropertyStorage newPropertyStorage = 0;
+    if (newSize == nonInlineBaseStorageCapacity)
+        newPropertyStorage = Heap::heap(this)->takeFreePropertyStorage();
+    if (!newPropertyStorage)
+        newPropertyStorage = new EncodedJSValue[newSize];
 
     for (unsigned i = 0; i < oldSize; ++i)
        newPropertyStorage[i] = oldPropertyStorage[i];
 
-    if (!wasInline)
-        delete [] oldPropertyStorage;
+    if (!wasInline) {
+        if (oldSize != nonInlineBaseStorageCapacity || !Heap::heap(this)->addFreePropertyStorage(oldPropertyStorage))
+            delete [] oldPropertyStorage;
+    }
 
     m_externalStorage = newPropertyStorage;
 }
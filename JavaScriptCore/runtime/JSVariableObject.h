@@ -135,6 +135,7 @@ namespace JSC {
             return false;
         if (entry.isReadOnly())
             return true;
+        Heap::writeBarrier(this, value);
         registerAt(entry.getIndex()) = value;
         return true;
     }
@@ -149,6 +150,7 @@ namespace JSC {
         SymbolTableEntry& entry = iter->second;
         ASSERT(!entry.isNull());
         entry.setAttributes(attributes);
+        Heap::writeBarrier(this, value);
         registerAt(entry.getIndex()) = value;
         return true;
     }
@@ -164,6 +166,7 @@ namespace JSC {
     inline void JSVariableObject::setRegisters(Register* registers, Register* registerArray)
     {
         ASSERT(registerArray != d->registerArray.get());
+        Heap::writeBarrier(this);
         d->registerArray.set(registerArray);
         d->registers = registers;
     }
@@ -60,6 +60,7 @@ namespace JSC {
     {
         ASSERT(value);
         ASSERT(!value.isObject());
+        Heap::writeBarrier(this, value);
         m_internalValue = value;
         putAnonymousValue(0, value);
     }
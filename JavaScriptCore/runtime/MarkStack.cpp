@@ -26,6 +26,8 @@
 #include "config.h"
 #include "MarkStack.h"
 
+#include "JSArray.h"
+
 namespace JSC {
 
 size_t MarkStack::s_pageSize = 0;
@@ -37,4 +39,213 @@ void MarkStack::compact()
     m_markSets.shrinkAllocation(s_pageSize);
 }
 
+void MarkStack::appendReferences(JSCell* cell, Vector<JSCell*>& references)
+{
+    ASSERT(m_markSets.isEmpty());
+    ASSERT(m_values.isEmpty());
+
+    // Cells appended while m_references is set are recorded instead of marked,
+    // so only the value arrays are left on the stack.
+    m_references = &references;
+    cell->markChildren(*this);
+    m_references = 0;
+
+    while (!m_markSets.isEmpty()) {
+        MarkSet set = m_markSets.removeLast();
+        for (JSValue* value = set.m_values; value != set.m_end; ++value) {
+            if (*value && value->isCell())
+                references.append(value->asCell());
+        }
+    }
+}
+
+#if ENABLE(PARALLEL_GC)
+
+struct ParallelMarker::Helper {
+    Helper(ParallelMarker* marker, void* jsArrayVPtr)
+        : marker(marker)
+        , markStack(jsArrayVPtr)
+        , thread(0)
+    {
+    }
+
+    ParallelMarker* marker;
+    MarkStack markStack;
+    Vector<JSCell*> rememberedCells;
+    ThreadIdentifier thread;
+};
+
+ParallelMarker::ParallelMarker(void* jsArrayVPtr, unsigned helperThreadCount)
+    : m_sharedWorkCount(0)
+    , m_activeMarkers(0)
+    , m_waitingMarkers(0)
+    , m_shouldExit(false)
+{
+    m_markStacks.append(0);
+    for (unsigned i = 0; i < helperThreadCount; ++i) {
+        Helper* helper = new Helper(this, jsArrayVPtr);
+        helper->markStack.m_parallelMarker = this;
+        helper->markStack.m_isMarkingInParallel = true;
+        m_helpers.append(helper);
+        m_markStacks.append(&helper->markStack);
+    }
+
+    for (size_t i = 0; i < m_helpers.size(); ++i)
+        m_helpers[i]->thread = createThread(helperThreadEntryPoint, m_helpers[i], "JavaScriptCore::Marking");
+}
+
+ParallelMarker::~ParallelMarker()
+{
+    {
+        MutexLocker locker(m_lock);
+        m_shouldExit = true;
+        m_condition.broadcast();
+    }
+
+    for (size_t i = 0; i < m_helpers.size(); ++i)
+        waitForThreadCompletion(m_helpers[i]->thread, 0);
+    deleteAllValues(m_helpers);
+}
+
+void* ParallelMarker::helperThreadEntryPoint(void* argument)
+{
+    Helper* helper = static_cast<Helper*>(argument);
+    helper->marker->helperThreadMain(helper->markStack);
+    return 0;
+}
+
+void ParallelMarker::helperThreadMain(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    while (true) {
+        while (!m_sharedWorkCount && !m_shouldExit) {
+            ++m_waitingMarkers;
+            m_condition.wait(m_lock);
+            --m_waitingMarkers;
+        }
+        if (m_shouldExit)
+            return;
+
+        steal(markStack);
+        ++m_activeMarkers;
+
+        m_lock.unlock();
+        markStack.drainLocally();
+        m_lock.lock();
+
+        // The collecting thread waits for every marker to run out of work.
+        if (!--m_activeMarkers)
+            m_condition.broadcast();
+    }
+}
+
+void ParallelMarker::drain(MarkStack& markStack)
+{
+    {
+        MutexLocker locker(m_lock);
+        ASSERT(!m_activeMarkers);
+        ASSERT(!m_sharedWorkCount);
+        m_markStacks[0] = &markStack;
+        for (size_t i = 0; i < m_helpers.size(); ++i)
+            m_helpers[i]->markStack.setRememberedCells(markStack.m_rememberedCells ? &m_helpers[i]->rememberedCells : 0);
+        m_activeMarkers = 1;
+    }
+
+    markStack.m_isMarkingInParallel = true;
+    while (true) {
+        markStack.drainLocally();
+
+        MutexLocker locker(m_lock);
+        --m_activeMarkers;
+        while (!m_sharedWorkCount && m_activeMarkers) {
+            ++m_waitingMarkers;
+            m_condition.wait(m_lock);
+            --m_waitingMarkers;
+        }
+        // No shared work and no active marker means marking is complete.
+        if (!steal(markStack))
+            break;
+        ++m_activeMarkers;
+    }
+    markStack.m_isMarkingInParallel = false;
+
+    if (markStack.m_rememberedCells) {
+        for (size_t i = 0; i < m_helpers.size(); ++i) {
+            markStack.m_rememberedCells->append(m_helpers[i]->rememberedCells);
+            m_helpers[i]->rememberedCells.clear();
+        }
+    }
+}
+
+void ParallelMarker::donate(MarkStack& markStack)
+{
+    MutexLocker locker(m_lock);
+    if (m_sharedWorkCount || !m_waitingMarkers)
+        return;
+
+    // The oldest entries are given away, since they tend to lead to the most work.
+    size_t valueCount = markStack.m_values.size() / 2;
+    markStack.m_values.removeFirst(valueCount, markStack.m_sharedValues);
+    size_t markSetCount = markStack.m_markSets.size() / 2;
+    markStack.m_markSets.removeFirst(markSetCount, markStack.m_sharedMarkSets);
+    size_t donated = valueCount + markSetCount;
+
+    // Mark sets cover whole arrays and register files, so the last one is split
+    // when it is all there is to give away.
+
+    if (!markSetCount && !markStack.m_markSets.isEmpty()) {
+        MarkStack::MarkSet& current = markStack.m_markSets.last();
+        size_t remaining = current.m_end - current.m_values;
+        if (remaining >= 512) {
+            JSValue* middle = current.m_values + remaining / 2;
+            markStack.m_sharedMarkSets.append(MarkStack::MarkSet(middle, current.m_end, current.m_properties));
+            current.m_end = middle;
+            ++donated;
+        }
+    }
+
+    if (!donated)
+        return;
+    m_sharedWorkCount += donated;
+    m_condition.broadcast();
+}
+
+bool ParallelMarker::steal(MarkStack& markStack)
+{
+    // Called with m_lock held.
+    if (!m_sharedWorkCount)
+        return false;
+
+    for (size_t i = 0; i < m_markStacks.size(); ++i) {
+        MarkStack* victim = m_markStacks[i];
+        size_t markSetCount = (victim->m_sharedMarkSets.size() + 1) / 2;
+        size_t valueCount = (victim->m_sharedValues.size() + 1) / 2;
+        if (!markSetCount && !valueCount)
+            continue;
+
+        // Taking half leaves the rest for other idle threads.
+        for (size_t j = 0; j < markSetCount; ++j) {
+            markStack.m_markSets.append(victim->m_sharedMarkSets.last());
+            victim->m_sharedMarkSets.removeLast();
+        }
+        for (size_t j = 0; j < valueCount; ++j) {
+            markStack.m_values.append(victim->m_sharedValues.last());
+            victim->m_sharedValues.removeLast();
+        }
+        m_sharedWorkCount -= markSetCount + valueCount;
+        return true;
+    }
+
+    ASSERT_NOT_REACHED();
+    return false;
+}
+
+void ParallelMarker::compact()
+{
+    for (size_t i = 0; i < m_helpers.size(); ++i)
+        m_helpers[i]->markStack.compact();
+}
+
+#endif
+
 }
@@ -28,10 +28,13 @@
 
 #include "JSValue.h"
 #include <wtf/Noncopyable.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
 
 namespace JSC {
 
     class JSGlobalData;
+    class ParallelMarker;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
@@ -40,6 +43,13 @@ namespace JSC {
     public:
         MarkStack(void* jsArrayVPtr)
             : m_jsArrayVPtr(jsArrayVPtr)
+            , m_rememberedCells(0)
+            , m_references(0)
+#if ENABLE(PARALLEL_GC)
+            , m_parallelMarker(0)
+            , m_isMarkingInParallel(false)
+            , m_cellsSinceDonationCheck(0)
+#endif
 #ifndef NDEBUG
             , m_isCheckingForDefaultMarkViolation(false)
 #endif
@@ -48,6 +58,28 @@ namespace JSC {
 
         ALWAYS_INLINE void append(JSValue);
         void append(JSCell*);
+
+        // Traces the children of a cell that is already marked. Minor collections
+        // use this for the cells in the remembered set.
+        void appendChildren(JSCell*);
+
+        // Lists the cells a cell references, without marking anything. Heap
+        // snapshots use this.
+        void appendReferences(JSCell*, Vector<JSCell*>& references);
+
+        // While set, cells whose children are not covered by the write barrier are
+        // added to this list as they are traced.
+        void setRememberedCells(Vector<JSCell*>* rememberedCells) { m_rememberedCells = rememberedCells; }
+        void remember(JSCell* cell)
+        {
+            if (m_rememberedCells)
+                m_rememberedCells->append(cell);
+        }
+
+#if ENABLE(PARALLEL_GC)
+        // While set, drain() shares its work with the marker's helper threads.
+        void setParallelMarker(ParallelMarker* parallelMarker) { m_parallelMarker = parallelMarker; }
+#endif
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -70,7 +102,14 @@ namespace JSC {
         }
 
     private:
+        friend class ParallelMarker;
+
         void markChildren(JSCell*);
+        bool testAndSetMarked(JSCell*);
+        inline void drainLocally();
+#if ENABLE(PARALLEL_GC)
+        void donateIfNeeded();
+#endif
 
         struct MarkSet {
             MarkSet(JSValue* values, JSValue* end, MarkSetProperties properties)
@@ -134,6 +173,15 @@ namespace JSC {
                 return m_data[--m_top];
             }
             
+            // Moves the count oldest entries to the end of destination.
+            void removeFirst(size_t count, Vector<T>& destination)
+            {
+                ASSERT(count <= m_top);
+                destination.append(m_data, count);
+                memmove(m_data, m_data + count, (m_top - count) * sizeof(T));
+                m_top -= count;
+            }
+
             inline T& last()
             {
                 ASSERT(m_top);
@@ -173,15 +221,70 @@ namespace JSC {
         };
 
         void* m_jsArrayVPtr;
+        Vector<JSCell*>* m_rememberedCells;
+        Vector<JSCell*>* m_references;
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
 
+#if ENABLE(PARALLEL_GC)
+        ParallelMarker* m_parallelMarker;
+        bool m_isMarkingInParallel;
+        unsigned m_cellsSinceDonationCheck;
+        // Work published for other marking threads to steal, guarded by the
+        // parallel marker's lock.
+        Vector<JSCell*> m_sharedValues;
+        Vector<MarkSet> m_sharedMarkSets;
+#endif
+
 #ifndef NDEBUG
     public:
         bool m_isCheckingForDefaultMarkViolation;
 #endif
     };
+
+#if ENABLE(PARALLEL_GC)
+    // Helper threads that mark alongside the collecting thread. Every thread drains
+    // its own MarkStack; a thread that notices another one waiting for work moves
+    // part of its stack into a shared list, which idle threads steal from.
+    class ParallelMarker : public Noncopyable {
+    public:
+        ParallelMarker(void* jsArrayVPtr, unsigned helperThreadCount);
+        ~ParallelMarker();
+
+        unsigned helperThreadCount() const { return m_helpers.size(); }
+
+        // Marks everything reachable from markStack, using every thread. Called on
+        // the collecting thread; the helper threads are idle again on return.
+        void drain(MarkStack&);
+
+        void donateIfNeeded(MarkStack& markStack)
+        {
+            if (m_waitingMarkers)
+                donate(markStack);
+        }
+
+        void compact();
+
+    private:
+        struct Helper;
+
+        static void* helperThreadEntryPoint(void*);
+        void helperThreadMain(MarkStack&);
+        void donate(MarkStack&);
+        bool steal(MarkStack&);
+
+        Vector<Helper*> m_helpers;
+        Vector<MarkStack*> m_markStacks; // The collecting thread's stack comes first.
+
+        Mutex m_lock;
+        ThreadCondition m_condition;
+        size_t m_sharedWorkCount;
+        unsigned m_activeMarkers;
+        volatile unsigned m_waitingMarkers;
+        bool m_shouldExit;
+    };
+#endif
 }
 
 #endif
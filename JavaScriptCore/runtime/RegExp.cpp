@@ -34,9 +34,8 @@
 #include "yarr/RegexCompiler.h"
 #if ENABLE(YARR_JIT)
 #include "yarr/RegexJIT.h"
-#else
-#include "yarr/RegexInterpreter.h"
 #endif
+#include "yarr/RegexInterpreter.h"
 
 #else
 
@@ -98,10 +97,12 @@ void RegExp::compile(JSGlobalData* globalData)
 {
 #if ENABLE(YARR_JIT)
     Yarr::jitCompileRegex(globalData, m_regExpJITCode, m_pattern, m_numSubpatterns, m_constructionError, ignoreCase(), multiline());
+    if (!m_regExpJITCode.isFallBack())
+        return;
 #else
     UNUSED_PARAM(globalData);
-    m_regExpBytecode.set(Yarr::byteCompileRegex(m_pattern, m_numSubpatterns, m_constructionError, ignoreCase(), multiline()));
 #endif
+    m_regExpBytecode.set(Yarr::byteCompileRegex(m_pattern, m_numSubpatterns, m_constructionError, ignoreCase(), multiline()));
 }
 
 int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
@@ -131,11 +132,11 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
     }
 
 #if ENABLE(YARR_JIT)
-    if (!!m_regExpJITCode) {
+    if (!!m_regExpJITCode || m_regExpBytecode) {
 #else
     if (m_regExpBytecode) {
 #endif
-        int offsetVectorSize = (m_numSubpatterns + 1) * 3; // FIXME: should be 2 - but adding temporary fallback to pcre.
+        int offsetVectorSize = (m_numSubpatterns + 1) * 2;
         int* offsetVector;
         Vector<int, 32> nonReturnedOvector;
         if (ovector) {
@@ -151,11 +152,13 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
             offsetVector[j] = -1;
 
 
+        int result;
 #if ENABLE(YARR_JIT)
-        int result = Yarr::executeRegex(m_regExpJITCode, s.data(), startOffset, s.size(), offsetVector, offsetVectorSize);
-#else
-        int result = Yarr::interpretRegex(m_regExpBytecode.get(), s.data(), startOffset, s.size(), offsetVector);
+        if (!!m_regExpJITCode)
+            result = Yarr::executeRegex(m_regExpJITCode, s.data(), startOffset, s.size(), offsetVector);
+        else
 #endif
+            result = Yarr::interpretRegex(m_regExpBytecode.get(), s.data(), startOffset, s.size(), offsetVector);
 
         if (result < 0) {
 #ifndef NDEBUG
@@ -78,9 +78,11 @@ namespace JSC {
 #endif
         Vector<int, 32> m_lastOVector;
 
+#if ENABLE(YARR)
 #if ENABLE(YARR_JIT)
         Yarr::RegexCodeBlock m_regExpJITCode;
-#elif ENABLE(YARR)
+#endif
+        // Without YARR_JIT every pattern is interpreted; with it, only those the JIT cannot compile.
         OwnPtr<Yarr::BytecodePattern> m_regExpBytecode;
 #else
         JSRegExp* m_regExp;
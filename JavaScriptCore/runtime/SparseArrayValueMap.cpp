@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SparseArrayValueMap.h"
+
+namespace JSC {
+
+size_t SparseArrayValueMap::segmentFor(unsigned index) const
+{
+    // The last segment that starts at or below the index, or the first segment.
+    ASSERT(!m_segments.isEmpty());
+    size_t low = 0;
+    size_t high = m_segments.size();
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (m_segments[middle]->at(0).first <= index)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+size_t SparseArrayValueMap::indexInSegment(const Segment& segment, unsigned index)
+{
+    size_t low = 0;
+    size_t high = segment.size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (segment[middle].first < index)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+SparseArrayValueMap::iterator SparseArrayValueMap::lowerBound(unsigned index) const
+{
+    if (m_segments.isEmpty())
+        return end();
+    size_t segment = segmentFor(index);
+    size_t position = indexInSegment(*m_segments[segment], index);
+    if (position == m_segments[segment]->size())
+        return iterator(&m_segments, segment + 1, 0);
+    return iterator(&m_segments, segment, position);
+}
+
+SparseArrayValueMap::iterator SparseArrayValueMap::find(unsigned index) const
+{
+    iterator it = lowerBound(index);
+    if (it != end() && it->first == index)
+        return it;
+    return end();
+}
+
+std::pair<SparseArrayValueMap::iterator, bool> SparseArrayValueMap::add(unsigned index, JSValue value)
+{
+    if (m_segments.isEmpty()) {
+        Segment* segment = new Segment;
+        segment->append(Entry(index, value));
+        m_segments.append(segment);
+        m_size = 1;
+        return std::make_pair(begin(), true);
+    }
+
+    size_t segmentIndex = segmentFor(index);
+    Segment* segment = m_segments[segmentIndex];
+    size_t position = indexInSegment(*segment, index);
+    if (position < segment->size() && segment->at(position).first == index)
+        return std::make_pair(iterator(&m_segments, segmentIndex, position), false);
+
+    segment->insert(position, Entry(index, value));
+    ++m_size;
+
+    if (segment->size() > maxSegmentSize) {
+        size_t half = segment->size() / 2;
+        Segment* upper = new Segment;
+        upper->append(segment->data() + half, segment->size() - half);
+        segment->shrink(half);
+        m_segments.insert(segmentIndex + 1, upper);
+        if (position >= half) {
+            ++segmentIndex;
+            position -= half;
+        }
+    }
+
+    return std::make_pair(iterator(&m_segments, segmentIndex, position), true);
+}
+
+JSValue SparseArrayValueMap::take(unsigned index)
+{
+    iterator it = find(index);
+    if (it == end())
+        return JSValue();
+    JSValue value = it->second;
+    remove(it);
+    return value;
+}
+
+void SparseArrayValueMap::remove(iterator it)
+{
+    ASSERT(it != end());
+    Segment* segment = m_segments[it.m_segment];
+    segment->remove(it.m_index);
+    --m_size;
+    if (segment->isEmpty()) {
+        delete segment;
+        m_segments.remove(it.m_segment);
+    }
+}
+
+void SparseArrayValueMap::removeFrom(unsigned index)
+{
+    if (m_segments.isEmpty())
+        return;
+
+    size_t segmentIndex = segmentFor(index);
+    Segment* segment = m_segments[segmentIndex];
+    size_t position = indexInSegment(*segment, index);
+    m_size -= segment->size() - position;
+    segment->shrink(position);
+
+    size_t firstRemoved = segment->isEmpty() ? segmentIndex : segmentIndex + 1;
+    for (size_t i = firstRemoved; i < m_segments.size(); ++i) {
+        if (i != segmentIndex)
+            m_size -= m_segments[i]->size();
+        delete m_segments[i];
+    }
+    m_segments.shrink(firstRemoved);
+}
+
+size_t SparseArrayValueMap::count(unsigned start, unsigned limit) const
+{
+    size_t result = 0;
+    iterator end = this->end();
+    for (iterator it = lowerBound(start); it != end && it->first < limit; ++it)
+        ++result;
+    return result;
+}
+
+void SparseArrayValueMap::takeRange(unsigned start, unsigned limit, JSValue* vector)
+{
+    if (m_segments.isEmpty())
+        return;
+
+    size_t segmentIndex = segmentFor(start);
+    size_t position = indexInSegment(*m_segments[segmentIndex], start);
+    while (segmentIndex < m_segments.size()) {
+        Segment* segment = m_segments[segmentIndex];
+        size_t taken = position;
+        for (; taken < segment->size() && segment->at(taken).first < limit; ++taken)
+            vector[segment->at(taken).first] = segment->at(taken).second;
+        segment->remove(position, taken - position);
+        m_size -= taken - position;
+
+        if (segment->isEmpty()) {
+            delete segment;
+            m_segments.remove(segmentIndex);
+        } else if (position < segment->size())
+            return;
+        else
+            ++segmentIndex;
+        position = 0;
+    }
+}
+
+} // namespace JSC
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2011 Adobe Systems Incorporated.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Adobe Systems Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ADOBE SYSTEMS INCORPORATED "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ADOBE SYSTEMS INCORPORATED
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SparseArrayValueMap_h
+#define SparseArrayValueMap_h
+
+#include "JSValue.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    // The values of a JSArray that live outside its storage vector, kept in index order.
+    // Entries are held in short sorted segments: a lookup is two binary searches, an
+    // insertion moves at most one segment, and walks, truncations and moves of whole
+    // ranges back into the vector visit only the entries involved.
+    class SparseArrayValueMap : public Noncopyable {
+    public:
+        typedef std::pair<unsigned, JSValue> Entry;
+
+    private:
+        typedef Vector<Entry> Segment;
+        static const size_t maxSegmentSize = 64;
+
+    public:
+        class iterator {
+        public:
+            iterator()
+                : m_segments(0)
+                , m_segment(0)
+                , m_index(0)
+            {
+            }
+
+            Entry& operator*() const { return (*m_segments)[m_segment]->at(m_index); }
+            Entry* operator->() const { return &**this; }
+
+            iterator& operator++()
+            {
+                if (++m_index == (*m_segments)[m_segment]->size()) {
+                    ++m_segment;
+                    m_index = 0;
+                }
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const { return m_segment == other.m_segment && m_index == other.m_index; }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        private:
+            friend class SparseArrayValueMap;
+
+            iterator(const Vector<Segment*>* segments, size_t segment, size_t index)
+                : m_segments(segments)
+                , m_segment(segment)
+                , m_index(index)
+            {
+            }
+
+            const Vector<Segment*>* m_segments;
+            size_t m_segment;
+            size_t m_index;
+        };
+
+        SparseArrayValueMap()
+            : m_size(0)
+        {
+        }
+
+        ~SparseArrayValueMap() { deleteAllValues(m_segments); }
+
+        iterator begin() const { return iterator(&m_segments, 0, 0); }
+        iterator end() const { return iterator(&m_segments, m_segments.size(), 0); }
+
+        // The first entry whose index is not below the given one.
+        iterator lowerBound(unsigned) const;
+        iterator find(unsigned) const;
+        bool contains(unsigned index) const { return find(index) != end(); }
+
+        // Like HashMap::add, leaves an existing entry alone and returns false with it.
+        std::pair<iterator, bool> add(unsigned, JSValue);
+
+        JSValue take(unsigned);
+        void remove(iterator);
+        void remove(unsigned index)
+        {
+            iterator it = find(index);
+            if (it != end())
+                remove(it);
+        }
+
+        // Removes every entry whose index is not below the given one.
+        void removeFrom(unsigned);
+
+        // The number of entries whose index is in [start, limit).
+        size_t count(unsigned start, unsigned limit) const;
+
+        // Moves the value of every entry whose index is in [start, limit) to vector[index],
+        // and removes the entry.
+        void takeRange(unsigned start, unsigned limit, JSValue* vector);
+
+        size_t size() const { return m_size; }
+        bool isEmpty() const { return !m_size; }
+        size_t capacity() const { return m_segments.size() * maxSegmentSize; }
+
+    private:
+        size_t segmentFor(unsigned) const;
+        static size_t indexInSegment(const Segment&, unsigned);
+
+        Vector<Segment*> m_segments; // Never holds an empty segment.
+        size_t m_size;
+    };
+
+} // namespace JSC
+
+#endif // SparseArrayValueMap_h
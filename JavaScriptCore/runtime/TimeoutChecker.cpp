@@ -32,6 +32,7 @@
 
 #include "CallFrame.h"
 #include "JSGlobalObject.h"
+#include "SamplingProfiler.h"
 
 #if OS(DARWIN)
 #include <mach/mach.h>
@@ -105,6 +106,9 @@ static inline unsigned getCPUTime()
 TimeoutChecker::TimeoutChecker()
     : m_timeoutInterval(0)
     , m_startCount(0)
+#if ENABLE(SAMPLING_PROFILER)
+    , m_samplingProfiler(0)
+#endif
 {
     reset();
 }
@@ -112,11 +116,28 @@ TimeoutChecker::TimeoutChecker()
 void TimeoutChecker::reset()
 {
     m_ticksUntilNextCheck = ticksUntilFirstCheck;
+#if ENABLE(SAMPLING_PROFILER)
+    if (m_samplingProfiler)
+        m_ticksUntilNextCheck = m_samplingProfiler->ticksUntilNextCheck();
+#endif
     m_timeAtLastCheck = 0;
     m_timeExecuting = 0;
 }
 
 bool TimeoutChecker::didTimeOut(ExecState* exec)
+{
+#if ENABLE(SAMPLING_PROFILER)
+    if (m_samplingProfiler) {
+        m_samplingProfiler->didReachCheckpoint(exec);
+        bool timedOut = checkTimeout(exec);
+        m_ticksUntilNextCheck = m_samplingProfiler->ticksUntilNextCheck();
+        return timedOut;
+    }
+#endif
+    return checkTimeout(exec);
+}
+
+bool TimeoutChecker::checkTimeout(ExecState* exec)
 {
     unsigned currentTime = getCPUTime();
     
@@ -34,12 +34,18 @@
 namespace JSC {
 
     class ExecState;
+    class SamplingProfiler;
 
     class TimeoutChecker {
     public:
         TimeoutChecker();
 
         void setTimeoutInterval(unsigned timeoutInterval) { m_timeoutInterval = timeoutInterval; }
+
+#if ENABLE(SAMPLING_PROFILER)
+        // A running sampling profiler takes its samples at the checks, and sets how often they come.
+        void setSamplingProfiler(SamplingProfiler* samplingProfiler) { m_samplingProfiler = samplingProfiler; }
+#endif
         
         unsigned ticksUntilNextCheck() { return m_ticksUntilNextCheck; }
         
@@ -61,11 +67,16 @@ namespace JSC {
         bool didTimeOut(ExecState*);
 
     private:
+        bool checkTimeout(ExecState*);
+
         unsigned m_timeoutInterval;
         unsigned m_timeAtLastCheck;
         unsigned m_timeExecuting;
         unsigned m_startCount;
         unsigned m_ticksUntilNextCheck;
+#if ENABLE(SAMPLING_PROFILER)
+        SamplingProfiler* m_samplingProfiler;
+#endif
     };
 
 } // namespace JSC
@@ -77,6 +77,9 @@ private:
     {
         ASSERT(ptr);
         Heap::markCell(ptr);
+        // Marking makes the cell old, so a minor collection must rescan it for
+        // references stored before this point.
+        Heap::writeBarrier(ptr);
         m_ptr = ptr;
     }
 
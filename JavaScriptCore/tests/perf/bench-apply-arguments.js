@@ -0,0 +1,30 @@
+// Wrappers that forward their arguments with f.apply(this, arguments), as event
+// dispatchers, decorators and class-system "super" helpers do. The forwarded
+// call is compared against calling the target directly.
+function Emitter() { this.count = 0; }
+Emitter.prototype.handle = function(type, x, y) { this.count += x + y; return this.count; };
+Emitter.prototype.fire = function() { return this.handle.apply(this, arguments); };
+Emitter.prototype.fireOne = function(type) { return this.handle.apply(this, arguments); };
+Emitter.prototype.fireDirect = function(type, x, y) { return this.handle(type, x, y); };
+
+function report(name, start, emitter) {
+    print(name + ": " + (new Date - start) + " ms (" + emitter.count + ")");
+}
+
+var emitter = new Emitter();
+var start = new Date;
+for (var i = 0; i < 3000000; ++i)
+    emitter.fire("move", i, 1);
+report("apply(this, arguments)", start, emitter);
+
+emitter = new Emitter();
+start = new Date;
+for (var i = 0; i < 3000000; ++i)
+    emitter.fireOne("move", i, 1);
+report("apply(this, arguments), fewer parameters", start, emitter);
+
+emitter = new Emitter();
+start = new Date;
+for (var i = 0; i < 3000000; ++i)
+    emitter.fireDirect("move", i, 1);
+report("direct call", start, emitter);
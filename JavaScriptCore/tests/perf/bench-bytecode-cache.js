@@ -0,0 +1,231 @@
+// Run with "jsc -B <directory> bench-bytecode-cache.js". Startup for a
+// framework bundle is mostly parsing and generating the code that declares it,
+// so this script defines a lot and runs little.
+var Framework = {};
+
+Framework.extend = function (target, source) {
+    for (var name in source)
+        target[name] = source[name];
+    return target;
+};
+
+Framework.createClass = function (base, members) {
+    function Class() {
+        if (this.initialize)
+            this.initialize.apply(this, arguments);
+    }
+    if (base) {
+        function Surrogate() { }
+        Surrogate.prototype = base.prototype;
+        Class.prototype = new Surrogate();
+        Class.prototype.constructor = Class;
+        Class.superclass = base.prototype;
+    }
+    Framework.extend(Class.prototype, members);
+    return Class;
+};
+
+Framework.Events = Framework.createClass(null, {
+    initialize: function () { this._listeners = {}; },
+    addEventListener: function (type, listener) {
+        var list = this._listeners[type] || (this._listeners[type] = []);
+        for (var i = 0; i < list.length; ++i) {
+            if (list[i] === listener)
+                return;
+        }
+        list.push(listener);
+    },
+    removeEventListener: function (type, listener) {
+        var list = this._listeners[type];
+        if (!list)
+            return;
+        for (var i = 0; i < list.length; ++i) {
+            if (list[i] === listener) {
+                list.splice(i, 1);
+                return;
+            }
+        }
+    },
+    dispatchEvent: function (type, detail) {
+        var list = this._listeners[type];
+        if (!list)
+            return false;
+        var event = { type: type, target: this, detail: detail, cancelled: false };
+        for (var i = 0; i < list.length; ++i) {
+            try {
+                list[i].call(this, event);
+            } catch (e) {
+                Framework.log("listener for " + type + " threw " + e);
+            }
+        }
+        return !event.cancelled;
+    }
+});
+
+Framework.Collection = Framework.createClass(Framework.Events, {
+    initialize: function (items) {
+        Framework.Collection.superclass.initialize.call(this);
+        this.items = items ? items.slice() : [];
+    },
+    add: function (item) { this.items.push(item); this.dispatchEvent("add", item); },
+    remove: function (item) {
+        var index = this.indexOf(item);
+        if (index < 0)
+            return false;
+        this.items.splice(index, 1);
+        this.dispatchEvent("remove", item);
+        return true;
+    },
+    indexOf: function (item) {
+        for (var i = 0; i < this.items.length; ++i) {
+            if (this.items[i] === item)
+                return i;
+        }
+        return -1;
+    },
+    filter: function (predicate) {
+        var result = [];
+        for (var i = 0; i < this.items.length; ++i) {
+            if (predicate(this.items[i], i))
+                result.push(this.items[i]);
+        }
+        return new Framework.Collection(result);
+    },
+    map: function (transform) {
+        var result = [];
+        for (var i = 0; i < this.items.length; ++i)
+            result.push(transform(this.items[i], i));
+        return result;
+    },
+    sortBy: function (key, descending) {
+        this.items.sort(function (a, b) {
+            var order = a[key] < b[key] ? -1 : a[key] > b[key] ? 1 : 0;
+            return descending ? -order : order;
+        });
+        this.dispatchEvent("sort", key);
+    }
+});
+
+Framework.Format = {
+    pad: function (value, width, character) {
+        var string = String(value);
+        while (string.length < width)
+            string = (character || " ") + string;
+        return string;
+    },
+    number: function (value, decimals) {
+        var factor = Math.pow(10, decimals || 0);
+        var rounded = Math.round(value * factor) / factor;
+        var parts = String(rounded).split(".");
+        parts[0] = parts[0].replace(/\B(?=(\d{3})+(?!\d))/g, ",");
+        return parts.join(".");
+    },
+    date: function (date, pattern) {
+        return pattern.replace(/yyyy|MM|dd|HH|mm|ss/g, function (token) {
+            switch (token) {
+            case "yyyy": return date.getFullYear();
+            case "MM": return Framework.Format.pad(date.getMonth() + 1, 2, "0");
+            case "dd": return Framework.Format.pad(date.getDate(), 2, "0");
+            case "HH": return Framework.Format.pad(date.getHours(), 2, "0");
+            case "mm": return Framework.Format.pad(date.getMinutes(), 2, "0");
+            default: return Framework.Format.pad(date.getSeconds(), 2, "0");
+            }
+        });
+    },
+    escapeHTML: function (string) {
+        return String(string).replace(/&/g, "&amp;").replace(/</g, "&lt;").replace(/>/g, "&gt;").replace(/"/g, "&quot;");
+    }
+};
+
+Framework.Template = Framework.createClass(null, {
+    initialize: function (source) {
+        this.parts = source.split(/(\{\{[^}]*\}\})/);
+    },
+    render: function (context) {
+        var output = [];
+        for (var i = 0; i < this.parts.length; ++i) {
+            var part = this.parts[i];
+            if (part.charAt(0) == "{" && part.charAt(1) == "{") {
+                var path = part.slice(2, -2).split(".");
+                var value = context;
+                for (var j = 0; value != null && j < path.length; ++j)
+                    value = value[path[j]];
+                output.push(Framework.Format.escapeHTML(value == null ? "" : value));
+            } else
+                output.push(part);
+        }
+        return output.join("");
+    }
+});
+
+Framework.Model = Framework.createClass(Framework.Events, {
+    initialize: function (attributes) {
+        Framework.Model.superclass.initialize.call(this);
+        this.attributes = Framework.extend({}, attributes);
+        this.changed = {};
+    },
+    get: function (name) { return this.attributes[name]; },
+    set: function (name, value) {
+        if (this.attributes[name] === value)
+            return;
+        this.attributes[name] = value;
+        this.changed[name] = true;
+        this.dispatchEvent("change", name);
+    },
+    toJSON: function () { return JSON.stringify(this.attributes); },
+    validate: function (rules) {
+        var errors = [];
+        for (var name in rules) {
+            var rule = rules[name], value = this.attributes[name];
+            if (rule.required && (value === undefined || value === ""))
+                errors.push(name + " is required");
+            else if (rule.pattern && !rule.pattern.test(value))
+                errors.push(name + " is not valid");
+            else if (rule.min !== undefined && value < rule.min)
+                errors.push(name + " is too small");
+        }
+        return errors;
+    }
+});
+
+Framework.log = function (message) {
+    Framework.log.messages.push(message);
+};
+Framework.log.messages = [];
+
+Framework.Router = Framework.createClass(Framework.Events, {
+    initialize: function () {
+        Framework.Router.superclass.initialize.call(this);
+        this.routes = [];
+    },
+    route: function (pattern, handler) {
+        var names = [];
+        var source = pattern.replace(/:(\w+)/g, function (match, name) {
+            names.push(name);
+            return "([^/]+)";
+        });
+        this.routes.push({ regexp: new RegExp("^" + source + "$"), names: names, handler: handler });
+    },
+    navigate: function (path) {
+        for (var i = 0; i < this.routes.length; ++i) {
+            var route = this.routes[i], match = route.regexp.exec(path);
+            if (!match)
+                continue;
+            var parameters = {};
+            for (var j = 0; j < route.names.length; ++j)
+                parameters[route.names[j]] = decodeURIComponent(match[j + 1]);
+            route.handler(parameters);
+            this.dispatchEvent("navigate", path);
+            return true;
+        }
+        return false;
+    }
+});
+
+var application = new Framework.Router();
+application.route("/items/:id", function (parameters) {
+    var model = new Framework.Model({ id: parameters.id, name: "Item " + parameters.id, price: 12.5 });
+    var template = new Framework.Template("<h1>{{name}}</h1><p>{{price}}</p>");
+    Framework.log(template.render(model.attributes));
+});
+application.navigate("/items/7");
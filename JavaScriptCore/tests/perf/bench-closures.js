@@ -0,0 +1,48 @@
+// Functions that capture their locals in closures, each call creating and
+// tearing off an activation: callbacks built per call, a counter module, and
+// a helper that only needs an activation for its catch block.
+function each(array, callback) {
+    for (var i = 0; i < array.length; ++i)
+        callback(array[i], i);
+}
+
+function sumScaled(array, scale) {
+    var total = 0;
+    each(array, function(value) { total += value * scale; });
+    return total;
+}
+
+function parse(text) {
+    try {
+        return parseInt(text);
+    } catch (e) {
+        return 0;
+    }
+}
+
+var counter = (function() {
+    var count = 0;
+    return { increment: function(step) { count += step; return count; } };
+})();
+
+function report(name, start, result) {
+    print(name + ": " + (new Date - start) + " ms (" + result + ")");
+}
+
+var values = [1, 2, 3];
+var start = new Date;
+var result = 0;
+for (var i = 0; i < 1000000; ++i)
+    result += sumScaled(values, i & 7);
+report("closure per call", start, result);
+
+start = new Date;
+result = 0;
+for (var i = 0; i < 1000000; ++i)
+    result += parse("12");
+report("activation for catch", start, result);
+
+start = new Date;
+for (var i = 0; i < 3000000; ++i)
+    result = counter.increment(1);
+report("module counter", start, result);
@@ -0,0 +1,34 @@
+// Run with "jsc -F <age> bench-code-flushing.js" to see how much code memory
+// full collections reclaim. An application that sets itself up with a lot of
+// code that runs once, then spends its time in a small loop that allocates.
+var setup = [];
+for (var i = 0; i < 500; ++i) {
+    setup.push(eval("(function setup" + i + "(options) {\n" +
+        "    var widget = { id: " + i + ", children: [], style: {} };\n" +
+        "    for (var name in options)\n" +
+        "        widget.style[name] = options[name] + 'px';\n" +
+        "    for (var j = 0; j < options.count; ++j)\n" +
+        "        widget.children.push({ index: j, label: 'item ' + j, visible: j % 2 == 0 });\n" +
+        "    return widget;\n" +
+        "})"));
+}
+var widgets = [];
+for (var i = 0; i < setup.length; ++i)
+    widgets.push(setup[i]({ width: i, height: 2 * i, count: 4 }));
+
+function frame(time) {
+    var visible = [];
+    for (var i = 0; i < widgets.length; ++i) {
+        var children = widgets[i].children;
+        for (var j = 0; j < children.length; ++j) {
+            if (children[j].visible)
+                visible.push({ x: i, y: j, t: time });
+        }
+    }
+    return visible.length;
+}
+
+var start = new Date;
+for (var time = 0; time < 2000; ++time)
+    frame(time);
+print("2000 frames in " + (new Date - start) + " ms");
@@ -0,0 +1,14 @@
+(function () {
+    function Base(a) { this.a = a; this.b = a + 1; }
+    function Middle(a) { Base.call(this, a); this.c = a; this.d = a; this.e = a; }
+    Middle.prototype = new Base(0);
+    function Leaf(a) { Middle.call(this, a); this.f = a; this.g = a; }
+    Leaf.prototype = new Middle(0);
+    function Other(a) { this.z = a; Base.call(this, a); this.q = a; this.r = a; }
+
+    var sum = 0;
+    for (var i = 0; i < 1000000; ++i) {
+        var leaf = new Leaf(i), middle = new Middle(i), other = new Other(i), base = new Base(i);
+        sum += leaf.g + middle.e + other.r + base.b;
+    }
+})();
@@ -0,0 +1,31 @@
+(function () {
+    var width = 256, height = 256;
+    var pixels = new Array(width * height);
+    for (var i = 0; i < pixels.length; ++i)
+        pixels[i] = (i % width) / width;
+
+    // Box blur, the way image-processing code does it.
+    var blurred = new Array(pixels.length);
+    for (var pass = 0; pass < 10; ++pass) {
+        for (var y = 1; y < height - 1; ++y) {
+            for (var x = 1; x < width - 1; ++x) {
+                var p = y * width + x;
+                blurred[p] = (pixels[p - 1] + pixels[p] + pixels[p + 1] + pixels[p - width] + pixels[p + width]) * 0.2;
+            }
+        }
+        var t = pixels; pixels = blurred; blurred = t;
+    }
+
+    // Chart series, built by appending and rescaled in place, with large numeric arrays alive across collections.
+    var series = [];
+    for (var s = 0; s < 20; ++s) {
+        var points = [];
+        for (var i = 0; i < 20000; ++i)
+            points.push(Math.sin(i * 0.001 + s) * 100.5);
+        for (var i = 0; i < points.length; ++i)
+            points[i] = points[i] * 0.5 + 10.25;
+        series.push(points);
+        for (var j = 0; j < 2000; ++j)
+            var label = { text: "label" + j };
+    }
+})();
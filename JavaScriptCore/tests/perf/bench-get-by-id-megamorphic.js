@@ -0,0 +1,16 @@
+(function () {
+    var objects = [];
+    for (var i = 0; i < 24; ++i) {
+        var o = {};
+        for (var j = 0; j < i % 6; ++j)
+            o["p" + i + "_" + j] = j;
+        o.x = i;
+        objects.push(o);
+    }
+
+    var sum = 0;
+    for (var i = 0; i < 1000000; ++i) {
+        for (var j = 0; j < objects.length; ++j)
+            sum += objects[j].x;
+    }
+})();
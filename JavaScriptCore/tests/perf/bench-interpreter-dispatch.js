@@ -0,0 +1,91 @@
+// A suite of small kernels for builds without the JIT, where every opcode is a
+// trip through Interpreter::privateExecute's dispatch. Run it under builds
+// with and without superinstructions and compare the per-kernel times; the
+// kernels between them cover the opcode pairs that dominate typical scripts.
+function loops(n) {
+    var sum = 0;
+    for (var i = 0; i < n; ++i) {
+        for (var j = 0; j < 10; ++j)
+            sum += j;
+    }
+    return sum;
+}
+
+function Point(x, y) {
+    this.x = x;
+    this.y = y;
+}
+Point.prototype.add = function(other) { return new Point(this.x + other.x, this.y + other.y); };
+Point.prototype.lengthSquared = function() { return this.x * this.x + this.y * this.y; };
+
+function methods(n) {
+    var p = new Point(0, 0), step = new Point(1, 2), total = 0;
+    for (var i = 0; i < n; ++i) {
+        p = p.add(step);
+        total += p.lengthSquared() & 0xff;
+    }
+    return total;
+}
+
+function arrays(n) {
+    var values = [];
+    for (var i = 0; i < 1000; ++i)
+        values[i] = (i * 17) & 255;
+    var total = 0;
+    for (var k = 0; k < n; ++k) {
+        for (var i = 0; i < values.length; ++i) {
+            if (values[i] > 128)
+                total += values[i];
+            else
+                total -= 1;
+        }
+    }
+    return total;
+}
+
+function fib(n) {
+    if (n < 2)
+        return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+function strings(n) {
+    var total = 0;
+    for (var i = 0; i < n; ++i) {
+        var s = "item" + i;
+        if (s.length > 5 && s.charAt(4) == "1")
+            total++;
+    }
+    return total;
+}
+
+function objects(n) {
+    var table = {}, total = 0;
+    for (var i = 0; i < n; ++i) {
+        var key = "k" + (i & 63);
+        if (table[key] === undefined)
+            table[key] = { count: 0 };
+        table[key].count++;
+        total += table[key].count;
+    }
+    return total;
+}
+
+var kernels = [
+    ["loops", loops, 1000000],
+    ["methods", methods, 500000],
+    ["arrays", arrays, 2000],
+    ["fib", fib, 30],
+    ["strings", strings, 500000],
+    ["objects", objects, 500000]
+];
+
+var total = 0;
+for (var i = 0; i < kernels.length; ++i) {
+    var start = new Date;
+    var result = kernels[i][1](kernels[i][2]);
+    var time = new Date - start;
+    total += time;
+    print(kernels[i][0] + ": " + time + " ms (" + result + ")");
+}
+print("total: " + total + " ms");
@@ -0,0 +1,29 @@
+// Libraries wrap everything in a few levels of module functions, and only a
+// handful of the functions inside ever run. Each module function is parsed when
+// it is first called, so this measures how much of the code nested inside it
+// gets scanned again.
+function makeModule(depth, name) {
+    var source = "function " + name + "(x) {\n";
+    for (var i = 0; i < 40; ++i) {
+        source += "    function helper" + i + "(a, b) {\n";
+        source += "        var list = [a, b, \"" + name + i + "\", /[a-z]+" + i + "/g, { key: a, value: b }];\n";
+        source += "        for (var j = 0; j < list.length; ++j) { if (typeof list[j] == \"number\") a += list[j]; }\n";
+        source += "        return function () { return a * " + i + " + b; };\n";
+        source += "    }\n";
+    }
+    if (depth > 0)
+        source += makeModule(depth - 1, name + "_inner") + "    return " + name + "_inner(x) + helper0(x, 1)();\n";
+    else
+        source += "    return helper0(x, 1)();\n";
+    return source + "}\n";
+}
+
+var library = "(function () {\n";
+for (var m = 0; m < 10; ++m)
+    library += makeModule(4, "module" + m) + "module" + m + "(" + m + ");\n";
+library += "})();\n";
+
+var start = new Date;
+for (var i = 0; i < 20; ++i)
+    eval(library);
+print("parsed and ran " + library.length + " characters 20 times in " + (new Date - start) + " ms");
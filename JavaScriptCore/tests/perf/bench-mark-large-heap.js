@@ -0,0 +1,21 @@
+(function () {
+    // Builds a large retained object graph, then collects repeatedly so that
+    // the run time is dominated by marking it.
+    function makeTree(depth) {
+        if (!depth)
+            return { value: depth };
+        return { left: makeTree(depth - 1), right: makeTree(depth - 1), items: [depth, {}, "x"] };
+    }
+
+    var roots = [];
+    for (var i = 0; i < 8; ++i)
+        roots.push(makeTree(16));
+
+    var list = null;
+    for (var i = 0; i < 200000; ++i)
+        list = { next: list, value: [i] };
+    roots.push(list);
+
+    for (var i = 0; i < 20; ++i)
+        gc();
+})();
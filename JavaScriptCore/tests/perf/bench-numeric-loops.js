@@ -0,0 +1,50 @@
+// Straight-line integer and floating point arithmetic in tight loops, the kind
+// of code physics and layout scripts spend their time in. Most values here
+// can stay in machine registers between the loop's branches.
+function integrate(steps) {
+    var x = 0, v = 1, dt = 0.001, k = 4.0, damping = 0.01;
+    for (var i = 0; i < steps; ++i) {
+        var a = -k * x - damping * v;
+        v = v + a * dt;
+        x = x + v * dt;
+    }
+    return x;
+}
+
+function layout(count, width) {
+    var lineWidth = 0, lines = 1, widest = 0;
+    for (var i = 0; i < count; ++i) {
+        var itemWidth = ((i * 7) & 31) + 8;
+        var margin = (i % 3) << 1;
+        lineWidth = lineWidth + itemWidth + margin;
+        if (lineWidth > width) {
+            lines = lines + 1;
+            lineWidth = itemWidth;
+        }
+        if (lineWidth > widest)
+            widest = lineWidth;
+    }
+    return lines * 1000 + widest;
+}
+
+function checksum(values) {
+    var a = 1, b = 0;
+    for (var i = 0; i < values.length; ++i) {
+        a = (a + values[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+var values = [];
+for (var i = 0; i < 4096; ++i)
+    values[i] = (i * 2654435761) & 255;
+
+var start = new Date;
+var result = 0;
+for (var i = 0; i < 20; ++i) {
+    result += integrate(100000);
+    result += layout(100000, 640);
+    result += checksum(values);
+}
+print("result " + result + " in " + (new Date - start) + " ms");
@@ -0,0 +1,50 @@
+// Regular expressions of the kind form validation and markup scanning code use:
+// backreferences, small fixed repeats of groups, and quantified groups. Each is
+// run over a mixed corpus of matching and non-matching inputs, and the number of
+// matches is printed alongside the time so engines can be checked against each
+// other as well as timed.
+var corpus = [
+    "192.168.0.1", "10.0.0.255", "256.1.1.1", "1.2.3", "00:1a:2B:3c:4D:5e", "00-1a-2b-3c-4d-5e",
+    "2010-03-14", "14/03/2010", "14.03.2010", "2010-3-14",
+    "user@example.com", "first.last@sub.example.org", "not an address", "@example.com",
+    "<b>bold</b>", "<i>italic</b>", "<span class=\"x\">text</span>", "<p>para",
+    "say \"hello\" then 'bye'", "mismatched \"quote'", "it's", "\"\"",
+    "bookkeeper", "hello", "abcabc", "abcabd", "the the cat", "no repeats here",
+    "aaaa", "ababab", "xyxyxy", "1122334455", "12341234", "a1b2c3",
+    "#ff00ff", "#F0F", "rgb(255, 0, 128)", "rgb(300,0,0)",
+    "(555) 123-4567", "555-123-4567", "5551234567", "+1 555 123 4567"
+];
+
+var patterns = [
+    ["repeated word", /\b(\w+)\s+\1\b/],
+    ["doubled letter", /(\w)\1/],
+    ["matching tags", /<(\w+)[^>]*>[^<]*<\/\1>/],
+    ["matching quotes", /(["'])[^"']*\1/],
+    ["date, same separator", /^\d{2}([\/.-])\d{2}\1\d{4}$/],
+    ["dotted quad", /^(?:(?:25[0-5]|2[0-4]\d|1?\d?\d)\.){3}(?:25[0-5]|2[0-4]\d|1?\d?\d)$/],
+    ["MAC address", /^(?:[0-9a-f]{2}([:-])){5}[0-9a-f]{2}$/i],
+    ["repeated unit", /^(\w+?)\1+$/],
+    ["phone number", /^(?:\(\d{3}\) |\d{3}-)\d{3}-\d{4}$/],
+    ["hex colour", /^#(?:[0-9a-f]{3}){1,2}$/i],
+    ["email", /^[\w.+-]+@(?:[\w-]+\.)+[a-z]{2,}$/i],
+    ["rgb()", /^rgb\((?:\s*\d{1,3}\s*,){2}\s*\d{1,3}\s*\)$/]
+];
+
+var iterations = 20000;
+var total = 0;
+var totalStart = new Date;
+for (var p = 0; p < patterns.length; ++p) {
+    var name = patterns[p][0];
+    var regexp = patterns[p][1];
+    var matches = 0;
+    var start = new Date;
+    for (var i = 0; i < iterations; ++i) {
+        for (var j = 0; j < corpus.length; ++j) {
+            if (regexp.test(corpus[j]))
+                ++matches;
+        }
+    }
+    total += matches;
+    print(name + ": " + (new Date - start) + " ms (" + matches / iterations + " matches)");
+}
+print("total: " + (new Date - totalStart) + " ms (" + total / iterations + " matches)");
@@ -0,0 +1,36 @@
+// Run with "jsc -p <file> bench-sampling-profiler.js" and compare the time with a
+// run without -p to see what sampling costs. The folded stacks written to the
+// file should show nearly all samples under renderScene, split between transform
+// and rasterize. The comparator passed to sort is too short to reach a timeout
+// check on its own, so the time spent sorting is counted against rasterize.
+function transform(points, angle) {
+    var cos = Math.cos(angle), sin = Math.sin(angle);
+    var result = [];
+    for (var i = 0; i < points.length; ++i) {
+        var p = points[i];
+        result.push({ x: p.x * cos - p.y * sin, y: p.x * sin + p.y * cos, z: p.z });
+    }
+    return result;
+}
+
+function rasterize(points) {
+    points.sort(function (a, b) { return a.z - b.z; });
+    var checksum = 0;
+    for (var i = 0; i < points.length; ++i)
+        checksum = (checksum + Math.floor(points[i].x * 31 + points[i].y)) | 0;
+    return checksum;
+}
+
+function renderScene(points, frame) {
+    return rasterize(transform(points, frame / 100));
+}
+
+var points = [];
+for (var i = 0; i < 2000; ++i)
+    points.push({ x: i % 37, y: i % 91, z: (i * 7919) % 1000 });
+
+var start = new Date;
+var checksum = 0;
+for (var frame = 0; frame < 300; ++frame)
+    checksum ^= renderScene(points, frame);
+print("300 frames in " + (new Date - start) + " ms (checksum " + checksum + ")");
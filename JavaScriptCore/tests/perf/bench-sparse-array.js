@@ -0,0 +1,31 @@
+(function () {
+    // A data grid keyed by row id: a few thousand rows spread over a large id range.
+    var rows = [];
+    for (var i = 0; i < 20000; ++i)
+        rows[1000000 + i * 37] = { id: i, value: i * 0.5 };
+
+    var total = 0;
+    for (var pass = 0; pass < 20; ++pass) {
+        // Visible rows, in order.
+        var seen = 0;
+        for (var key in rows) {
+            if (++seen > 200)
+                break;
+            total += rows[key].value;
+        }
+        // Random access by id.
+        for (var i = 0; i < 20000; i += 3)
+            total += rows[1000000 + i * 37].id;
+    }
+
+    // Filtering trims the grid from the end.
+    for (var length = rows.length; length > 1000000; length -= 7400)
+        rows.length = length;
+
+    // Rows that fill in an id range move back into the dense vector.
+    var grid = [];
+    for (var i = 0; i < 2000; ++i)
+        grid[10000 + i * 16] = i;
+    for (var i = 0; i < 42000; ++i)
+        grid[i] = i;
+})();
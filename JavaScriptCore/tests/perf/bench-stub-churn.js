@@ -0,0 +1,44 @@
+// Run with "jsc -x bench-stub-churn.js" to see how the executable memory pool
+// holds up. A long-running page that keeps compiling short-lived code: every
+// round evals a batch of functions, runs their property accesses over objects
+// of many shapes so that the JIT builds prototype and polymorphic access stubs,
+// then drops them all for the collector to free.
+function makeShapes(round) {
+    var shapes = [];
+    for (var i = 0; i < 12; ++i) {
+        var proto = { depth: i };
+        for (var j = 0; j <= i % 4; ++j)
+            proto = Object.create ? Object.create(proto) : proto;
+        var object = Object.create ? Object.create(proto) : {};
+        object["own" + (i % 3)] = round;
+        object["extra" + i] = j;
+        shapes.push(object);
+    }
+    return shapes;
+}
+
+function makeBatch(round, size) {
+    var source = "[";
+    for (var i = 0; i < size; ++i) {
+        var body = "var total = 0; for (var i = 0; i < objects.length; ++i) { var o = objects[i]; total += o.depth + (o.own0 || 0) + (o.own" + (i % 3) + " || 0); }";
+        // Some functions are much larger than others, so the pool sees more than one size.
+        for (var j = 0; j < i % 7; ++j)
+            body += " total += objects[" + j + "].depth * " + (round + j) + ";";
+        source += "function(objects) { " + body + " return total; },";
+    }
+    return eval(source + "]");
+}
+
+var start = new Date;
+var checksum = 0;
+for (var round = 0; round < 300; ++round) {
+    var shapes = makeShapes(round);
+    var batch = makeBatch(round, 40);
+    for (var i = 0; i < batch.length; ++i) {
+        for (var k = 0; k < 3; ++k)
+            checksum += batch[i](shapes);
+    }
+    if (!(round % 20))
+        gc();
+}
+print("checksum " + checksum + ", 300 rounds in " + (new Date - start) + " ms");
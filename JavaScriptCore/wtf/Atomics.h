@@ -107,6 +107,34 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+// Returns true if *location held expected and now holds newValue. "Weak"
+// because callers must be prepared to retry; the operation is a full barrier.
+#if OS(WINDOWS) && !COMPILER(MINGW) && !COMPILER(MSVC7_OR_LOWER) && !OS(WINCE)
+#define WTF_USE_COMPARE_AND_SWAP 1
+
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return static_cast<unsigned>(InterlockedCompareExchange(reinterpret_cast<long volatile*>(location), newValue, expected)) == expected;
+}
+
+#elif OS(DARWIN)
+#define WTF_USE_COMPARE_AND_SWAP 1
+
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return OSAtomicCompareAndSwap32Barrier(expected, newValue, reinterpret_cast<int32_t volatile*>(location));
+}
+
+#elif COMPILER(GCC) && !OS(SYMBIAN) && !OS(ANDROID) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 1)))
+#define WTF_USE_COMPARE_AND_SWAP 1
+
+inline bool weakCompareAndSwap(unsigned volatile* location, unsigned expected, unsigned newValue)
+{
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+}
+
+#endif
+
 } // namespace WTF
 
 #if USE(LOCKFREE_THREADSAFESHARED)
@@ -114,4 +142,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if USE(COMPARE_AND_SWAP)
+using WTF::weakCompareAndSwap;
+#endif
+
 #endif // Atomics_h
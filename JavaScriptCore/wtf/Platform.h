@@ -1094,6 +1094,15 @@
     #define HAVE_COMPUTED_GOTO 1
 #endif
 
+/* Without the JIT, the bytecode generator fuses the commonest opcode pairs into superinstructions. */
+#if !defined(ENABLE_INTERPRETER_SUPERINSTRUCTIONS) && !ENABLE(JIT)
+    #define ENABLE_INTERPRETER_SUPERINSTRUCTIONS 1
+#endif
+
+#if ENABLE(INTERPRETER_SUPERINSTRUCTIONS) && ENABLE(JIT)
+    #error "INTERPRETER_SUPERINSTRUCTIONS requires the JIT to be disabled"
+#endif
+
 #if ENABLE(JIT) && defined(COVERAGE)
     #define WTF_USE_INTERPRETER 0
 #else
@@ -1148,6 +1157,11 @@
     #define ENABLE_ASSEMBLER_WX_EXCLUSIVE 0
 #endif
 
+/* Executable memory is carved out of a single up-front reservation rather than mapped a pool at a time. */
+#if !defined(ENABLE_EXECUTABLE_ALLOCATOR_FIXED) && ENABLE(ASSEMBLER) && OS(DARWIN) && CPU(X86_64)
+    #define ENABLE_EXECUTABLE_ALLOCATOR_FIXED 1
+#endif
+
 #if !defined(ENABLE_PAN_SCROLLING) && OS(WINDOWS)
     #define ENABLE_PAN_SCROLLING 1
 #else
@@ -1206,6 +1220,17 @@
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Parallel marking needs helper threads and an atomic compare-and-swap for the mark bits. */
+#if !defined(ENABLE_PARALLEL_GC) && !ENABLE(SINGLE_THREADED) \
+    && (OS(DARWIN) || (OS(LINUX) && COMPILER(GCC)) || (OS(WINDOWS) && COMPILER(MSVC) && !COMPILER(MSVC7_OR_LOWER) && !OS(WINCE)))
+#define ENABLE_PARALLEL_GC 1
+#endif
+
+/* Collector blocks the heap no longer needs are returned to the system by a helper thread. */
+#if !defined(ENABLE_BACKGROUND_BLOCK_FREEING) && !ENABLE(SINGLE_THREADED) && !OS(SYMBIAN) && !OS(WINCE)
+#define ENABLE_BACKGROUND_BLOCK_FREEING 1
+#endif
+
 #if PLATFORM(APOLLO)
 
     #if OS(WINDOWS)
@@ -1309,4 +1334,34 @@
     #endif
 #endif
 
+/* Arrays that hold only numbers skip marking and write barriers, which needs numbers that are never cells. */
+#if !defined(ENABLE_NUMBER_ARRAY_STORAGE) && (USE(JSVALUE64) || USE(JSVALUE32_64))
+#define ENABLE_NUMBER_ARRAY_STORAGE 1
+#endif
+
+/* Program bytecode can be kept on disk between runs; nothing is cached unless a directory is set. */
+#if !defined(ENABLE_BYTECODE_CACHE)
+#define ENABLE_BYTECODE_CACHE 1
+#endif
+
+/* Code for functions that stop being called is thrown away by full collections and generated again on demand. */
+#if !defined(ENABLE_CODE_FLUSHING)
+#define ENABLE_CODE_FLUSHING 1
+#endif
+
+/* Script call stacks can be sampled from a timer thread while the program runs; nothing is sampled until a profiler is started. */
+#if !defined(ENABLE_SAMPLING_PROFILER) && !ENABLE(SINGLE_THREADED)
+#define ENABLE_SAMPLING_PROFILER 1
+#endif
+
+/* The baseline JIT keeps local variables and temporaries in spare registers across runs of arithmetic and branch opcodes. */
+#if !defined(ENABLE_JIT_REGISTER_ALLOCATION) && ENABLE(JIT) && USE(JSVALUE64) && CPU(X86_64) && !OS(WINDOWS)
+#define ENABLE_JIT_REGISTER_ALLOCATION 1
+#endif
+
+/* The baseline JIT drops type and overflow checks on the int32 counters of simple for loops. */
+#if !defined(ENABLE_JIT_OPTIMIZE_LOOP_COUNTERS) && ENABLE(JIT) && USE(JSVALUE64)
+#define ENABLE_JIT_OPTIMIZE_LOOP_COUNTERS 1
+#endif
+
 #endif /* WTF_Platform_h */
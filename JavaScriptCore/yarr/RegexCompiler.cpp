@@ -38,6 +38,9 @@ namespace JSC { namespace Yarr {
 
 #include "RegExpJitTables.h"
 
+// Limit on the number of terms quantifyAtom will create by unrolling a fixed count group.
+static const unsigned maximumUnrolledTermCount = 64;
+
 class CharacterClassConstructor {
 public:
     CharacterClassConstructor(bool isCaseInsensitive = false)
@@ -372,7 +375,9 @@ public:
     void atomBackReference(unsigned subpatternId)
     {
         ASSERT(subpatternId);
-        m_pattern.m_shouldFallBack = true;
+        // The JIT only compares backreferences character for character.
+        if (m_pattern.m_ignoreCase)
+            m_pattern.m_shouldFallBack = true;
         m_pattern.m_maxBackReference = std::max(m_pattern.m_maxBackReference, subpatternId);
 
         if (subpatternId > m_pattern.m_numSubpatterns) {
@@ -388,7 +393,7 @@ public:
             PatternTerm& term = currentAlternative->lastTerm();
             ASSERT((term.type == PatternTerm::TypeParenthesesSubpattern) || (term.type == PatternTerm::TypeParentheticalAssertion));
 
-            if ((term.type == PatternTerm::TypeParenthesesSubpattern) && term.invertOrCapture && (subpatternId == term.subpatternId)) {
+            if ((term.type == PatternTerm::TypeParenthesesSubpattern) && term.invertOrCapture && (subpatternId == term.parentheses.subpatternId)) {
                 m_alternative->m_terms.append(PatternTerm::ForwardReference());
                 return;
             }
@@ -423,6 +428,58 @@ public:
         return termCopy;
     }
 
+    static unsigned termCount(PatternDisjunction* disjunction)
+    {
+        unsigned count = 0;
+        for (unsigned alt = 0; alt < disjunction->m_alternatives.size(); ++alt) {
+            PatternAlternative* alternative = disjunction->m_alternatives[alt];
+            for (unsigned i = 0; i < alternative->m_terms.size(); ++i) {
+                PatternTerm& term = alternative->m_terms[i];
+                ++count;
+                if ((term.type == PatternTerm::TypeParenthesesSubpattern) || (term.type == PatternTerm::TypeParentheticalAssertion))
+                    count += termCount(term.parentheses.disjunction);
+            }
+        }
+        return count;
+    }
+
+    static bool containsCapture(PatternDisjunction* disjunction)
+    {
+        for (unsigned alt = 0; alt < disjunction->m_alternatives.size(); ++alt) {
+            PatternAlternative* alternative = disjunction->m_alternatives[alt];
+            for (unsigned i = 0; i < alternative->m_terms.size(); ++i) {
+                PatternTerm& term = alternative->m_terms[i];
+                if ((term.type == PatternTerm::TypeParenthesesSubpattern) && (term.capture() || containsCapture(term.parentheses.disjunction)))
+                    return true;
+                if ((term.type == PatternTerm::TypeParentheticalAssertion) && containsCapture(term.parentheses.disjunction))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // True if every capture within the disjunction is set by any match of it, i.e.
+    // none sits in one of several alternatives, under a quantifier, or in an assertion.
+    static bool capturesAlwaysParticipate(PatternDisjunction* disjunction)
+    {
+        if (disjunction->m_alternatives.size() != 1)
+            return !containsCapture(disjunction);
+
+        PatternAlternative* alternative = disjunction->m_alternatives[0];
+        for (unsigned i = 0; i < alternative->m_terms.size(); ++i) {
+            PatternTerm& term = alternative->m_terms[i];
+            if (term.type == PatternTerm::TypeParenthesesSubpattern) {
+                if ((term.quantityType == QuantifierFixedCount) && (term.quantityCount == 1) && !term.parentheses.isCopy) {
+                    if (!capturesAlwaysParticipate(term.parentheses.disjunction))
+                        return false;
+                } else if (term.capture() || containsCapture(term.parentheses.disjunction))
+                    return false;
+            } else if ((term.type == PatternTerm::TypeParentheticalAssertion) && containsCapture(term.parentheses.disjunction))
+                return false;
+        }
+        return true;
+    }
+
     void quantifyAtom(unsigned min, unsigned max, bool greedy)
     {
         ASSERT(min <= max);
@@ -448,6 +505,23 @@ public:
             return;
         }
 
+        if (term.type == PatternTerm::TypeBackReference && (max > 1 || !min))
+            m_pattern.m_shouldFallBack = true;
+
+        // A fixed count of a small group is unrolled into that many copies of the
+        // group; each copy is then a plain once-only subpattern that the JIT can
+        // compile and the interpreter can match inline. Captures inside the group
+        // would need resetting at the start of each iteration, which the copies do
+        // not do, so this is only safe when every iteration sets all of them.
+        if ((term.type == PatternTerm::TypeParenthesesSubpattern) && (min == max) && (max <= maximumUnrolledTermCount)
+            && ((termCount(term.parentheses.disjunction) + 1) * max <= maximumUnrolledTermCount)
+            && capturesAlwaysParticipate(term.parentheses.disjunction)) {
+            unsigned termIndex = m_alternative->m_terms.size() - 1;
+            for (unsigned i = 1; i < max; ++i)
+                m_alternative->m_terms.append(copyTerm(m_alternative->m_terms[termIndex]));
+            return;
+        }
+
         if (max > 1 && term.type == PatternTerm::TypeParenthesesSubpattern)
             m_pattern.m_shouldFallBack = true;
 
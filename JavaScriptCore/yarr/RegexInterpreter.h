@@ -296,7 +296,16 @@ struct BytecodePattern : FastAllocBase {
         : m_body(body)
         , m_ignoreCase(pattern.m_ignoreCase)
         , m_multiline(pattern.m_multiline)
+        , m_onceThrough(!pattern.m_multiline)
     {
+        // If every alternative begins with a ^ that only matches at the start of the
+        // input, there is no point retrying the match from later positions.
+        for (unsigned alt = 0; alt < pattern.m_body->m_alternatives.size(); ++alt) {
+            PatternAlternative* alternative = pattern.m_body->m_alternatives[alt];
+            if (!alternative->m_terms.size() || (alternative->m_terms[0].type != PatternTerm::TypeAssertionBOL))
+                m_onceThrough = false;
+        }
+
         newlineCharacterClass = pattern.newlineCharacterClass();
         wordcharCharacterClass = pattern.wordcharCharacterClass();
 
@@ -317,6 +326,7 @@ struct BytecodePattern : FastAllocBase {
     OwnPtr<ByteDisjunction> m_body;
     bool m_ignoreCase;
     bool m_multiline;
+    bool m_onceThrough;
     
     CharacterClass* newlineCharacterClass;
     CharacterClass* wordcharCharacterClass;
@@ -32,8 +32,6 @@
 #include "MacroAssembler.h"
 #include "RegexCompiler.h"
 
-#include "pcre.h" // temporary, remove when fallback is removed.
-
 #if ENABLE(YARR_JIT)
 
 using namespace WTF;
@@ -802,6 +800,57 @@ class RegexGenerator : private MacroAssembler {
         state.setBacktrackGenerated(backtrackBegin);
     }
 
+    void generateBackReference(TermGenerationState& state)
+    {
+        const RegisterID delta = regT0;
+        const RegisterID character = regT1;
+        PatternTerm& term = state.term();
+        unsigned subpatternId = term.subpatternId;
+        ASSERT((term.quantityType == QuantifierFixedCount) && (term.quantityCount == 1));
+        ASSERT(!m_pattern.m_ignoreCase);
+
+        // The first frame slot holds the index on entry, so that backtracking can
+        // rewind over the match; the second holds the index at the end of the match.
+        storeToFrame(index, term.frameLocation);
+
+        // A subpattern that did not participate has both ends set to -1, giving
+        // a zero length; like an empty capture, that matches without consuming input.
+        load32(Address(output, ((subpatternId << 1) + 1) * sizeof(int)), character);
+        load32(Address(output, (subpatternId << 1) * sizeof(int)), delta);
+        sub32(delta, character);
+        Jump matchedEmpty = branchTest32(Zero, character);
+
+        JumpList failures;
+        add32(character, index);
+        failures.append(branch32(Above, index, length));
+        storeToFrame(index, term.frameLocation + 1);
+        sub32(character, index);
+
+        // Walk index across the match, reading the captured text at a constant
+        // distance behind it.
+        sub32(index, delta);
+        if (state.inputOffset())
+            sub32(Imm32(state.inputOffset()), delta);
+
+        Label loop(this);
+        move(index, character);
+        add32(delta, character);
+        load16(BaseIndex(input, character, TimesTwo, state.inputOffset() * sizeof(UChar)), character);
+        failures.append(branch16(NotEqual, BaseIndex(input, index, TimesTwo, state.inputOffset() * sizeof(UChar)), character));
+        add32(Imm32(1), index);
+        branch32(NotEqual, index, Address(stackPointerRegister, (term.frameLocation + 1) * sizeof(void*))).linkTo(loop, this);
+        Jump matched = jump();
+
+        Label backtrackBegin(this);
+        failures.link(this);
+        loadFromFrame(term.frameLocation, index);
+        state.jumpToBacktrack(jump(), this);
+
+        state.setBacktrackGenerated(backtrackBegin);
+        matchedEmpty.link(this);
+        matched.link(this);
+    }
+
     void generateParenthesesDisjunction(PatternTerm& parenthesesTerm, TermGenerationState& state, unsigned alternativeFrameLocation)
     {
         ASSERT((parenthesesTerm.type == PatternTerm::TypeParenthesesSubpattern) || (parenthesesTerm.type == PatternTerm::TypeParentheticalAssertion));
@@ -1102,14 +1151,14 @@ class RegexGenerator : private MacroAssembler {
             break;
 
         case PatternTerm::TypeBackReference:
-            ASSERT_NOT_REACHED();
+            generateBackReference(state);
             break;
 
         case PatternTerm::TypeForwardReference:
             break;
 
         case PatternTerm::TypeParenthesesSubpattern:
-            ASSERT((term.quantityCount == 1) && !term.parentheses.isCopy); // must fallback to pcre before this point
+            ASSERT((term.quantityCount == 1) && !term.parentheses.isCopy); // must fall back to the interpreter before this point
             generateParenthesesSingle(state);
             break;
 
@@ -1407,13 +1456,12 @@ void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const
     numSubpatterns = pattern.m_numSubpatterns;
 
     if (pattern.m_shouldFallBack) {
-        JSRegExpIgnoreCaseOption ignoreCaseOption = ignoreCase ? JSRegExpIgnoreCase : JSRegExpDoNotIgnoreCase;
-        JSRegExpMultilineOption multilineOption = multiline ? JSRegExpMultiline : JSRegExpSingleLine;
-        jitObject.setFallback(jsRegExpCompile(reinterpret_cast<const UChar*>(patternString.data()), patternString.size(), ignoreCaseOption, multilineOption, &numSubpatterns, &error));
-    } else {
-        RegexGenerator generator(pattern);
-        generator.compile(globalData, jitObject);
+        jitObject.setFallBack(true);
+        return;
     }
+
+    RegexGenerator generator(pattern);
+    generator.compile(globalData, jitObject);
 }
 
 }}
@@ -32,9 +32,6 @@
 #include "RegexPattern.h"
 #include <UString.h>
 
-#include <pcre.h>
-struct JSRegExp; // temporary, remove when fallback is removed.
-
 #if CPU(X86) && !COMPILER(MSVC)
 #define YARR_CALL __attribute__ ((regparm (3)))
 #else
@@ -53,20 +50,16 @@ class RegexCodeBlock {
 
 public:
     RegexCodeBlock()
-        : m_fallback(0)
+        : m_needFallBack(false)
     {
     }
 
-    ~RegexCodeBlock()
-    {
-        if (m_fallback)
-            jsRegExpFree(m_fallback);
-    }
+    // Patterns the JIT cannot generate code for are left uncompiled and flagged here;
+    // the owner is expected to byte compile them and run them in the Yarr interpreter.
+    bool isFallBack() { return m_needFallBack; }
+    void setFallBack(bool fallback) { m_needFallBack = fallback; }
 
-    JSRegExp* getFallback() { return m_fallback; }
-    void setFallback(JSRegExp* fallback) { m_fallback = fallback; }
-
-    bool operator!() { return (!m_ref.m_code.executableAddress() && !m_fallback); }
+    bool operator!() { return !m_ref.m_code.executableAddress(); }
     void set(MacroAssembler::CodeRef ref) { m_ref = ref; }
 
     int execute(const UChar* input, unsigned start, unsigned length, int* output)
@@ -76,16 +69,14 @@ public:
 
 private:
     MacroAssembler::CodeRef m_ref;
-    JSRegExp* m_fallback;
+    bool m_needFallBack;
 };
 
 void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& pattern, unsigned& numSubpatterns, const char*& error, bool ignoreCase = false, bool multiline = false);
 
-inline int executeRegex(RegexCodeBlock& jitObject, const UChar* input, unsigned start, unsigned length, int* output, int outputArraySize)
+inline int executeRegex(RegexCodeBlock& jitObject, const UChar* input, unsigned start, unsigned length, int* output)
 {
-    if (JSRegExp* fallback = jitObject.getFallback())
-        return (jsRegExpExecute(fallback, input, length, start, output, outputArraySize) < 0) ? -1 : output[0];
-
+    ASSERT(!jitObject.isFallBack());
     return jitObject.execute(input, start, length, output);
 }
 